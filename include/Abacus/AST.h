@@ -12,6 +12,8 @@
 #include "Export.h"
 #include "Visitor.h"
 #include "StreamPosition.h"
+#include "Symbol.h"
+#include "Functions.h"
 
 #include <string>
 #include <memory>
@@ -26,7 +28,8 @@ namespace Ac
 /**
 Function filter callback signature.
 \param[in] ident Specifies the identifier of the potential function.
-\return True if the specified identifier denotes a function, otherwise false.
+\return True if the specified identifier denotes a function, which can be called without brackets, otherwise false.
+\remarks Without a filter, these are all registered functions with exactly one parameter (see FindFunction).
 */
 using FunctionFilter = std::function<bool(const std::string& ident)>;
 
@@ -106,6 +109,7 @@ struct BinaryExpr : public Expr
         Sub,
         Mul,
         Div,
+        IntDiv,
         Mod,
         Pow,
         LShift,
@@ -133,6 +137,7 @@ struct IdentExpr : public Expr
     __AC_AST_INTERFACE__(Ident);
 
     std::string value;
+    Symbol      symbol = 0; // interned identifier.
 };
 
 struct FuncExpr : public Expr
@@ -140,6 +145,7 @@ struct FuncExpr : public Expr
     __AC_AST_INTERFACE__(Func);
 
     std::string             name;
+    const FunctionDesc*     func = nullptr; // registered function, or null if the function is unknown.
     std::vector<ExprPtr>    args;
 };
 
@@ -149,6 +155,7 @@ struct FoldExpr : public Expr
 
     std::string             func;       // fold function name (either "sum" or "product").
     std::string             index;      // identifier of the index variable
+    Symbol                  indexSymbol = 0; // interned identifier of the index variable
     ExprPtr                 initExpr;   // expression to initialize the index
     ExprPtr                 iterExpr;   // expression for the index iterationp
     ExprPtr                 loopExpr;   // expression inside the fold loop
@@ -166,6 +173,7 @@ struct DefExpr : public Expr
     __AC_AST_INTERFACE__(Def);
 
     std::string ident;
+    Symbol      symbol = 0; // interned identifier.
     ExprPtr     expr;
 };
 
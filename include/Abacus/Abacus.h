@@ -11,11 +11,15 @@
 
 #include "Export.h"
 #include "AST.h"
+#include "Functions.h"
+#include "ConstantsSet.h"
 #include "Log.h"
 
 #include <string>
 #include <map>
 #include <memory>
+#include <functional>
+#include <iosfwd>
 
 
 namespace Ac
@@ -26,34 +30,66 @@ namespace Ac
 #define __AC_MINOR_VERSION__ 0
 #define __AC_VERSION_STR__ "1.00 Beta"
 
-struct ConstantsSet
+//! Rounding mode of floating-point results.
+enum class RoundingMode
 {
-    ConstantsSet()
-    {
-        ResetStd();
-    }
-
-    void ResetStd()
-    {
-        constants["pi"] = "3.141592653589793238462643383279502884197169399375105820974944";
-        constants["e"]  = "2.718281828459045235360287471352662497757247093699959574966967";
-    }
-
-    std::map<std::string, std::string> constants;
+    Nearest,    // round to nearest
+    Up,         // round towards +infinity
+    Down,       // round towards -infinity
+    Zero,       // round towards zero
 };
 
 struct ComputeMode
 {
-    bool degree = false;
+    bool            degree          = false;
+    unsigned int    precision       = 0;                        // number of float digits (0 for the default, see SetFloatPrecision).
+    RoundingMode    rounding        = RoundingMode::Nearest;
+    bool            quick           = false;                    // accept a certified hardware float result with fewer digits than requested.
+    unsigned int    scientificExp   = 10;                       // decimal exponents with at least this magnitude are written in scientific notation.
+    bool            interval        = false;                    // compute a rigorous enclosure [lower, upper] of the result with directed rounding.
 };
 
 
+class RealNode;
+
+//! Result of an expression in the exact-real mode, whose digits are computed on demand (see ComputeExactReal).
+using ExactRealPtr = std::shared_ptr<RealNode>;
+
+//! Receives the next chunk of a streamed result (see Compute with output callback).
+using OutputCallback = std::function<void(const char* text, std::size_t length)>;
+
+
 AC_EXPORT ExprPtr ParseExpression(const std::string& expr, Log* log = nullptr, const FunctionFilter& funcFilter = nullptr);
 
 AC_EXPORT std::string Compute(const std::string& expr, const ComputeMode& mode, Log* log = nullptr);
 AC_EXPORT std::string Compute(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log = nullptr);
 
+/**
+Computes the expression and writes the result in chunks of bounded size to the output callback or stream,
+without building the whole result string first. Returns false if the expression could not be computed.
+*/
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, const OutputCallback& output, Log* log = nullptr);
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, const OutputCallback& output, Log* log = nullptr);
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, std::ostream& output, Log* log = nullptr);
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, std::ostream& output, Log* log = nullptr);
+
+/**
+Builds the lazily refined computation graph of the expression for the exact-real mode, without computing any digits.
+Supports real arithmetic, the elementary functions, and folds; integer operators require exact integer operands.
+Returns null if the expression could not be parsed or is not supported in this mode.
+*/
+AC_EXPORT ExactRealPtr ComputeExactReal(const std::string& expr, const ComputeMode& mode, Log* log = nullptr);
+AC_EXPORT ExactRealPtr ComputeExactReal(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log = nullptr);
+
+/**
+Returns the exact-real result rounded to 'mode.precision' digits (0 for the default, see SetFloatPrecision).
+All approximations of previous calls are kept, so asking for more digits of the same result only costs the refinement.
+*/
+AC_EXPORT std::string RefineExactReal(const ExactRealPtr& real, const ComputeMode& mode, Log* log = nullptr);
+
+//! Returns the default float precision for all threads.
 AC_EXPORT unsigned int GetFloatPrecision();
+//! Sets the default float precision for all threads (used when ComputeMode::precision is 0).
 AC_EXPORT void SetFloatPrecision(unsigned int digits);
 
 
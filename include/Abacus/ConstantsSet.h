@@ -0,0 +1,110 @@
+/*
+ * ConstantsSet.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_CONSTANTS_SET_H__
+#define __AC_CONSTANTS_SET_H__
+
+
+#include "Export.h"
+#include "Symbol.h"
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <utility>
+
+
+namespace Ac
+{
+
+
+//! Parsed value of a constant (defined inside the library).
+class ConstantValue;
+
+/**
+Set of named constants, which keeps the parsed values with all their digits
+in an open-addressing hash table, indexed by the interned identifiers (see InternSymbol).
+Copies of a set share the values of their constants. Literals are only written when the constants are listed.
+*/
+class ConstantsSet
+{
+
+    public:
+
+        using ValuePtr = std::shared_ptr<const ConstantValue>;
+
+        //! Initializes the set with the standard constants.
+        AC_EXPORT ConstantsSet();
+
+        //! Sets the standard constants "pi" and "e".
+        AC_EXPORT void ResetStd();
+
+        //! Removes all constants (including the standard constants).
+        AC_EXPORT void Clear();
+
+        /**
+        Sets the constant to the value of the literal (e.g. "12", "-0.5", "1.5E20", or "1 + 2i"), and keeps all of its digits.
+        \return False if the identifier or the literal is invalid.
+        */
+        AC_EXPORT bool Set(const std::string& ident, const std::string& literal);
+
+        //! Removes the constant, and returns false if it was not defined.
+        AC_EXPORT bool Remove(const std::string& ident);
+
+        //! Returns true if the constant is defined.
+        AC_EXPORT bool Contains(const std::string& ident) const;
+
+        //! Returns the identifiers and literals of all constants, sorted by their identifiers.
+        AC_EXPORT std::vector<std::pair<std::string, std::string>> List() const;
+
+        //! Returns the number of constants.
+        std::size_t Size() const
+        {
+            return size_;
+        }
+
+        /* --- Access by symbols --- */
+
+        //! Returns the value of the constant, or null if it is not defined.
+        AC_EXPORT const ConstantValue* Find(Symbol symbol) const;
+
+        AC_EXPORT void Set(Symbol symbol, ValuePtr value);
+        AC_EXPORT bool Remove(Symbol symbol);
+
+        bool Contains(Symbol symbol) const
+        {
+            return (Find(symbol) != nullptr);
+        }
+
+    private:
+
+        //! Table entry, which is empty if it has no value.
+        struct Slot
+        {
+            Symbol      symbol  = 0;
+            ValuePtr    value;
+        };
+
+        // Returns the index of the slot with the symbol, or of the empty slot where it would be inserted.
+        std::size_t Probe(Symbol symbol) const;
+
+        void Rehash(std::size_t capacity);
+
+        std::vector<Slot>   slots_;     // power-of-two number of slots with linear probing.
+        std::size_t         size_ = 0;
+
+};
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,73 @@
+/*
+ * Functions.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_FUNCTIONS_H__
+#define __AC_FUNCTIONS_H__
+
+
+#include "Export.h"
+#include "Symbol.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <functional>
+
+
+namespace Ac
+{
+
+
+class Variable;
+
+//! Index of a function in the function registry.
+using FunctionID = std::uint32_t;
+
+/**
+Native function callback signature.
+\param[in] args Specifies the arguments, which are integers, rationals, floats, or complex numbers with the working precision.
+\param[in] numArgs Specifies the number of arguments.
+\return Value of the result.
+\remarks The values are passed without conversion, like the arguments of the built-in functions (see "Variable.h" of the sources).
+Throw an exception (e.g. std::runtime_error) to report an error.
+*/
+using NativeFunction = std::function<Variable(const Variable* args, std::size_t numArgs)>;
+
+//! Function registry entry.
+struct FunctionDesc
+{
+    std::string     name;
+    Symbol          symbol      = 0;
+    FunctionID      id          = 0;        // index in the registry (the built-in functions come first).
+    int             numParams   = 1;        // number of parameters, or -1 for at least one parameter.
+    bool            pure        = true;     // result only depends on the arguments (e.g. not for 'rand').
+    NativeFunction  impl;                   // implementation of a registered native function (null for built-in functions).
+};
+
+/**
+Registers a native function, which can be called in all subsequent expressions (thread-safe).
+Functions with exactly one parameter can also be called without brackets (e.g. "f 2").
+Native functions are not supported in the interval and exact-real modes.
+\return False if the name is not an identifier or is already registered.
+*/
+AC_EXPORT bool RegisterFunction(const std::string& name, int numParams, const NativeFunction& impl, bool pure = true);
+
+//! Returns the registered function with the specified symbol, or null if there is no such function (thread-safe).
+AC_EXPORT const FunctionDesc* FindFunction(Symbol symbol);
+
+//! Returns the registered function with the specified name, or null if there is no such function (thread-safe).
+AC_EXPORT const FunctionDesc* FindFunction(const std::string& name);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,49 @@
+/*
+ * Symbol.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_SYMBOL_H__
+#define __AC_SYMBOL_H__
+
+
+#include "Export.h"
+
+#include <cstdint>
+#include <string>
+
+
+namespace Ac
+{
+
+
+/**
+Interned identifier. Equal identifiers are interned to equal symbols,
+so identifiers can be compared and used as table indices without any string operations.
+Symbols are numbered consecutively from 0 on, and stay valid for the lifetime of the program.
+*/
+using Symbol = std::uint32_t;
+
+//! Returns the symbol of the specified identifier (thread-safe).
+AC_EXPORT Symbol InternSymbol(const std::string& ident);
+
+//! Stores the symbol of the specified identifier without interning it, and returns false if it has not been interned yet (thread-safe).
+AC_EXPORT bool FindSymbol(const std::string& ident, Symbol& symbol);
+
+//! Returns the identifier of the specified symbol, or an empty string if the symbol is invalid (thread-safe).
+AC_EXPORT const std::string& SymbolName(Symbol symbol);
+
+//! Returns true if the string is an identifier (e.g. "x" or "_x2"), which is not a reserved word (e.g. "mod" or "sum").
+AC_EXPORT bool IsIdentifier(const std::string& s);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
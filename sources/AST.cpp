@@ -60,6 +60,8 @@ AC_EXPORT BinaryExpr::Operators BinaryExpr::GetOperator(const std::string& spell
         return BinaryOp::Mul;
     if (spell == "/")
         return BinaryOp::Div;
+    if (spell == "div")
+        return BinaryOp::IntDiv;
     if (spell == "mod")
         return BinaryOp::Mod;
     if (spell == "^")
@@ -83,6 +85,8 @@ AC_EXPORT std::string BinaryExpr::GetOperatorSpell(const Operators op)
             return "*";
         case BinaryOp::Div:
             return "/";
+        case BinaryOp::IntDiv:
+            return "div";
         case BinaryOp::Mod:
             return "mod";
         case BinaryOp::Pow:
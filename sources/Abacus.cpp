@@ -11,6 +11,9 @@
 #include "Computer.h"
 #include "../sources/precpkg/fprecision.h"
 
+#include <atomic>
+#include <ostream>
+
 
 namespace Ac
 {
@@ -46,14 +49,72 @@ AC_EXPORT std::string Compute(const std::string& expr, const ComputeMode& mode,
     return ComputeIntern(expr, mode, &constantsSet, log);
 }
 
+static bool ComputeIntern(const std::string& expr, const ComputeMode& mode, ConstantsSet* constantsSet, const OutputCallback& output, Log* log)
+{
+    /* Compute expression */
+    Computer comp;
+    ConstantsSet tempConstSet;
+
+    return comp.ComputeExpr(expr, mode, (constantsSet != nullptr ? *constantsSet : tempConstSet), output, log);
+}
+
+static OutputCallback StreamOutput(std::ostream& output)
+{
+    return [&output](const char* text, std::size_t length)
+    {
+        output.write(text, static_cast<std::streamsize>(length));
+    };
+}
+
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, const OutputCallback& output, Log* log)
+{
+    return ComputeIntern(expr, mode, nullptr, output, log);
+}
+
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, const OutputCallback& output, Log* log)
+{
+    return ComputeIntern(expr, mode, &constantsSet, output, log);
+}
+
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, std::ostream& output, Log* log)
+{
+    return ComputeIntern(expr, mode, nullptr, StreamOutput(output), log);
+}
+
+AC_EXPORT bool Compute(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, std::ostream& output, Log* log)
+{
+    return ComputeIntern(expr, mode, &constantsSet, StreamOutput(output), log);
+}
+
+AC_EXPORT ExactRealPtr ComputeExactReal(const std::string& expr, const ComputeMode& mode, Log* log)
+{
+    ConstantsSet tempConstSet;
+    return ComputeExactReal(expr, mode, tempConstSet, log);
+}
+
+AC_EXPORT ExactRealPtr ComputeExactReal(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log)
+{
+    Computer comp;
+    return comp.ComputeExactReal(expr, mode, constantsSet, log);
+}
+
+AC_EXPORT std::string RefineExactReal(const ExactRealPtr& real, const ComputeMode& mode, Log* log)
+{
+    Computer comp;
+    return comp.RefineExactReal(real, mode, log);
+}
+
+static std::atomic<unsigned int> defaultFloatPrecision(PRECISION);
+
 AC_EXPORT unsigned int GetFloatPrecision()
 {
-    return float_precision_ctrl.precision();
+    return defaultFloatPrecision;
 }
 
 AC_EXPORT void SetFloatPrecision(unsigned int digits)
 {
-    float_precision_ctrl.precision(digits);
+    /* Store process default and keep the legacy per-thread control of the calling thread in sync */
+    defaultFloatPrecision = float_precision_ctrl.precision(digits);
 }
 
 
@@ -7,119 +7,309 @@
 
 #include "Beautifier.h"
 
-#include <sstream>
 #include <algorithm>
+#include <cstring>
 
 
 namespace Ac
 {
 
 
-void BeautifyLiteral(std::string& s, std::size_t maxExp)
+static_assert(RADIX == BASE_10 && F_RADIX == BASE_10, "formatter requires decimal digits in int_precision and float_precision");
+
+/*
+ * ChunkedOutput class
+ */
+
+ChunkedOutput::ChunkedOutput(const OutputCallback& callback, std::size_t chunkSize) :
+    callback_   ( callback              ),
+    buffer_     ( std::max(chunkSize, std::size_t(1)) )
 {
-    if (s.empty())
-        return;
+}
 
-    /* Check and adjust sign */
-    std::size_t signChars = 0;
+void ChunkedOutput::append(const char* s, std::size_t n)
+{
+    while (n > 0)
+    {
+        /* Fill buffer and pass it on when it is full */
+        const auto len = std::min(n, buffer_.size() - size_);
+        std::memcpy(buffer_.data() + size_, s, len);
+
+        size_ += len;
+        s += len;
+        n -= len;
+
+        if (size_ == buffer_.size())
+            Flush();
+    }
+}
+
+void ChunkedOutput::append(std::size_t n, char c)
+{
+    while (n > 0)
+    {
+        const auto len = std::min(n, buffer_.size() - size_);
+        std::memset(buffer_.data() + size_, c, len);
 
+        size_ += len;
+        n -= len;
+
+        if (size_ == buffer_.size())
+            Flush();
+    }
+}
+
+ChunkedOutput& ChunkedOutput::operator += (char c)
+{
+    append(1, c);
+    return *this;
+}
+
+ChunkedOutput& ChunkedOutput::operator += (const char* s)
+{
+    append(s, std::strlen(s));
+    return *this;
+}
+
+void ChunkedOutput::Flush()
+{
+    if (size_ > 0)
+    {
+        if (callback_)
+            callback_(buffer_.data(), size_);
+        size_ = 0;
+    }
+}
+
+
+/*
+ * Global functions
+ */
+
+// Reserves space for 'n' further characters (only needed for the single result string).
+static void Reserve(std::string& out, std::size_t n)
+{
+    out.reserve(out.size() + n);
+}
+
+static void Reserve(ChunkedOutput& out, std::size_t n)
+{
+    // dummy
+}
+
+template <typename Out>
+static void WriteInt(Out& out, const int_precision& x)
+{
+    /* Digits are stored as "[sign][digit]+" */
+    const auto& s = *x.pointer();
     if (s.front() == '+')
-        s.erase(s.begin());
-    else if (s.front() == '-')
-        signChars = 1;
+        out.append(s.data() + 1, s.size() - 1);
+    else
+        out.append(s.data(), s.size());
+}
+
+template <typename Out>
+static void WriteFloat(Out& out, const float_precision& x, const NumberFormat& fmt)
+{
+    /* Mantissa is stored as "[sign][digit]+" with the decimal point after the first digit */
+    const auto& m = *x.ref_mantissa();
+    const char* digits = m.data() + 1;
+    const auto n = m.size() - 1;
+    const bool isNeg = (m.front() == '-');
 
-    /* Find 'E' */
-    auto posE = s.find('E');
-    if (posE == std::string::npos)
+    if (n == 1 && digits[0] == '0')
+    {
+        out += '0';
         return;
+    }
 
-    /* Get exponent value */
-    auto expStr = s.substr(posE + 1);
-    auto posDot = s.find('.');
+    const long long exp = x.exponent();
+    const auto expMag = static_cast<std::size_t>(exp < 0 ? -exp : exp);
 
-    if (expStr.size() < 4)
+    if (expMag < fmt.maxExp)
     {
-        /* Get exponent as integer */
-        int exp = 0;
-        std::istringstream stream(expStr);
-        stream >> exp;
-
-        if (static_cast<std::size_t>(std::abs(exp)) < maxExp)
+        /* Write positional notation, e.g. "1234.5", "1200", or "0.0012" */
+        if (exp >= 0)
         {
-            /* Remove last characters "E0", "E-1", "E1" etc. */
-            s.resize(s.size() - expStr.size() - 1);
+            const auto intDigits = expMag + 1;
 
-            if (exp > 0)
+            Reserve(out, 2 + std::max(n, intDigits));
+            if (isNeg)
+                out += '-';
+
+            if (n <= intDigits)
             {
-                if (posDot == std::string::npos)
-                    s += std::string(exp, '0');
-                else
-                {
-                    while (exp > 0)
-                    {
-                        /* Move '.' right */
-                        if (posDot + 1 < s.size())
-                            std::swap(s[posDot], s[posDot + 1]);
-
-                        ++posDot;
-                        --exp;
-
-                        /* Remove '.' if end has reached and append remaining zeros */
-                        if (s.back() == '.')
-                        {
-                            s.pop_back();
-                            s += std::string(exp, '0');
-                            break;
-                        }
-                    }
-                }
+                out.append(digits, n);
+                out.append(intDigits - n, '0');
             }
-
-            /* Insert missing '.' */
-            if (exp < 0)
+            else
             {
-                if (posDot == std::string::npos)
-                {
-                    posDot = posE;
-                    s.insert(s.begin() + posDot, '.');
-                }
-
-                while (exp < 0)
-                {
-                    if (posDot > 1 + signChars)
-                    {
-                        /* Move '.' left */
-                        std::swap(s[posDot - 1], s[posDot]);
-                        --posDot;
-                    }
-                    else if (posDot == 1 + signChars)
-                    {
-                        /* Move '.' left and insert zero after '.' */
-                        std::swap(s[posDot - 1], s[posDot]);
-                        s.insert(s.begin() + signChars, '0');
-                        --posDot;
-                    }
-                    else
-                    {
-                        /* Insert zero after '.' */
-                        s.insert(s.begin() + 2 + signChars, '0');
-                    }
-
-                    ++exp;
-                }
+                out.append(digits, intDigits);
+                out += '.';
+                out.append(digits + intDigits, n - intDigits);
             }
+        }
+        else
+        {
+            Reserve(out, 2 + expMag + n);
+            if (isNeg)
+                out += '-';
+
+            out += "0.";
+            out.append(expMag - 1, '0');
+            out.append(digits, n);
+        }
+    }
+    else
+    {
+        /* Write scientific notation, e.g. "1.25 * 10^-12" */
+        const auto expStr = std::to_string(exp);
+
+        Reserve(out, 2 + n + std::char_traits<char>::length(fmt.expPrefix) + expStr.size());
+        if (isNeg)
+            out += '-';
+
+        out += digits[0];
+        if (n > 1)
+        {
+            out += '.';
+            out.append(digits + 1, n - 1);
+        }
+
+        out += fmt.expPrefix;
+        out.append(expStr.data(), expStr.size());
+    }
+}
+
+template <typename Out>
+static void WriteComplex(Out& out, const complex_float& x, const NumberFormat& fmt)
+{
+    auto re = x.real(), im = x.imag();
+    const bool hasReal = !(re.ref_mantissa()->size() == 2 && (*re.ref_mantissa())[1] == '0');
+
+    if (hasReal)
+    {
+        WriteFloat(out, re, fmt);
+        out += (im.sign() < 0 ? " - " : " + ");
+        im = abs(im);
+    }
+
+    /* Write imaginary part without unit coefficient, e.g. "i", "-2.5i", or "(1.25 * 10^-12)i" */
+    const auto& m = *im.ref_mantissa();
+    const bool isUnit = (m.size() == 2 && m[1] == '1' && im.exponent() == 0);
+
+    if (isUnit)
+    {
+        if (im.sign() < 0)
+            out += '-';
+    }
+    else
+    {
+        const long long exp = im.exponent();
+        const bool isScientific = (static_cast<std::size_t>(exp < 0 ? -exp : exp) >= fmt.maxExp);
 
-            return;
+        if (isScientific)
+            out += '(';
+        WriteFloat(out, im, fmt);
+        if (isScientific)
+            out += ')';
+    }
+
+    out += 'i';
+}
+
+template <typename Out>
+static void WriteValue(Out& out, const Variable& x, const NumberFormat& fmt);
+
+template <typename Out>
+static void WriteComponents(Out& out, const Variable* components, std::size_t n, const NumberFormat& fmt)
+{
+    out += "[ ";
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        WriteValue(out, components[i], fmt);
+        if (i + 1 < n)
+            out += ", ";
+    }
+
+    out += " ]";
+}
+
+template <typename Out>
+static void WriteValue(Out& out, const Variable& x, const NumberFormat& fmt)
+{
+    if (x.IsVector())
+    {
+        const auto& vec = x.GetVector();
+        WriteComponents(out, vec.data(), vec.size(), fmt);
+    }
+    else if (x.IsMatrix())
+    {
+        /* Write matrices as vectors of rows */
+        const auto& mat = x.GetMatrix();
+        out += "[ ";
+
+        for (std::size_t i = 0; i < mat.rows; ++i)
+        {
+            WriteComponents(out, &mat(i, 0), mat.cols, fmt);
+            if (i + 1 < mat.rows)
+                out += ", ";
         }
+
+        out += " ]";
     }
+    else if (x.IsComplex())
+        WriteComplex(out, x.GetComplex(), fmt);
+    else if (x.IsFloat())
+        WriteFloat(out, x.GetFloat(), fmt);
+    else
+        WriteInt(out, x.GetInt());
+}
+
+
+void FormatInt(std::string& out, const int_precision& x)
+{
+    WriteInt(out, x);
+}
+
+void FormatInt(ChunkedOutput& out, const int_precision& x)
+{
+    WriteInt(out, x);
+}
+
+void FormatFloat(std::string& out, const float_precision& x, const NumberFormat& fmt)
+{
+    WriteFloat(out, x, fmt);
+}
+
+void FormatFloat(ChunkedOutput& out, const float_precision& x, const NumberFormat& fmt)
+{
+    WriteFloat(out, x, fmt);
+}
+
+void FormatComplex(std::string& out, const complex_float& x, const NumberFormat& fmt)
+{
+    WriteComplex(out, x, fmt);
+}
 
-    /* Replace 'E' by " * 10^" */
-    s.replace(posE, 1, " * 10^");
+void FormatComplex(ChunkedOutput& out, const complex_float& x, const NumberFormat& fmt)
+{
+    WriteComplex(out, x, fmt);
 }
 
+void FormatValue(std::string& out, const Variable& x, const NumberFormat& fmt)
+{
+    WriteValue(out, x, fmt);
+}
+
+void FormatValue(ChunkedOutput& out, const Variable& x, const NumberFormat& fmt)
+{
+    WriteValue(out, x, fmt);
+}
 
 } // /namespace Ac
 
 
 
-// ================================================================================
\ No newline at end of file
+// ================================================================================
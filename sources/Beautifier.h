@@ -9,14 +9,70 @@
 #define __AC_BEAUTIFIER_H__
 
 
+#include "precpkg/iprecision.h"
+#include "precpkg/fprecision.h"
+#include "ComplexMath.h"
+#include "Variable.h"
+
+#include <Abacus/Abacus.h>
 #include <string>
+#include <vector>
 
 
 namespace Ac
 {
 
 
-void BeautifyLiteral(std::string& s, std::size_t maxExp = 10);
+//! Notation of formatted numbers.
+struct NumberFormat
+{
+    std::size_t maxExp      = 10;       // decimal exponents with at least this magnitude are written in scientific notation.
+    const char* expPrefix   = " * 10^"; // separator between mantissa and exponent in scientific notation (e.g. "E" for literals).
+};
+
+/**
+Output buffer of bounded size, which passes its content to a callback whenever it is full.
+It provides the appending functions of std::string, so the formatters can write to either of them.
+*/
+class ChunkedOutput
+{
+
+    public:
+        
+        ChunkedOutput(const OutputCallback& callback, std::size_t chunkSize = 65536);
+
+        void append(const char* s, std::size_t n);
+        void append(std::size_t n, char c);
+
+        ChunkedOutput& operator += (char c);
+        ChunkedOutput& operator += (const char* s);
+
+        //! Passes the remaining content to the callback.
+        void Flush();
+
+    private:
+        
+        const OutputCallback&   callback_;
+        std::vector<char>       buffer_;
+        std::size_t             size_       = 0;
+
+};
+
+//! Appends the decimal digits of the integer to 'out' (without a '+' sign).
+void FormatInt(std::string& out, const int_precision& x);
+void FormatInt(ChunkedOutput& out, const int_precision& x);
+
+//! Appends the float to 'out' in positional notation (e.g. "0.00125"), or in scientific notation (e.g. "1.25 * 10^-12").
+void FormatFloat(std::string& out, const float_precision& x, const NumberFormat& fmt = NumberFormat());
+void FormatFloat(ChunkedOutput& out, const float_precision& x, const NumberFormat& fmt = NumberFormat());
+
+//! Appends the complex number to 'out' as "a + bi", where an imaginary part in scientific notation is enclosed in parentheses.
+void FormatComplex(std::string& out, const complex_float& x, const NumberFormat& fmt = NumberFormat());
+void FormatComplex(ChunkedOutput& out, const complex_float& x, const NumberFormat& fmt = NumberFormat());
+
+//! Appends the scalar, or the vector or matrix as "[ a, b ]" or "[ [ a, b ], [ c, d ] ]", to 'out' (rationals must be resolved first).
+void FormatValue(std::string& out, const Variable& x, const NumberFormat& fmt = NumberFormat());
+void FormatValue(ChunkedOutput& out, const Variable& x, const NumberFormat& fmt = NumberFormat());
 
 
 } // /namespace Ac
@@ -26,4 +82,4 @@ void BeautifyLiteral(std::string& s, std::size_t maxExp = 10);
 
 
 
-// ================================================================================
\ No newline at end of file
+// ================================================================================
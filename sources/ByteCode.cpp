@@ -0,0 +1,423 @@
+/*
+ * ByteCode.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "ByteCode.h"
+
+#include <Abacus/Visitor.h>
+#include <algorithm>
+#include <string>
+
+
+namespace Ac
+{
+
+
+// Returns the error message for a wrong number of arguments, or an empty string if the number is valid.
+static std::string ParamCountError(const FunctionDesc& func, std::size_t m)
+{
+    if (func.numParams < 0)
+    {
+        if (m == 0)
+            return "function '" + func.name + "' requires at least 1 argument, but 0 are specified";
+        return "";
+    }
+
+    const auto n = static_cast<std::size_t>(func.numParams);
+
+    if (m == n)
+        return "";
+
+    /* Setup well readable output message */
+    std::string required = (n == 1 ? "1 argument" : std::to_string(n) + " arguments");
+    std::string given = (m == 1 ? "1 is" : std::to_string(m) + " are");
+
+    return "function '" + func.name + "' requires exactly " + required + ", but " + given + " specified";
+}
+
+/*
+Compiles an expression tree into instructions of the register machine.
+Registers are allocated like a stack: each expression stores its value in the register it is compiled into,
+and its sub expressions use the registers above, which are free again when the expression is finished.
+*/
+class ByteCodeCompiler : private Visitor
+{
+
+    public:
+
+        ByteCode Compile(const ExprPtr& ast)
+        {
+            /* Register 0 receives the result */
+            nextRegister_ = 1;
+            byteCode_.numRegisters = 1;
+
+            CompileInto(ast, 0);
+            return std::move(byteCode_);
+        }
+
+    private:
+
+        //! Index variable of an enclosing fold.
+        struct IndexVariable
+        {
+            Symbol          symbol;
+            std::uint32_t   fold;
+        };
+
+        /* --- Visitor --- */
+
+        void VisitUnaryExpr(UnaryExpr* ast, void*) override
+        {
+            const auto dst = dst_;
+
+            CompileInto(ast->expr, dst);
+
+            using Op = UnaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Negate:
+                    Emit(OpCode::Negate, dst);
+                    break;
+                case Op::Factorial:
+                    Emit(OpCode::Factorial, dst);
+                    break;
+                case Op::Norm:
+                    Emit(OpCode::Norm, dst);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void VisitBinaryExpr(BinaryExpr* ast, void*) override
+        {
+            const auto dst = dst_;
+
+            /* Compute 'a*b + c' and 'a*b - c' patterns with a single rounding */
+            if (CompileMulAddExpr(ast, dst))
+                return;
+
+            /* Evaluate sub expressions */
+            CompileInto(ast->exprL, dst);
+
+            const auto rhs = Allocate(1);
+            CompileInto(ast->exprR, rhs);
+
+            /* Compute binary operation */
+            using Op = BinaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Add:
+                    Emit(OpCode::Add, dst, rhs);
+                    break;
+                case Op::Sub:
+                    Emit(OpCode::Sub, dst, rhs);
+                    break;
+                case Op::Mul:
+                    Emit(OpCode::Mul, dst, rhs);
+                    break;
+                case Op::Div:
+                    Emit(OpCode::Div, dst, rhs);
+                    break;
+                case Op::IntDiv:
+                    Emit(OpCode::IntDiv, dst, rhs);
+                    break;
+                case Op::Mod:
+                    Emit(OpCode::Mod, dst, rhs);
+                    break;
+                case Op::Pow:
+                    Emit(OpCode::Pow, dst, rhs);
+                    break;
+                case Op::LShift:
+                    Emit(OpCode::LShift, dst, rhs);
+                    break;
+                case Op::RShift:
+                    Emit(OpCode::RShift, dst, rhs);
+                    break;
+                default:
+                    break;
+            }
+
+            Release(rhs);
+        }
+
+        void VisitLiteralExpr(LiteralExpr* ast, void*) override
+        {
+            /* Decode literal only once */
+            Emit(OpCode::Literal, dst_, 0, 0, static_cast<std::uint32_t>(byteCode_.literals.size()));
+            byteCode_.literals.push_back(Variable(ast->value));
+        }
+
+        void VisitIdentExpr(IdentExpr* ast, void*) override
+        {
+            /* Index variables of the enclosing folds hide all constants */
+            if (auto index = FindIndex(ast->symbol))
+                Emit(OpCode::Index, dst_, 0, 0, index->fold);
+            else
+                Emit(OpCode::Const, dst_, 0, 0, ast->symbol);
+        }
+
+        void VisitFuncExpr(FuncExpr* ast, void*) override
+        {
+            const auto dst = dst_;
+
+            /* Fail when the function is unknown or called with invalid arguments (the parser already resolved the function) */
+            if (!ast->func)
+            {
+                Emit(OpCode::Fail, dst, 0, 0, AddMessage("unknown function '" + ast->name + "'"));
+                return;
+            }
+
+            auto err = ParamCountError(*ast->func, ast->args.size());
+            if (!err.empty())
+            {
+                Emit(OpCode::Fail, dst, 0, 0, AddMessage(err));
+                return;
+            }
+
+            /* Evaluate arguments into consecutive registers */
+            const auto n = static_cast<std::uint32_t>(ast->args.size());
+            const auto first = Allocate(n);
+
+            for (std::uint32_t i = 0; i < n; ++i)
+                CompileInto(ast->args[i], first + i);
+
+            Emit(OpCode::Call, dst, first, n, AddFunction(ast->func));
+
+            Release(first);
+        }
+
+        void VisitFoldExpr(FoldExpr* ast, void*) override
+        {
+            const auto dst = dst_;
+
+            FoldInfo fold;
+            fold.index      = ast->indexSymbol;
+            fold.isSum      = (ast->func == "sum");
+            fold.isGaussSum = (
+                fold.isSum && ast->loopExpr->Type() == Expr::Types::Ident &&
+                static_cast<IdentExpr*>(ast->loopExpr.get())->value == ast->index
+            );
+            fold.isShadowing = (FindIndex(ast->indexSymbol) != nullptr);
+
+            /* Evaluate index range */
+            fold.first  = Allocate(2);
+            fold.last   = fold.first + 1;
+
+            CompileInto(ast->initExpr, fold.first);
+            CompileInto(ast->iterExpr, fold.last);
+
+            const auto foldIndex = static_cast<std::uint32_t>(byteCode_.folds.size());
+            byteCode_.folds.push_back(fold);
+
+            Emit(OpCode::FoldBegin, dst, 0, 0, foldIndex);
+
+            /* Evaluate loop expression, where the identifier of the index variable refers to the index of this fold */
+            byteCode_.folds[foldIndex].loop = CurrentInstruction();
+
+            indices_.push_back({ ast->indexSymbol, foldIndex });
+
+            const auto value = Allocate(1);
+            CompileInto(ast->loopExpr, value);
+            Emit(OpCode::FoldNext, dst, value, 0, foldIndex);
+
+            indices_.pop_back();
+
+            byteCode_.folds[foldIndex].exit         = CurrentInstruction();
+            byteCode_.folds[foldIndex].isParallel   = CallsOnlyPureBuiltins(byteCode_.folds[foldIndex].loop, CurrentInstruction());
+
+            Release(fold.first);
+        }
+
+        void VisitVectorExpr(VectorExpr* ast, void*) override
+        {
+            const auto dst = dst_;
+
+            /* Evaluate components into consecutive registers */
+            const auto n = static_cast<std::uint32_t>(ast->components.size());
+            const auto first = Allocate(n);
+
+            for (std::uint32_t i = 0; i < n; ++i)
+                CompileInto(ast->components[i], first + i);
+
+            Emit(OpCode::Vector, dst, first, n);
+
+            Release(first);
+        }
+
+        void VisitDefExpr(DefExpr* ast, void*) override
+        {
+            const auto dst = dst_;
+
+            CompileInto(ast->expr, dst);
+            Emit(OpCode::Define, dst, 0, 0, ast->symbol);
+        }
+
+        /* --- Common --- */
+
+        static BinaryExpr* GetMulExpr(const ExprPtr& expr)
+        {
+            if (expr->Type() == Expr::Types::Binary)
+            {
+                auto binExpr = static_cast<BinaryExpr*>(expr.get());
+                if (binExpr->op == BinaryExpr::Operators::Mul)
+                    return binExpr;
+            }
+            return nullptr;
+        }
+
+        bool CompileMulAddExpr(BinaryExpr* ast, std::uint32_t dst)
+        {
+            using Op = BinaryExpr::Operators;
+
+            if (ast->op != Op::Add && ast->op != Op::Sub)
+                return false;
+
+            /* Evaluate sub expressions in the same order as the unfused operation */
+            if (auto mulExpr = GetMulExpr(ast->exprL))
+            {
+                /* a*b + c, a*b - c */
+                CompileInto(mulExpr->exprL, dst);
+
+                const auto b = Allocate(2);
+                const auto c = b + 1;
+
+                CompileInto(mulExpr->exprR, b);
+                CompileInto(ast->exprR, c);
+
+                Emit((ast->op == Op::Add ? OpCode::MulAdd : OpCode::MulSub), dst, b, c);
+
+                Release(b);
+            }
+            else if (auto mulExpr = GetMulExpr(ast->exprR))
+            {
+                /*
+                c + a*b, c - a*b = (-a)*b + c
+                (the negation of a is exact, so the single rounding of c - a*b goes in the direction of the rounding mode)
+                */
+                const auto c = Allocate(2);
+                const auto b = c + 1;
+
+                CompileInto(ast->exprL, c);
+                CompileInto(mulExpr->exprL, dst);
+                CompileInto(mulExpr->exprR, b);
+
+                if (ast->op == Op::Sub)
+                    Emit(OpCode::Negate, dst);
+                Emit(OpCode::MulAdd, dst, b, c);
+
+                Release(c);
+            }
+            else
+                return false;
+
+            return true;
+        }
+
+        void CompileInto(const ExprPtr& ast, std::uint32_t dst)
+        {
+            dst_ = dst;
+            Visit(ast);
+        }
+
+        void Emit(OpCode opcode, std::uint32_t dst, std::uint32_t a = 0, std::uint32_t b = 0, std::uint32_t arg = 0)
+        {
+            Instruction inst;
+            {
+                inst.opcode = opcode;
+                inst.dst    = dst;
+                inst.a      = a;
+                inst.b      = b;
+                inst.arg    = arg;
+            }
+            byteCode_.code.push_back(inst);
+        }
+
+        std::uint32_t CurrentInstruction() const
+        {
+            return static_cast<std::uint32_t>(byteCode_.code.size());
+        }
+
+        std::uint32_t AddMessage(const std::string& msg)
+        {
+            byteCode_.messages.push_back(msg);
+            return static_cast<std::uint32_t>(byteCode_.messages.size() - 1);
+        }
+
+        // Returns true if the instructions in [begin, end) only call pure built-in functions (i.e. no native functions and no 'rand').
+        bool CallsOnlyPureBuiltins(std::uint32_t begin, std::uint32_t end) const
+        {
+            for (auto pc = begin; pc < end; ++pc)
+            {
+                const auto& inst = byteCode_.code[pc];
+                if (inst.opcode == OpCode::Call)
+                {
+                    const auto func = byteCode_.functions[inst.arg];
+                    if (!func->pure || func->impl)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        std::uint32_t AddFunction(const FunctionDesc* func)
+        {
+            byteCode_.functions.push_back(func);
+            return static_cast<std::uint32_t>(byteCode_.functions.size() - 1);
+        }
+
+        // Returns the innermost index variable with the specified identifier, or null if there is no such index variable.
+        const IndexVariable* FindIndex(Symbol symbol) const
+        {
+            for (auto it = indices_.rbegin(); it != indices_.rend(); ++it)
+            {
+                if (it->symbol == symbol)
+                    return &(*it);
+            }
+            return nullptr;
+        }
+
+        // Allocates 'n' consecutive registers and returns the first one.
+        std::uint32_t Allocate(std::uint32_t n)
+        {
+            const auto first = nextRegister_;
+            nextRegister_ += n;
+            byteCode_.numRegisters = std::max(byteCode_.numRegisters, nextRegister_);
+            return first;
+        }
+
+        // Releases all registers from 'first' on.
+        void Release(std::uint32_t first)
+        {
+            nextRegister_ = first;
+        }
+
+        ByteCode                    byteCode_;
+        std::uint32_t               nextRegister_   = 0;
+        std::uint32_t               dst_            = 0;
+        std::vector<IndexVariable>  indices_;       // index variables in scope (innermost last).
+
+};
+
+
+/*
+ * Global functions
+ */
+
+ByteCode CompileExpr(const ExprPtr& ast)
+{
+    ByteCodeCompiler compiler;
+    return compiler.Compile(ast);
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
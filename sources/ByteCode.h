@@ -0,0 +1,148 @@
+/*
+ * ByteCode.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_BYTE_CODE_H__
+#define __AC_BYTE_CODE_H__
+
+
+#include "Variable.h"
+
+#include <Abacus/AST.h>
+#include <Abacus/Functions.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace Ac
+{
+
+
+//! IDs of the built-in functions in the function registry.
+enum class Function : FunctionID
+{
+    Sin,
+    Cos,
+    Tan,
+    SinCos,
+    Sinh,
+    Cosh,
+    Tanh,
+    ASin,
+    ACos,
+    ATan,
+    ATan2,
+    ASinh,
+    ACosh,
+    ATanh,
+    Pow,
+    Sqrt,
+    Exp,
+    Log,
+    Log10,
+    Abs,
+    Re,
+    Im,
+    Arg,
+    Conj,
+    Ceil,
+    Floor,
+    Sign,
+    Rand,
+    Min,
+    Max,
+    Norm,
+    Dot,
+    Cross,
+    Normalize,
+    MatMul,
+    Transpose,
+    Det,
+    Inv,
+    Solve,
+};
+
+/*
+Instructions of the register machine. Each instruction stores its result in register 'dst',
+and binary operations compute 'dst = dst op a' in place (the operand register 'a' may be modified).
+*/
+enum class OpCode : std::uint8_t
+{
+    Literal,    // dst = literals[arg]
+    Const,      // dst = value of constant with symbol arg
+    Index,      // dst = value of the index variable of fold arg
+    Negate,     // dst = -dst
+    Factorial,  // dst = dst!
+    Norm,       // dst = |dst|
+    Add,        // dst = dst + a
+    Sub,        // dst = dst - a
+    Mul,        // dst = dst * a
+    Div,        // dst = dst / a
+    IntDiv,     // dst = dst div a
+    Mod,        // dst = dst mod a
+    Pow,        // dst = dst ^ a
+    LShift,     // dst = dst << a
+    RShift,     // dst = dst >> a
+    MulAdd,     // dst = dst * a + b
+    MulSub,     // dst = dst * a - b
+    Call,       // dst = functions[arg] with the 'b' arguments in the registers [a, a + b)
+    Vector,     // dst = vector (or matrix) of the 'b' components in the registers [a, a + b)
+    Define,     // constant with symbol arg = dst
+    FoldBegin,  // dst = initial value of fold arg, and jumps behind the fold if it has no iterations to compute
+    FoldNext,   // dst = dst + a (or dst * a) for fold arg, and jumps to the loop expression for the next iteration
+    Fail,       // throws an error with the message messages[arg]
+};
+
+struct Instruction
+{
+    OpCode          opcode;
+    std::uint32_t   dst = 0;
+    std::uint32_t   a   = 0;
+    std::uint32_t   b   = 0;
+    std::uint32_t   arg = 0;
+};
+
+//! Static information about a fold expression.
+struct FoldInfo
+{
+    Symbol          index       = 0;        // identifier of the index variable.
+    bool            isSum       = true;     // sum or product.
+    bool            isGaussSum  = false;    // sum of the index variable itself.
+    bool            isShadowing = false;    // index variable has the same identifier as the index of an enclosing fold.
+    bool            isParallel  = false;    // iterations can be computed in any order and thread (loop expression only calls pure built-in functions).
+    std::uint32_t   first       = 0;        // register of the first index.
+    std::uint32_t   last        = 0;        // register of the last index.
+    std::uint32_t   loop        = 0;        // first instruction of the loop expression.
+    std::uint32_t   exit        = 0;        // instruction behind the loop.
+};
+
+//! Compiled expression, whose result is stored in register 0.
+struct ByteCode
+{
+    std::vector<Instruction>            code;
+    std::vector<Variable>               literals;       // pre-decoded literal values.
+    std::vector<const FunctionDesc*>    functions;      // resolved functions of all calls.
+    std::vector<std::string>            messages;       // error messages.
+    std::vector<FoldInfo>               folds;
+    std::uint32_t                       numRegisters    = 0;
+};
+
+/**
+Compiles the specified expression tree into bytecode.
+\remarks Literals are decoded with the current float precision.
+*/
+ByteCode CompileExpr(const ExprPtr& ast);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
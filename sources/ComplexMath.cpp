@@ -0,0 +1,355 @@
+/*
+ * ComplexMath.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "ComplexMath.h"
+#include "PrecisionUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+
+namespace Ac
+{
+
+
+// Maximal sum of the exponent differences between real and imaginary parts, for which products use three multiplications.
+static const int maxMulSpread = 6;
+
+// Number of guard digits for powers, which amplify the errors of their logarithms by the magnitude of the exponent.
+static const unsigned int powGuardDigits = 8;
+
+complex_float ComplexMul(const complex_float& x, const complex_float& y)
+{
+    const auto a = x.real(), b = x.imag(), c = y.real(), d = y.imag();
+    const auto prec = float_precision_ctrl.precision();
+
+    if (!IsZero(a) && !IsZero(b) && !IsZero(c) && !IsZero(d))
+    {
+        const int spread = std::abs(a.exponent() - b.exponent()) + std::abs(c.exponent() - d.exponent());
+        if (spread <= maxMulSpread)
+        {
+            /*
+            Product with three multiplications: k1 = c(a + b), k2 = a(d - c), k3 = b(c + d), and x*y = (k1 - k3) + (k1 + k2)i.
+            The sums of the parts are exact with these guard digits, which also cover the cancellation in the final sums
+            */
+            const auto guard = prec + 2 + static_cast<unsigned int>(spread);
+
+            auto s = Extended(a, guard);
+            s += b;
+            auto k1 = Extended(c, guard);
+            k1 *= s;
+
+            s = d;
+            s -= c;
+            auto k2 = Extended(a, guard);
+            k2 *= s;
+
+            s = c;
+            s += d;
+            auto k3 = Extended(b, guard);
+            k3 *= s;
+
+            k2 += k1;
+            k1 -= k3;
+
+            return complex_float(Rounded(k1), Rounded(k2));
+        }
+    }
+
+    /* Product with four multiplications, for parts of very different magnitudes and for real or imaginary factors */
+    const auto guard = prec + 2;
+
+    auto ac = Extended(a, guard);
+    ac *= c;
+    auto bd = Extended(b, guard);
+    bd *= d;
+    auto ad = Extended(a, guard);
+    ad *= d;
+    auto bc = Extended(b, guard);
+    bc *= c;
+
+    ac -= bd;
+    ad += bc;
+
+    return complex_float(Rounded(ac), Rounded(ad));
+}
+
+complex_float ComplexDiv(const complex_float& x, const complex_float& y)
+{
+    if (IsZero(y))
+        throw float_precision::divide_by_zero();
+
+    const auto a = x.real(), b = x.imag(), c = y.real(), d = y.imag();
+
+    /*
+    x/y = ((ac + bd) + (bc - ad)i) / (c^2 + d^2), where the products are exact with twice the digits of the parts,
+    so only the sums and the final divisions are rounded (the exponent range of float_precision avoids overflows)
+    */
+    const auto wide = 2 * std::max(std::max(a.precision(), b.precision()), std::max(c.precision(), d.precision())) + 2;
+    const auto guard = float_precision_ctrl.precision() + 2;
+
+    float_precision re, im;
+    {
+        ScopedPrecision scope(wide);
+
+        auto ac = Extended(a, wide);
+        ac *= c;
+        auto bd = Extended(b, wide);
+        bd *= d;
+        auto bc = Extended(b, wide);
+        bc *= c;
+        auto ad = Extended(a, wide);
+        ad *= d;
+        auto cc = Extended(c, wide);
+        cc *= c;
+        auto dd = Extended(d, wide);
+        dd *= d;
+
+        ac += bd;
+        bc -= ad;
+        cc += dd;
+
+        float_precision_ctrl.precision(guard);
+
+        re = Extended(ac, guard);
+        re /= cc;
+        im = Extended(bc, guard);
+        im /= cc;
+    }
+
+    return complex_float(Rounded(re), Rounded(im));
+}
+
+complex_float ComplexPow(const complex_float& x, const int_precision& n)
+{
+    /* Exponents beyond machine words only make sense for values on the unit circle */
+    if (n.size() > 10)
+        return ComplexPow(x, complex_float(float_precision(n, float_precision_ctrl.precision(), float_precision_ctrl.mode())));
+
+    if (n.sign() < 0)
+        return ComplexDiv(complex_float(float_precision(1)), ComplexPow(x, -n));
+
+    auto k = static_cast<unsigned long>(n);
+
+    /* Repeated squaring with guard digits for the rounding errors of its up to 2*log2(n) products */
+    const auto guard = float_precision_ctrl.precision() + 2 + static_cast<unsigned int>(n.size());
+
+    complex_float y;
+    {
+        ScopedPrecision scope(guard);
+
+        complex_float base(Extended(x, guard));
+        y = complex_float(Extended(float_precision(1), guard));
+
+        while (k > 0)
+        {
+            if ((k & 1) != 0)
+                y = ComplexMul(y, base);
+            k >>= 1;
+            if (k > 0)
+                base = ComplexMul(base, base);
+        }
+    }
+
+    return Rounded(y);
+}
+
+complex_float ComplexPow(const complex_float& x, const complex_float& y)
+{
+    if (IsZero(x))
+    {
+        /* 0^y = 0 for Re(y) > 0 */
+        if (y.real().sign() > 0 && !IsZero(y.real()))
+            return complex_float();
+        throw float_precision::domain_error();
+    }
+
+    const auto prec = float_precision_ctrl.precision();
+    const auto guard = prec + powGuardDigits;
+
+    complex_float z;
+    {
+        ScopedPrecision scope(guard);
+
+        const auto w = ComplexMul(Extended(y, guard), ComplexLog(Extended(x, guard)));
+        z = ComplexExp(w);
+
+        /*
+        Flush parts below the error bound |z|*(1 + |w|)*10^(1-guard), which are residues of the rounding errors
+        (e.g. the real part of i^2.5), and which are beyond the working precision relative to the magnitude
+        */
+        auto bound = ComplexAbs(z);
+        bound *= float_precision(1) + ComplexAbs(w);
+        bound *= float_precision(("1E" + std::to_string(1 - static_cast<int>(guard))).c_str());
+
+        if (abs(z.real()) <= bound)
+            z = complex_float(float_precision(0), z.imag());
+        if (abs(z.imag()) <= bound)
+            z = complex_float(z.real(), float_precision(0));
+    }
+
+    return Rounded(z);
+}
+
+complex_float ComplexPowNegativeReal(const float_precision& x, const int_precision& p, const int_precision& q)
+{
+    const auto guard = float_precision_ctrl.precision() + powGuardDigits;
+
+    /* Reduce the angle p/q*pi exactly to r/q*pi with r in [0, 2q) */
+    const auto q2 = q + q;
+    auto r = p % q2;
+    if (r < int_precision(0))
+        r += q2;
+
+    float_precision c, s;
+
+    if (r == int_precision(0))
+        c = float_precision(1);
+    else if (r == q)
+        c = float_precision(-1);
+    else if (r + r == q)
+        s = float_precision(1);
+    else if (r + r == q2 + q)
+        s = float_precision(-1);
+    else
+    {
+        ScopedPrecision scope(guard);
+        auto angle = float_precision(r, guard, float_precision_ctrl.mode());
+        angle /= float_precision(q, guard, float_precision_ctrl.mode());
+        angle *= _float_table(_PI, guard);
+        sincos(angle, &s, &c);
+    }
+
+    /* Magnitude |x|^(p/q) */
+    float_precision m;
+    {
+        ScopedPrecision scope(guard);
+        auto y = float_precision(p, guard, float_precision_ctrl.mode());
+        y /= float_precision(q, guard, float_precision_ctrl.mode());
+        m = pow(abs(Extended(x, guard)), y);
+    }
+
+    return complex_float(Rounded(m * c), Rounded(m * s));
+}
+
+complex_float ComplexPowNegativeReal(const float_precision& x, const float_precision& y)
+{
+    /* Write exponent as fraction p/q with q = 10^k, where p are the digits of the mantissa */
+    const auto& m = *y.ref_mantissa();
+    const auto k = static_cast<long>(m.size()) - 2 - y.exponent();
+
+    int_precision p(m.c_str()), q(1);
+
+    if (k > 0)
+        q = ipow(int_precision(10), int_precision(k));
+    else if (k < 0)
+        p *= ipow(int_precision(10), int_precision(-k));
+
+    return ComplexPowNegativeReal(x, p, q);
+}
+
+complex_float ComplexSqrt(const complex_float& x)
+{
+    const auto guard = float_precision_ctrl.precision() + 2;
+
+    complex_float z;
+    {
+        ScopedPrecision scope(guard);
+        z = sqrt(Extended(x, guard));
+    }
+
+    return Rounded(z);
+}
+
+complex_float ComplexExp(const complex_float& x)
+{
+    /* exp(a + bi) = exp(a) * (cos(b) + i*sin(b)), with guard digits for the final products */
+    const auto guard = float_precision_ctrl.precision() + 2;
+
+    float_precision s, c;
+    sincos(Extended(x.imag(), guard), &s, &c);
+
+    const auto r = exp(Extended(x.real(), guard));
+
+    return complex_float(Rounded(r * c), Rounded(r * s));
+}
+
+complex_float ComplexLog(const complex_float& x)
+{
+    if (IsZero(x))
+        throw float_precision::domain_error();
+
+    /* log(x) = log|x| + i*arg(x), where the magnitude is computed with guard digits */
+    const auto guard = float_precision_ctrl.precision() + 2;
+
+    float_precision re;
+    {
+        ScopedPrecision scope(guard);
+        re = log(ComplexAbs(Extended(x, guard)));
+    }
+
+    return complex_float(Rounded(re), ComplexArg(x));
+}
+
+complex_float ComplexSin(const complex_float& x)
+{
+    /* sin(a + bi) = sin(a)cosh(b) + i*cos(a)sinh(b) */
+    const auto guard = float_precision_ctrl.precision() + 2;
+
+    float_precision s, c, sh, ch;
+    sincos(Extended(x.real(), guard), &s, &c);
+    sinhcosh(Extended(x.imag(), guard), &sh, &ch);
+
+    return complex_float(Rounded(s * ch), Rounded(c * sh));
+}
+
+complex_float ComplexCos(const complex_float& x)
+{
+    /* cos(a + bi) = cos(a)cosh(b) - i*sin(a)sinh(b) */
+    const auto guard = float_precision_ctrl.precision() + 2;
+
+    float_precision s, c, sh, ch;
+    sincos(Extended(x.real(), guard), &s, &c);
+    sinhcosh(Extended(x.imag(), guard), &sh, &ch);
+
+    return complex_float(Rounded(c * ch), Rounded(-(s * sh)));
+}
+
+float_precision ComplexAbs(const complex_float& x)
+{
+    const auto a = x.real(), b = x.imag();
+
+    if (IsZero(a))
+        return abs(b);
+    if (IsZero(b))
+        return abs(a);
+
+    /* sqrt(a^2 + b^2) with guard digits (the exponent range of float_precision avoids overflows) */
+    const auto guard = float_precision_ctrl.precision() + 2;
+
+    auto aa = Extended(a, guard);
+    aa *= a;
+    auto bb = Extended(b, guard);
+    bb *= b;
+    aa += bb;
+
+    return Rounded(sqrt(aa));
+}
+
+float_precision ComplexArg(const complex_float& x)
+{
+    const auto guard = float_precision_ctrl.precision() + 2;
+    return Rounded(atan2(Extended(x.imag(), guard), Extended(x.real(), guard)));
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
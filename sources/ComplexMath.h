@@ -0,0 +1,72 @@
+/*
+ * ComplexMath.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_COMPLEX_MATH_H__
+#define __AC_COMPLEX_MATH_H__
+
+
+#include "precpkg/iprecision.h"
+#include "precpkg/fprecision.h"
+#include "precpkg/complexprecision.h"
+
+
+namespace Ac
+{
+
+
+typedef complex_precision<float_precision> complex_float;
+
+/*
+Complex arithmetic and elementary functions with the precision and rounding mode of the current float context.
+All functions return the principal values, with the branch cuts along the negative real axis.
+*/
+
+//! Returns x*y with three real multiplications if the real and imaginary parts have similar magnitudes.
+complex_float ComplexMul(const complex_float& x, const complex_float& y);
+
+//! Returns x/y (throws float_precision::divide_by_zero if y is zero).
+complex_float ComplexDiv(const complex_float& x, const complex_float& y);
+
+//! Returns x^n by repeated squaring.
+complex_float ComplexPow(const complex_float& x, const int_precision& n);
+
+//! Returns x^y = exp(y*log(x)), where parts below the rounding errors are zero.
+complex_float ComplexPow(const complex_float& x, const complex_float& y);
+
+/**
+Returns the principal value x^(p/q) = |x|^(p/q) * (cos(p/q*pi) + i*sin(p/q*pi)) for a negative real x and q > 0.
+The angle is reduced exactly, so multiples of pi/2 give exact zero parts (e.g. (-2)^0.5 = 1.414...i).
+*/
+complex_float ComplexPowNegativeReal(const float_precision& x, const int_precision& p, const int_precision& q);
+
+//! Returns the principal value x^y for a negative real x, where the exponent is written as exact fraction of its digits.
+complex_float ComplexPowNegativeReal(const float_precision& x, const float_precision& y);
+
+complex_float ComplexSqrt(const complex_float& x);
+
+//! Returns exp(x) with a single real exponential and a single sine/cosine evaluation.
+complex_float ComplexExp(const complex_float& x);
+
+complex_float ComplexLog(const complex_float& x);
+complex_float ComplexSin(const complex_float& x);
+complex_float ComplexCos(const complex_float& x);
+
+//! Returns the magnitude |x|.
+float_precision ComplexAbs(const complex_float& x);
+
+//! Returns the angle of x in the range (-pi, pi].
+float_precision ComplexArg(const complex_float& x);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -6,8 +6,22 @@
  */
 
 #include "Computer.h"
+#include "FastComputer.h"
+#include "MultiDouble.h"
+#include "FixedPrecision.h"
 #include "Beautifier.h"
-
+#include "ExactReal.h"
+#include "Interval.h"
+#include "VectorMath.h"
+#include "MatrixMath.h"
+#include "ConstantValue.h"
+#include "Parallel.h"
+#include "PrecisionUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
 #include <random>
 
 
@@ -21,68 +35,12 @@ static void LogError(Log* log, const std::string& msg)
         log->Error(msg);
 }
 
-static std::string AdjustResult(const Variable& result)
-{
-    std::string s;
-
-    if (result.IsVector())
-    {
-        const auto& vec = result.GetVector();
-        s = "[ ";
-
-        for (std::size_t i = 0, n = vec.size(); i < n; ++i)
-        {
-            s += AdjustResult(vec[i]);
-            if (i + 1 < n)
-                s += ", ";
-        }
-
-        s += " ]";
-        return s;
-    }
-    else
-    {
-        s = result;
-        BeautifyLiteral(s);
-    }
-
-    return s;
-}
-
-static bool FuncFilter(const std::string& ident)
-{
-    static const char* funcNames[] =
-    {
-        "sin", "cos", "tan", "sinh", "cosh", "tanh", "asin", "acos", "atan", "asinh", "acosh", "atanh",
-        "pow", "sqrt", "exp", "log", "log10", "abs", "ceil", "floor", "sign", "rand", "min", "max", "norm",
-        nullptr
-    };
-
-    for (auto names = funcNames; *names != nullptr; ++names)
-    {
-        if (ident == *names)
-            return true;
-    }
-
-    return false;
-}
-
-std::string Computer::ComputeExpr(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log)
+// Logs the message of the current exception (must be called inside a catch block).
+static void LogException(Log* log)
 {
-    /* Setup constant set */
-    mode_           = mode;
-    constantsSet_   = &constantsSet;
-
     try
     {
-        /* Parse expression stream */
-        auto ast = ParseExpression(expr, log, FuncFilter);
-        if (ast)
-        {
-            /* Compute AST and return (beautified) result */
-            Visit(ast);
-            return AdjustResult(Top());
-        }
+        throw;
     }
     catch (const std::exception& err)
     {
@@ -124,503 +82,1049 @@ std::string Computer::ComputeExpr(const std::string& expr, const ComputeMode& mo
     {
         LogError(log, "base error");
     }
+}
 
-    ClearTempConsts();
-
-    return "";
+static enum round_mode ToRoundMode(const RoundingMode mode)
+{
+    switch (mode)
+    {
+        case RoundingMode::Up:      return ROUND_UP;
+        case RoundingMode::Down:    return ROUND_DOWN;
+        case RoundingMode::Zero:    return ROUND_ZERO;
+        default:                    return ROUND_NEAR;
+    }
 }
 
+/*
+Installs the float precision and rounding mode of a compute mode for the current thread,
+and restores the previous ones when it goes out of scope.
+*/
+class ScopedFloatContext
+{
+    
+    public:
+        
+        ScopedFloatContext(const ComputeMode& mode) :
+            precision_  ( float_precision_ctrl.precision() ),
+            rounding_   ( float_precision_ctrl.mode()      )
+        {
+            float_precision_ctrl.precision(mode.precision > 0 ? mode.precision : GetFloatPrecision());
+            float_precision_ctrl.mode(ToRoundMode(mode.rounding));
+        }
+        ~ScopedFloatContext()
+        {
+            float_precision_ctrl.precision(precision_);
+            float_precision_ctrl.mode(rounding_);
+        }
+
+    private:
+        
+        unsigned int    precision_;
+        enum round_mode rounding_;
+
+};
 
 /*
- * ======= Private: =======
- */
+Reduces a sequence of sums or products with a balanced binary tree, whose shape only depends on the number of values.
+Values are combined in order like the digits of a binary counter, so the operands of each step have similar sizes
+(e.g. the large partial products of a factorial are multiplied with each other instead of with small factors).
+*/
+class FoldReduction
+{
 
-void Computer::Error(const std::string& msg)
+    public:
+
+        FoldReduction(bool isSum) :
+            isSum_( isSum )
+        {
+        }
+
+        void Push(Variable value)
+        {
+            std::size_t level = 0;
+            for (; !values_.empty() && values_.back().second == level; ++level)
+            {
+                auto lhs = std::move(values_.back().first);
+                values_.pop_back();
+                Combine(lhs, value);
+                value = std::move(lhs);
+            }
+            values_.emplace_back(std::move(value), level);
+        }
+
+        Variable Result()
+        {
+            if (values_.empty())
+                return Variable(int_precision(isSum_ ? 0 : 1));
+
+            /* Combine the remaining subtrees from the smallest one on */
+            auto value = std::move(values_.back().first);
+            values_.pop_back();
+
+            while (!values_.empty())
+            {
+                auto lhs = std::move(values_.back().first);
+                values_.pop_back();
+                Combine(lhs, value);
+                value = std::move(lhs);
+            }
+
+            return value;
+        }
+
+    private:
+
+        void Combine(Variable& lhs, Variable& rhs) const
+        {
+            if (isSum_)
+                lhs.Add(rhs);
+            else
+                lhs.Mul(rhs);
+        }
+
+        bool                                            isSum_;
+        std::vector<std::pair<Variable, std::size_t>>   values_;    // subtrees with their levels (each level is lower than the previous one).
+
+};
+
+// Number of iterations from which folds are computed in chunks, and the bounds of the chunk count and size.
+static const long long          foldParallelThreshold   = 1024;
+static const unsigned long long foldChunkSize           = 256;
+static const unsigned long long foldMaxChunks           = 1024;
+
+// Number of guard digits for the conversion between degrees and radians.
+static const unsigned int       degreeGuardDigits       = 2;
+
+// Maximal number of digits which are computed in hardware floats (unless quick answers are requested).
+static const unsigned int       fastHardwareDigits      = 15;
+
+/*
+Returns true if the expression only consists of integer literals, integer operators, and folds over them.
+Its result is exact in arbitrary precision, so there is nothing to gain from the fast path.
+*/
+static bool IsIntegerExpr(const Expr* ast, std::vector<Symbol>& indices)
 {
-    throw std::runtime_error("math error: " + msg);
+    using Types = Expr::Types;
+
+    switch (ast->Type())
+    {
+        case Types::Literal:
+            return !static_cast<const LiteralExpr*>(ast)->isFloat;
+
+        case Types::Ident:
+        {
+            /* Only fold indices are integers for sure */
+            auto symbol = static_cast<const IdentExpr*>(ast)->symbol;
+            return (std::find(indices.begin(), indices.end(), symbol) != indices.end());
+        }
+
+        case Types::Unary:
+            return IsIntegerExpr(static_cast<const UnaryExpr*>(ast)->expr.get(), indices);
+
+        case Types::Binary:
+        {
+            auto binExpr = static_cast<const BinaryExpr*>(ast);
+            return ( binExpr->op != BinaryExpr::Operators::Div &&
+                     IsIntegerExpr(binExpr->exprL.get(), indices) &&
+                     IsIntegerExpr(binExpr->exprR.get(), indices) );
+        }
+
+        case Types::Fold:
+        {
+            auto foldExpr = static_cast<const FoldExpr*>(ast);
+            if (!IsIntegerExpr(foldExpr->initExpr.get(), indices) || !IsIntegerExpr(foldExpr->iterExpr.get(), indices))
+                return false;
+
+            indices.push_back(foldExpr->indexSymbol);
+            auto result = IsIntegerExpr(foldExpr->loopExpr.get(), indices);
+            indices.pop_back();
+
+            return result;
+        }
+
+        default:
+            return false;
+    }
 }
 
-void Computer::VisitUnaryExpr(UnaryExpr* ast, void* args)
+static NumberFormat ResultFormat(const ComputeMode& mode)
 {
-    /* Evaluate sub expressions */
-    Visit(ast->expr);
-    auto& value = Top();
+    NumberFormat fmt;
+    fmt.maxExp = mode.scientificExp;
+    return fmt;
+}
+
+// Converts the integer to a machine integer, if it has at most 18 digits (so it can still be incremented).
+static bool ToMachineInt(const int_precision& x, long long& value)
+{
+    const auto& s = *x.pointer();
 
-    /* Compute unary operation */
-    using Op = UnaryExpr::Operators;
+    if (s.size() > 19)
+        return false;
 
-    switch (ast->op)
+    value = std::strtoll(s.c_str(), nullptr, 10);
+    return true;
+}
+
+static int_precision FromMachineInt(long long value)
+{
+    if (value >= std::numeric_limits<long>::min() && value <= std::numeric_limits<long>::max())
+        return int_precision(static_cast<long>(value));
+    return int_precision(std::to_string(value).c_str());
+}
+
+std::string Computer::ComputeExpr(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log)
+{
+    /* Return (beautified) result */
+    std::string result;
+    if (ComputeValue(expr, mode, constantsSet, log))
+        FormatValue(result, result_, ResultFormat(mode_));
+    return result;
+}
+
+bool Computer::ComputeExpr(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, const OutputCallback& output, Log* log)
+{
+    if (!ComputeValue(expr, mode, constantsSet, log))
+        return false;
+
+    /* Write (beautified) result in chunks directly from the digits of the result */
+    ChunkedOutput out(output);
+    FormatValue(out, result_, ResultFormat(mode_));
+    out.Flush();
+
+    return true;
+}
+
+ExactRealPtr Computer::ComputeExactReal(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log)
+{
+    ScopedFloatContext floatContext(mode);
+
+    try
     {
-        case Op::Keep:
-            // do nothing
-            break;
-        case Op::Negate:
-            value.Negate();
-            break;
-        case Op::Factorial:
-            value.Factorial();
-            break;
-        case Op::Norm:
-            value.Norm();
-            break;
+        /* Build computation graph, whose approximations are computed on demand */
+        auto ast = ParseExpression(expr, log);
+        if (ast)
+            return BuildRealGraph(ast, mode, constantsSet);
     }
+    catch (...)
+    {
+        LogException(log);
+    }
+
+    return nullptr;
 }
 
-void Computer::VisitBinaryExpr(BinaryExpr* ast, void* args)
+std::string Computer::RefineExactReal(const ExactRealPtr& real, const ComputeMode& mode, Log* log)
 {
-    /* Evaluate sub expressions */
-    Visit(ast->exprL);
-    auto valueL = Pop();
+    ScopedFloatContext floatContext(mode);
+
+    std::string result;
+
+    try
+    {
+        /* Return (beautified) result, rounded from approximations which are precise enough */
+        if (real)
+            FormatValue(result, Variable(RoundRealGraph(*real)), ResultFormat(mode));
+    }
+    catch (...)
+    {
+        LogException(log);
+    }
 
-    Visit(ast->exprR);
-    auto valueR = Pop();
+    return result;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+bool Computer::ComputeValue(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log)
+{
+    /* Setup constant set */
+    mode_           = mode;
+    constantsSet_   = &constantsSet;
 
-    /* Compute binary operation */
-    using Op = BinaryExpr::Operators;
+    /* Setup float precision and rounding mode for this thread */
+    ScopedFloatContext floatContext(mode);
 
-    switch (ast->op)
+    try
     {
-        case Op::Add:
-            valueL.Add(valueR);
-            break;
-        case Op::Sub:
-            valueL.Sub(valueR);
-            break;
-        case Op::Mul:
-            valueL.Mul(valueR);
-            break;
-        case Op::Div:
-            valueL.Div(valueR);
-            break;
-        case Op::Mod:
-            valueL.Mod(valueR);
-            break;
-        case Op::Pow:
-            valueL.Pow(valueR);
-            break;
-        case Op::LShift:
-            valueL.LShift(valueR);
-            break;
-        case Op::RShift:
-            valueL.RShift(valueR);
-            break;
+        /* Parse expression stream */
+        auto ast = ParseExpression(expr, log);
+        if (ast)
+        {
+            /* Try to compute AST with hardware floating-point arithmetic first (unless intervals are requested), and store the result */
+            if (mode.interval)
+            {
+                /* Compute enclosure of the result, and store its bounds */
+                auto x = ComputeInterval(ast, mode, constantsSet);
+                std::vector<Variable> bounds { Variable(x.lower), Variable(x.upper) };
+                result_ = Variable(std::move(bounds));
+            }
+            else if (!ComputeFastExpr(ast))
+            {
+                /* Compile AST into bytecode, whose literals and functions are resolved only once */
+                Execute(CompileExpr(ast));
+
+                /* Materialize exact rationals with the working precision */
+                result_.ResolveRational();
+            }
+            return true;
+        }
+    }
+    catch (...)
+    {
+        LogException(log);
     }
 
-    /* Push result onto stack */
-    Push(valueL);
+    return false;
 }
 
-void Computer::VisitLiteralExpr(LiteralExpr* ast, void* args)
+
+void Computer::Error(const std::string& msg)
 {
-    /* Push literal value onto stack */
-    Push(Variable(ast->value));
+    throw std::runtime_error("math error: " + msg);
 }
 
-void Computer::VisitIdentExpr(IdentExpr* ast, void* args)
+bool Computer::ComputeFastExpr(const ExprPtr& ast)
 {
-    /* Try to find constant */
-    auto it = constantsSet_->constants.find(ast->value);
-    if (it != constantsSet_->constants.end())
+    /* Definitions are stored by the arbitrary precision computer, and integer expressions are exact there anyway */
+    std::vector<Symbol> indices;
+    if (ast->Type() == Expr::Types::Def || IsIntegerExpr(ast.get(), indices))
+        return false;
+
+    /* Compute AST with running error bounds in the smallest type which can hold the requested digits */
+    const auto digits = float_precision_ctrl.precision();
+
+    if (mode_.quick || digits <= fastHardwareDigits)
     {
-        /* Push value onto stack */
-        Push(Variable(it->second));
+        /* Quick answers are accepted with the digits of the hardware type */
+        return ComputeFastExprWith<long double>(ast, std::min(digits, FastTraits<long double>::Digits()));
     }
-    else
-        Error("undefined constant '" + ast->value + "'");
+
+    if (digits <= FastTraits<DoubleDouble>::Digits())
+        return ComputeFastExprWith<DoubleDouble>(ast, digits);
+    if (digits <= FastTraits<fixed_float<256>>::Digits())
+        return ComputeFastExprWith<fixed_float<256>>(ast, digits);
+    if (digits <= FastTraits<fixed_float<512>>::Digits())
+        return ComputeFastExprWith<fixed_float<512>>(ast, digits);
+
+    return false;
 }
 
-void Computer::VisitFuncExpr(FuncExpr* ast, void* args)
+template <typename T>
+bool Computer::ComputeFastExprWith(const ExprPtr& ast, unsigned int digits)
 {
-    /* Find function */
-    auto f = ast->name;
-    
-    auto ParamCount = [&](std::size_t n)
+    Variable value;
+
+    FastComputer<T> comp;
+    if (!comp.ComputeExpr(ast, mode_, *constantsSet_, digits, value))
+        return false;
+
+    result_ = std::move(value);
+    return true;
+}
+
+void Computer::Execute(const ByteCode& byteCode)
+{
+    /* Setup registers and fold states, which are reused by all iterations of folds */
+    registers_.resize(byteCode.numRegisters);
+    folds_.resize(byteCode.folds.size());
+
+    Run(byteCode, 0, byteCode.code.size());
+
+    result_ = std::move(registers_[0]);
+}
+
+void Computer::Run(const ByteCode& byteCode, std::size_t begin, std::size_t end)
+{
+    auto R = registers_.data();
+
+    const auto code = byteCode.code.data();
+
+    for (std::size_t pc = begin; pc < end;)
     {
-        auto m = ast->args.size();
+        const auto& inst = code[pc++];
 
-        if (m != n)
+        switch (inst.opcode)
         {
-            /* Setup well readable output message */
-            std::string required = (n == 1 ? "1 argument" : std::to_string(n) + " arguments");
-            std::string given = (m == 1 ? "1 is" : std::to_string(m) + " are");
+            case OpCode::Literal:
+                R[inst.dst] = byteCode.literals[inst.arg];
+                break;
+            case OpCode::Const:
+                R[inst.dst] = ConstValue(inst.arg);
+                break;
+            case OpCode::Negate:
+                R[inst.dst].Negate();
+                break;
+            case OpCode::Factorial:
+                R[inst.dst].Factorial();
+                break;
+            case OpCode::Norm:
+                R[inst.dst].Norm();
+                break;
+            case OpCode::Add:
+                R[inst.dst].Add(R[inst.a]);
+                break;
+            case OpCode::Sub:
+                R[inst.dst].Sub(R[inst.a]);
+                break;
+            case OpCode::Mul:
+                R[inst.dst].Mul(R[inst.a]);
+                break;
+            case OpCode::Div:
+                R[inst.dst].Div(R[inst.a]);
+                break;
+            case OpCode::IntDiv:
+                R[inst.dst].IntDiv(R[inst.a]);
+                break;
+            case OpCode::Mod:
+                R[inst.dst].Mod(R[inst.a]);
+                break;
+            case OpCode::Pow:
+                R[inst.dst].Pow(R[inst.a]);
+                break;
+            case OpCode::LShift:
+                R[inst.dst].LShift(R[inst.a]);
+                break;
+            case OpCode::RShift:
+                R[inst.dst].RShift(R[inst.a]);
+                break;
+            case OpCode::MulAdd:
+                R[inst.dst].MulAdd(R[inst.a], R[inst.b]);
+                break;
+            case OpCode::MulSub:
+                R[inst.dst].MulSub(R[inst.a], R[inst.b]);
+                break;
+            case OpCode::Call:
+                R[inst.dst] = CallFunction(*byteCode.functions[inst.arg], &R[inst.a], inst.b);
+                break;
+            case OpCode::Vector:
+                R[inst.dst] = VectorValue(&R[inst.a], inst.b);
+                break;
+            case OpCode::Define:
+                StoreConst(inst.arg, R[inst.dst]);
+                break;
+            case OpCode::FoldBegin:
+            {
+                const auto& fold = byteCode.folds[inst.arg];
+                auto& state = folds_[inst.arg];
+
+                if (!BeginFold(fold, state, R[inst.dst]))
+                    pc = fold.exit;
+                else if (fold.isParallel && state.isMachineInt && state.last - state.index >= foldParallelThreshold - 1)
+                {
+                    /* Compute large folds in chunks on the task pool, and continue behind the loop */
+                    R[inst.dst] = ComputeFoldChunks(byteCode, inst.arg);
+                    pc = fold.exit;
+                }
+            }
+            break;
+            case OpCode::FoldNext:
+            {
+                const auto& fold = byteCode.folds[inst.arg];
+                auto& state = folds_[inst.arg];
+
+                /* Fold with result */
+                if (fold.isSum)
+                    R[inst.dst].Add(R[inst.a]);
+                else
+                    R[inst.dst].Mul(R[inst.a]);
 
-            Error(
-                "function '" + ast->name + "' requires exactly " +
-                required + ", but " + given + " specified"
-            );
+                /* Compute next iteration */
+                if (NextFoldIndex(state))
+                    pc = fold.loop;
+            }
+            break;
+            case OpCode::Index:
+                R[inst.dst] = FoldIndexValue(folds_[inst.arg]);
+                break;
+            case OpCode::Fail:
+                Error(byteCode.messages[inst.arg]);
+                break;
         }
-    };
+    }
+}
+
+Variable Computer::CallFunction(const FunctionDesc& func, Variable* args, std::size_t numArgs)
+{
+    /* Call registered native function */
+    if (func.impl)
+        return CallNativeFunction(func, args, numArgs);
 
-    auto ParamCountNot0 = [&]()
+    const auto& name = func.name;
+    const auto id = static_cast<Function>(func.id);
+
+    auto ScalarParam = [&](std::size_t i) -> Variable&
     {
-        if (ast->args.empty())
-            Error("function '" + ast->name + "' requires at least 1 argument, but 0 are specified");
+        /* Check if this is a scalar */
+        if (!args[i].IsScalar())
+            Error("function '" + name + "' requires arguments of a scalar type");
+        return args[i];
     };
 
-    auto Param = [&](std::size_t i) -> float_precision
+    auto RealValue = [&](Variable& val) -> float_precision
     {
-        /* Evaluate argument */
-        Visit(ast->args[i]);
-        auto val = Pop();
-
-        /* Check if this is a scalar */
-        if (!val.IsScalar())
-            Error("function '" + ast->name + "' requires arguments of a scalar type");
+        /* Check if this is a real number */
+        if (val.IsComplex())
+            Error("function '" + name + "' requires arguments of a real type");
 
         /* Return float precision value */
         val.ToFloat();
         return val.GetFloat();
     };
 
-    auto VecParam = [&](std::size_t i) -> Variable
+    auto ComplexValue = [&](Variable& val) -> complex_float
     {
-        /* Evaluate argument */
-        Visit(ast->args[i]);
-        auto val = Pop();
-
-        /* Check if this is a scalar */
-        if (!val.IsVector())
-            Error("function '" + ast->name + "' requires arguments of a vector type");
-
-        /* Return float precision value */
-        return val;
+        val.ToComplex();
+        return val.GetComplex();
     };
 
-    auto Deg2Rad = [&](const float_precision& x) -> float_precision
+    auto Param = [&](std::size_t i) -> float_precision
     {
-        return mode_.degree ? (x * _float_table(_PI, GetFloatPrecision()) / float_precision(180.0)) : x;
+        return RealValue(ScalarParam(i));
     };
 
-    auto Rad2Deg = [&](const float_precision& x) -> float_precision
+    auto VecParam = [&](std::size_t i) -> Variable&
     {
-        return mode_.degree ? (x * float_precision(180.0) / _float_table(_PI, GetFloatPrecision())) : x;
+        /* Check if this is a vector */
+        if (!args[i].IsVector())
+            Error("function '" + name + "' requires arguments of a vector type");
+        return args[i];
     };
 
-    if (f == "sin")
-    {
-        ParamCount(1);
-        Push(sin(Deg2Rad(Param(0))));
-    }
-    else if (f == "cos")
-    {
-        ParamCount(1);
-        Push(cos(Deg2Rad(Param(0))));
-    }
-    else if (f == "tan")
-    {
-        ParamCount(1);
-        Push(tan(Deg2Rad(Param(0))));
-    }
-    else if (f == "sinh")
-    {
-        ParamCount(1);
-        Push(sinh(Param(0)));
-    }
-    else if (f == "cosh")
-    {
-        ParamCount(1);
-        Push(cosh(Param(0)));
-    }
-    else if (f == "tanh")
-    {
-        ParamCount(1);
-        Push(tanh(Param(0)));
-    }
-    else if (f == "asin")
-    {
-        ParamCount(1);
-        Push(Rad2Deg(asin(Param(0))));
-    }
-    else if (f == "acos")
-    {
-        ParamCount(1);
-        Push(Rad2Deg(acos(Param(0))));
-    }
-    else if (f == "atan")
-    {
-        ParamCount(1);
-        Push(Rad2Deg(atan(Param(0))));
-    }
-    else if (f == "atan2")
-    {
-        ParamCount(2);
-        Push(Rad2Deg(atan2(Param(0), Param(1))));
-    }
-    else if (f == "asinh")
+    auto MatParam = [&](std::size_t i) -> Variable&
     {
-        ParamCount(1);
-        Push(asinh(Param(0)));
-    }
-    else if (f == "acosh")
-    {
-        ParamCount(1);
-        Push(acosh(Param(0)));
-    }
-    else if (f == "atanh")
-    {
-        ParamCount(1);
-        Push(atanh(Param(0)));
-    }
-    else if (f == "pow")
-    {
-        ParamCount(2);
-        Push(pow(Param(0), Param(1)));
-    }
-    else if (f == "sqrt")
-    {
-        ParamCount(1);
-        Push(sqrt(Param(0)));
-    }
-    else if (f == "exp")
-    {
-        ParamCount(1);
-        Push(exp(Param(0)));
-    }
-    else if (f == "log")
-    {
-        ParamCount(1);
-        Push(log(Param(0)));
-    }
-    else if (f == "log10")
-    {
-        ParamCount(1);
-        Push(log10(Param(0)));
-    }
-    else if (f == "abs")
+        if (!args[i].IsMatrix())
+            Error("function '" + name + "' requires arguments of a matrix type");
+        return args[i];
+    };
+
+    // Matrix or vector parameter.
+    auto LinearParam = [&](std::size_t i) -> Variable&
     {
-        ParamCount(1);
-        Push(abs(Param(0)));
-    }
-    else if (f == "ceil")
+        if (args[i].IsScalar())
+            Error("function '" + name + "' requires arguments of a matrix or vector type");
+        return args[i];
+    };
+
+    const auto workingPrecision = float_precision_ctrl.precision();
+
+    // Converts degrees to radians with guard digits, which the trigonometric functions keep until their result is rounded.
+    auto Deg2Rad = [&](const float_precision& x) -> float_precision
     {
-        ParamCount(1);
-        Push(ceil(Param(0)).to_int_precision());
-    }
-    else if (f == "floor")
+        if (!mode_.degree)
+            return x;
+        const auto prec = workingPrecision + degreeGuardDigits;
+        ScopedPrecision scope(prec);
+        return Extended(x, prec) * _float_table(_PI, prec) / float_precision(180.0);
+    };
+
+    // Converts radians (with the guard digits of ArcParam) to degrees, rounded to the working precision.
+    auto Rad2Deg = [&](const float_precision& x) -> float_precision
     {
-        ParamCount(1);
-        Push(floor(Param(0)).to_int_precision());
-    }
-    else if (f == "sign")
+        if (!mode_.degree)
+            return x;
+        ScopedPrecision scope(x.precision());
+        return Extended(x * float_precision(180.0) / _float_table(_PI, x.precision()), workingPrecision);
+    };
+
+    // Argument of the inverse trigonometric functions, with guard digits for the conversion of their result to degrees.
+    auto ArcParam = [&](std::size_t i) -> float_precision
     {
-        ParamCount(1);
-        Visit(ast->args.front());
-        Top().Sign();
-    }
-    else if (f == "rand")
+        auto x = Param(i);
+        return (mode_.degree ? Extended(x, workingPrecision + degreeGuardDigits) : x);
+    };
+
+    auto ComplexDeg2Rad = [&](const complex_float& x) -> complex_float
     {
-        ParamCount(0);
-        
-        /* Generate random number in the range [0, 1] */
-        std::random_device rd;
-        std::mt19937_64 gen(rd());
-        std::uniform_real_distribution<> dist(0, 1);
+        return mode_.degree ? complex_float(Deg2Rad(x.real()), Deg2Rad(x.imag())) : x;
+    };
 
-        Push(float_precision(dist(gen)));
-    }
-    else if (f == "min")
+    switch (id)
     {
-        ParamCountNot0();
+        case Function::Sin:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex())
+                return ComplexSin(ComplexDeg2Rad(x.GetComplex()));
+            return Rounded(sin(Deg2Rad(RealValue(x))));
+        }
+
+        case Function::Cos:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex())
+                return ComplexCos(ComplexDeg2Rad(x.GetComplex()));
+            return Rounded(cos(Deg2Rad(RealValue(x))));
+        }
 
-        /* Get first value */
-        auto it = ast->args.begin();
-        Visit(*it);
-        auto result = Pop();
+        case Function::Tan:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex())
+            {
+                auto z = ComplexDeg2Rad(x.GetComplex());
+                return ComplexDiv(ComplexSin(z), ComplexCos(z));
+            }
+            return Rounded(tan(Deg2Rad(RealValue(x))));
+        }
 
-        /* Apply minification with all other arguments */
-        for (++it; it != ast->args.end(); ++it)
+        case Function::SinCos:
         {
-            Visit(*it);
-            result.Min(Pop());
+            /* Compute sine and cosine with a single argument reduction */
+            float_precision s, c;
+            sincos(Deg2Rad(Param(0)), &s, &c);
+
+            std::vector<Variable> vector(2);
+            vector[0] = Rounded(s);
+            vector[1] = Rounded(c);
+
+            return Variable(std::move(vector));
         }
 
-        Push(result);
-    }
-    else if (f == "max")
-    {
-        ParamCountNot0();
+        case Function::Sinh:
+            return sinh(Param(0));
+
+        case Function::Cosh:
+            return cosh(Param(0));
 
-        /* Get first value */
-        auto it = ast->args.begin();
-        Visit(*it);
-        auto result = Pop();
+        case Function::Tanh:
+            return tanh(Param(0));
 
-        /* Apply minification with all other arguments */
-        for (++it; it != ast->args.end(); ++it)
+        case Function::ASin:
+            return Rad2Deg(asin(ArcParam(0)));
+
+        case Function::ACos:
         {
-            Visit(*it);
-            result.Max(Pop());
+            /* acos takes pi at the working precision, which must include the guard digits */
+            auto x = ArcParam(0);
+            ScopedPrecision scope(x.precision());
+            return Rad2Deg(acos(x));
         }
 
-        Push(result);
-    }
-    else if (f == "norm")
-    {
-        ParamCount(1);
-        auto& var = VecParam(0);
-        var.Norm();
-        Push(var);
-    }
-    else
-        Error("unknown function '" + f + "'");
-}
+        case Function::ATan:
+            return Rad2Deg(atan(ArcParam(0)));
 
-void Computer::VisitFoldExpr(FoldExpr* ast, void* args)
-{
-    /* Check if initialization and iteration expressions have integer type */
-    Visit(ast->initExpr);
-    auto initVal = Pop();
+        case Function::ATan2:
+        {
+            auto y = ArcParam(0);
+            return Rad2Deg(atan2(y, ArcParam(1)));
+        }
 
-    Visit(ast->iterExpr);
-    auto iterVal = Pop();
+        case Function::ASinh:
+            return asinh(Param(0));
 
-    if (initVal.IsFloat() || iterVal.IsFloat())
-        Error("fold function '" + ast->func + "' can only have discrete iterations");
+        case Function::ACosh:
+            return acosh(Param(0));
 
-    /* Register temporary index variable */
-    PushTempConst(ast->index);
+        case Function::ATanh:
+            return atanh(Param(0));
 
-    /* Fold loop expression */
-    auto idx = initVal.GetInt();
-    auto idxEnd = iterVal.GetInt();
+        case Function::Pow:
+        {
+            auto& x = ScalarParam(0);
+            auto& y = ScalarParam(1);
+            if (x.IsComplex() || y.IsComplex() || x.IsNegative())
+            {
+                /* Complex powers and principal values of negative bases */
+                x.Pow(y);
+                return std::move(x);
+            }
+            auto base = RealValue(x);
+            return pow(base, RealValue(y));
+        }
 
-    bool isSum = (ast->func == "sum");
-    Variable result(std::string(isSum ? "0" : "1"));
+        case Function::Sqrt:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex() || x.IsNegative())
+                return ComplexSqrt(ComplexValue(x));
+            return sqrt(RealValue(x));
+        }
 
-    if (idxEnd >= idx)
-    {
-        if ( isSum && ast->loopExpr->Type() == Expr::Types::Ident &&
-             static_cast<IdentExpr*>(ast->loopExpr.get())->value == ast->index &&
-             idx >= 0 )
+        case Function::Exp:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex())
+                return ComplexExp(x.GetComplex());
+            return exp(RealValue(x));
+        }
+
+        case Function::Log:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex() || x.IsNegative())
+                return ComplexLog(ComplexValue(x));
+            return log(RealValue(x));
+        }
+
+        case Function::Log10:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex() || x.IsNegative())
+                return ComplexDiv(ComplexLog(ComplexValue(x)), complex_float(log(float_precision(10))));
+            return log10(RealValue(x));
+        }
+
+        case Function::Abs:
+        {
+            auto& x = ScalarParam(0);
+            if (x.IsComplex())
+                return ComplexAbs(x.GetComplex());
+            return abs(RealValue(x));
+        }
+
+        case Function::Re:
         {
-            /* Apply gaussian sum formula: 1 + 2 + ... + n = n(n+1)/2 */
-            const int_precision one(1), two(2);
-            idxEnd = (idxEnd*(idxEnd + one)) / two;
+            auto& x = ScalarParam(0);
+            return (x.IsComplex() ? Variable(x.GetComplex().real()) : x);
+        }
+
+        case Function::Im:
+        {
+            auto& x = ScalarParam(0);
+            return (x.IsComplex() ? Variable(x.GetComplex().imag()) : Variable(int_precision(0)));
+        }
+
+        case Function::Arg:
+            return Rad2Deg(ComplexArg(ComplexValue(ScalarParam(0))));
+
+        case Function::Conj:
+        {
+            auto& x = ScalarParam(0);
+            return (x.IsComplex() ? Variable(x.GetComplex().conj()) : x);
+        }
+
+        case Function::Ceil:
+            return ceil(Param(0)).to_int_precision();
+
+        case Function::Floor:
+            return floor(Param(0)).to_int_precision();
+
+        case Function::Sign:
+            args[0].Sign();
+            return std::move(args[0]);
+
+        case Function::Rand:
+        {
+            /* Generate random number in the range [0, 1] */
+            std::random_device rd;
+            std::mt19937_64 gen(rd());
+            std::uniform_real_distribution<> dist(0, 1);
 
-            if (idx > 1)
+            return float_precision(dist(gen));
+        }
+
+        case Function::Min:
+        case Function::Max:
+        {
+            /* Apply minification (or maxification) with all other arguments */
+            auto& result = args[0];
+
+            for (std::size_t i = 1; i < numArgs; ++i)
             {
-                /*
-                Subtract overplus if index variable starts with value > 1:
-                k + (k+1) + ... + n = n(n+1)/2 - (k-1)k/2
-                */
-                idx = ((idx - one)*idx)/two;
-                idxEnd -= idx;
+                if (id == Function::Min)
+                    result.Min(args[i]);
+                else
+                    result.Max(args[i]);
             }
 
-            /* Set result */
-            result = Variable(idxEnd);
+            return std::move(result);
         }
-        else
+
+        case Function::Norm:
         {
-            while (idx <= idxEnd)
-            {
-                /* Setup new value for index variable */
-                StoreConst(ast->index, idx.toString());
+            auto& var = VecParam(0);
+            var.Norm();
+            return std::move(var);
+        }
 
-                /* Compute current iteration */
-                Visit(ast->loopExpr);
-                auto val = Pop();
-        
-                /* Fold with result */
-                if (isSum)
-                    result.Add(val);
-                else
-                    result.Mul(val);
+        case Function::Dot:
+        {
+            auto& a = VecParam(0);
+            auto& b = VecParam(1);
+            return VecDot(a.GetVector(), b.GetVector());
+        }
 
-                ++idx;
-            }
+        case Function::Cross:
+        {
+            auto& a = VecParam(0);
+            auto& b = VecParam(1);
+            return VecCross(a.GetVector(), b.GetVector());
         }
-    }
 
-    /* Unregister temporary index variable */
-    PopTempConst();
+        case Function::Normalize:
+            return VecNormalize(VecParam(0).GetVector());
 
-    /* Return result */
-    Push(result);
-}
+        case Function::MatMul:
+        {
+            auto& a = LinearParam(0);
+            auto& b = LinearParam(1);
+            return MatMul(a, b);
+        }
 
-void Computer::VisitVectorExpr(VectorExpr* ast, void* args)
-{
-    std::vector<Variable> vector(ast->components.size());
+        case Function::Transpose:
+            return MatTranspose(LinearParam(0));
 
-    for (std::size_t i = 0, n = ast->components.size(); i < n; ++i)
-    {
-        Visit(ast->components[i]);
-        vector[i] = Pop();
+        case Function::Det:
+            return MatDet(MatParam(0).GetMatrix());
+
+        case Function::Inv:
+            return MatInverse(MatParam(0).GetMatrix());
+
+        case Function::Solve:
+        {
+            auto& a = MatParam(0);
+            auto& b = LinearParam(1);
+            return MatSolve(a.GetMatrix(), b);
+        }
     }
 
-    Push(Variable(std::move(vector)));
+    Error("unknown function '" + name + "'");
+    return Variable();
 }
 
-void Computer::VisitDefExpr(DefExpr* ast, void* args)
+Variable Computer::ConstValue(Symbol symbol)
 {
-    /* Compute definition value */
-    Visit(ast->expr);
-    std::string value = Top();
+    /* Try to find constant, whose stored value is shared by all references */
+    if (auto value = constantsSet_->Find(symbol))
+        return LoadConst(*value);
+
+    const auto& ident = SymbolName(symbol);
 
-    /* Store (beautified) result in constant */
-    StoreConst(ast->ident, value);
+    /* Imaginary unit, unless 'i' is defined otherwise (e.g. as index variable) */
+    if (ident == "i")
+        return Variable(complex_float(float_precision(0), float_precision(1)));
+
+    Error("undefined constant '" + ident + "'");
+    return Variable();
 }
 
-void Computer::Push(const Variable& value)
+Variable Computer::VectorValue(Variable* components, std::size_t n)
 {
-    values_.push(value);
+    if (n > 0 && components[0].IsVector())
+    {
+        /* Vectors of vectors are the rows of a matrix */
+        const auto cols = components[0].GetVector().size();
+
+        Matrix matrix(n, cols);
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (!components[i].IsVector() || components[i].GetVector().size() != cols)
+                Error("matrix rows must be vectors of the same dimension");
+
+            auto& row = components[i].GetVector();
+            std::move(row.begin(), row.end(), &matrix(i, 0));
+        }
+
+        return Variable(std::move(matrix));
+    }
+
+    /* Vectors are flat arrays of scalars */
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!components[i].IsScalar())
+            Error("vector components must be scalars");
+    }
+
+    return Variable(std::vector<Variable>(std::make_move_iterator(components), std::make_move_iterator(components + n)));
 }
 
-Variable Computer::Pop()
+bool Computer::BeginFold(const FoldInfo& fold, FoldState& state, Variable& result)
 {
-    if (values_.empty())
-        Error("stack underflow");
-    auto val = values_.top();
-    values_.pop();
-    return val;
+    auto& initVal = registers_[fold.first];
+    auto& iterVal = registers_[fold.last];
+
+    /* Check if initialization and iteration expressions have integer type */
+    if ( initVal.IsFloat() || initVal.IsRational() || initVal.IsComplex() ||
+         iterVal.IsFloat() || iterVal.IsRational() || iterVal.IsComplex() )
+        Error("fold function '" + std::string(fold.isSum ? "sum" : "product") + "' can only have discrete iterations");
+
+    /* Check if identifier is already an index variable or a registered constant */
+    if (fold.isShadowing || constantsSet_->Contains(fold.index))
+        Error("index variable '" + SymbolName(fold.index) + "' already defined in this scope");
+
+    const auto& first   = initVal.GetInt();
+    const auto& last    = iterVal.GetInt();
+
+    result = Variable(int_precision(fold.isSum ? 0 : 1));
+
+    if (last < first)
+        return false;
+
+    if (fold.isGaussSum && first >= int_precision(0))
+    {
+        /* Apply gaussian sum formula: 1 + 2 + ... + n = n(n+1)/2 */
+        const int_precision one(1), two(2);
+        auto sum = (last*(last + one)) / two;
+
+        if (first > one)
+        {
+            /*
+            Subtract overplus if index variable starts with value > 1:
+            k + (k+1) + ... + n = n(n+1)/2 - (k-1)k/2
+            */
+            sum -= ((first - one)*first)/two;
+        }
+
+        /* Set result */
+        result = Variable(std::move(sum));
+
+        return false;
+    }
+
+    /* Setup first value for index variable */
+    state.isMachineInt  = (ToMachineInt(first, state.index) && ToMachineInt(last, state.last));
+    state.hasValue      = false;
+
+    if (!state.isMachineInt)
+    {
+        state.bigIndex  = first;
+        state.bigLast   = last;
+    }
+
+    return true;
 }
 
-Variable& Computer::Top()
+Variable Computer::ComputeFoldChunks(const ByteCode& byteCode, std::uint32_t foldIndex)
 {
-    if (values_.empty())
-        Error("empty stack");
-    return values_.top();
+    const auto& fold    = byteCode.folds[foldIndex];
+    const auto& state   = folds_[foldIndex];
+
+    /* Split range into chunks, whose size only depends on the number of iterations (so the result is independent of the number of threads) */
+    const auto numIterations = static_cast<unsigned long long>(state.last - state.index) + 1;
+
+    auto chunkSize = foldChunkSize;
+    while (numIterations > chunkSize * foldMaxChunks)
+        chunkSize *= 2;
+
+    const auto numChunks = static_cast<std::size_t>((numIterations + chunkSize - 1) / chunkSize);
+
+    std::vector<Variable> partials(numChunks);
+    std::atomic<std::size_t> firstFailedChunk(numChunks);
+
+    TaskGroup group;
+
+    for (std::size_t i = 0; i < numChunks; ++i)
+    {
+        group.Run(
+            [&, i]()
+            {
+                /* Skip chunks behind a failed one, since only the error of the first failed chunk is reported */
+                if (i > firstFailedChunk)
+                    return;
+
+                /* Compute chunk in its own evaluator context, which refers to the same constants and the index variables of the enclosing folds */
+                Computer context;
+                context.mode_           = mode_;
+                context.constantsSet_   = constantsSet_;
+                context.folds_          = folds_;
+                context.registers_.resize(registers_.size());
+
+                const auto first    = state.index + static_cast<long long>(i * chunkSize);
+                const auto last     = std::min(first + static_cast<long long>(chunkSize - 1), state.last);
+
+                try
+                {
+                    partials[i] = context.ComputeFoldChunk(byteCode, foldIndex, first, last);
+                }
+                catch (...)
+                {
+                    for (auto j = firstFailedChunk.load(); i < j && !firstFailedChunk.compare_exchange_weak(j, i);)
+                        ;
+                    throw;
+                }
+            }
+        );
+    }
+
+    group.Wait();
+
+    /* Reduce partial results in order (products of large chunks are multiplied with each other) */
+    FoldReduction reduction(fold.isSum);
+
+    for (auto& value : partials)
+        reduction.Push(std::move(value));
+
+    return reduction.Result();
 }
 
-void Computer::StoreConst(const std::string& ident, std::string value)
+Variable Computer::ComputeFoldChunk(const ByteCode& byteCode, std::uint32_t foldIndex, long long first, long long last)
 {
-    BeautifyLiteral(value);
-    constantsSet_->constants[ident] = value;
+    const auto& fold    = byteCode.folds[foldIndex];
+    const auto& next    = byteCode.code[fold.exit - 1];
+    auto&       state   = folds_[foldIndex];
+
+    state.isMachineInt  = true;
+    state.index         = first;
+    state.last          = last;
+    state.hasValue      = false;
+
+    if (fold.isSum)
+    {
+        /* Run loop of the fold for this range, which adds its values to the result register of the FoldNext instruction */
+        registers_[next.dst] = Variable(int_precision(0));
+        Run(byteCode, fold.loop, fold.exit);
+        return std::move(registers_[next.dst]);
+    }
+
+    /* Compute loop expression (without the FoldNext instruction) for each index, and multiply the values with a balanced tree */
+    FoldReduction reduction(false);
+
+    do
+    {
+        Run(byteCode, fold.loop, fold.exit - 1);
+        reduction.Push(std::move(registers_[next.a]));
+    }
+    while (NextFoldIndex(state));
+
+    return reduction.Result();
 }
 
-void Computer::PushTempConst(const std::string& ident)
+bool Computer::NextFoldIndex(FoldState& state)
 {
-    const auto& constList = constantsSet_->constants;
+    state.hasValue = false;
 
-    /* Check if identifier is already a registered constant */
-    if (constList.find(ident) != constList.end())
-        Error("index variable '" + ident + "' already defined in this scope");
+    if (state.isMachineInt)
+        return (++state.index <= state.last);
 
-    /* Push onto stack of temporary constants */
-    tempConsts_.push(ident);
+    ++state.bigIndex;
+    return (state.bigIndex <= state.bigLast);
 }
 
-void Computer::PopTempConst()
+const Variable& Computer::FoldIndexValue(FoldState& state)
 {
-    auto& constList = constantsSet_->constants;
-    
-    /* Remove from constant list */
-    auto it = constList.find(tempConsts_.top());
-    if (it != constList.end())
-        constList.erase(it);
+    if (!state.hasValue)
+    {
+        state.value     = Variable(state.isMachineInt ? FromMachineInt(state.index) : state.bigIndex);
+        state.hasValue  = true;
+    }
+    return state.value;
+}
 
-    /* Pop from stack of temporary constants */
-    tempConsts_.pop();
+void Computer::StoreConst(Symbol symbol, Variable value)
+{
+    /* Store value with all its digits (rationals stay exact, and are only rounded when they are loaded) */
+    constantsSet_->Set(symbol, std::make_shared<ConstantValue>(std::move(value)));
 }
 
-void Computer::ClearTempConsts()
+Variable Computer::CallNativeFunction(const FunctionDesc& func, Variable* args, std::size_t numArgs)
 {
-    while (!tempConsts_.empty())
-        PopTempConst();
+    /* Pass arguments as values (rationals stay exact) */
+    for (std::size_t i = 0; i < numArgs; ++i)
+    {
+        if (!args[i].IsScalar())
+            Error("function '" + func.name + "' requires arguments of a scalar type");
+    }
+
+    return func.impl(args, numArgs);
 }
 
 
+
 } // /namespace HTLib
 
 
@@ -12,48 +12,87 @@
 #include "precpkg/iprecision.h"
 #include "precpkg/fprecision.h"
 #include "Variable.h"
+#include "ByteCode.h"
 
 #include <Abacus/Abacus.h>
-#include <stack>
+#include <map>
 #include <string>
+#include <vector>
 
 
 namespace Ac
 {
 
 
-class Computer : private Visitor
+class Computer
 {
     
     public:
         
         std::string ComputeExpr(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log = nullptr);
+        bool ComputeExpr(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, const OutputCallback& output, Log* log = nullptr);
+
+        ExactRealPtr ComputeExactReal(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log = nullptr);
+        std::string RefineExactReal(const ExactRealPtr& real, const ComputeMode& mode, Log* log = nullptr);
 
     private:
         
+        /**
+        Runtime state of a fold expression. The index variable is counted with machine integers when its range fits,
+        and its value is only created when the loop expression refers to it.
+        */
+        struct FoldState
+        {
+            bool            isMachineInt    = false;
+            long long       index           = 0;
+            long long       last            = 0;
+            int_precision   bigIndex;
+            int_precision   bigLast;
+            bool            hasValue        = false;
+            Variable        value;  // value of the index variable (if 'hasValue' is true).
+        };
+
+        bool ComputeValue(const std::string& expr, const ComputeMode& mode, ConstantsSet& constantsSet, Log* log);
+
         void Error(const std::string& msg);
 
-        void VisitUnaryExpr     ( UnaryExpr*    ast, void* args ) override;
-        void VisitBinaryExpr    ( BinaryExpr*   ast, void* args ) override;
-        void VisitLiteralExpr   ( LiteralExpr*  ast, void* args ) override;
-        void VisitIdentExpr     ( IdentExpr*    ast, void* args ) override;
-        void VisitFuncExpr      ( FuncExpr*     ast, void* args ) override;
-        void VisitFoldExpr      ( FoldExpr*     ast, void* args ) override;
-        void VisitVectorExpr    ( VectorExpr*   ast, void* args ) override;
-        void VisitDefExpr       ( DefExpr*      ast, void* args ) override;
+        // Computes the AST in the fixed-size type for the requested digits, and returns false if the result could not be certified.
+        bool ComputeFastExpr(const ExprPtr& ast);
+
+        template <typename T>
+        bool ComputeFastExprWith(const ExprPtr& ast, unsigned int digits);
+
+        // Executes the bytecode and stores the result in 'result_'.
+        void Execute(const ByteCode& byteCode);
+
+        // Runs the instructions in [begin, end), whose jumps stay inside of this range.
+        void Run(const ByteCode& byteCode, std::size_t begin, std::size_t end);
+
+        Variable CallFunction(const FunctionDesc& func, Variable* args, std::size_t numArgs);
+        Variable CallNativeFunction(const FunctionDesc& func, Variable* args, std::size_t numArgs);
+
+        Variable ConstValue(Symbol symbol);
+        Variable VectorValue(Variable* components, std::size_t n);
+
+        // Starts the fold and returns true if the loop expression must be computed.
+        bool BeginFold(const FoldInfo& fold, FoldState& state, Variable& result);
 
-        void Push(const Variable& value);
-        Variable Pop();
-        Variable& Top();
+        /*
+        Computes the started fold in chunks on the task pool, each in its own evaluator context,
+        and reduces the partial results with a balanced tree (independent of the number of threads).
+        */
+        Variable ComputeFoldChunks(const ByteCode& byteCode, std::uint32_t foldIndex);
+        Variable ComputeFoldChunk(const ByteCode& byteCode, std::uint32_t foldIndex, long long first, long long last);
 
-        void StoreConst(const std::string& ident, std::string value);
+        // Advances the index variable, and returns true if it is still inside the range.
+        bool NextFoldIndex(FoldState& state);
+        const Variable& FoldIndexValue(FoldState& state);
 
-        void PushTempConst(const std::string& ident);
-        void PopTempConst();
-        void ClearTempConsts();
+        void StoreConst(Symbol symbol, Variable value);
 
-        std::stack<Variable>    values_;
-        std::stack<std::string> tempConsts_;
+        Variable                result_;
+        std::vector<Variable>   registers_;
+        std::vector<FoldState>  folds_;
 
         ComputeMode             mode_;
         ConstantsSet*           constantsSet_;
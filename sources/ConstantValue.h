@@ -0,0 +1,104 @@
+/*
+ * ConstantValue.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_CONSTANT_VALUE_H__
+#define __AC_CONSTANT_VALUE_H__
+
+
+#include "Variable.h"
+
+#include <Abacus/ConstantsSet.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace Ac
+{
+
+
+//! Immutable value of a constant, which keeps the precision of its definition (and rationals exactly).
+class ConstantValue
+{
+
+    public:
+
+        ConstantValue(Variable value);
+
+        const Variable& Get() const
+        {
+            return value_;
+        }
+
+        /**
+        Returns the literal with all digits of the value (e.g. "1.5E20"), which is written on the first call (thread-safe).
+        Rationals are written with the working precision of their definition.
+        */
+        const std::string& Literal() const;
+
+        /**
+        Returns the value converted with 'convert' into the type 'T', which is only called until it succeeds once for each type (thread-safe).
+        The fast computers keep their hardware values of the constant here, so they convert its digits only once.
+        */
+        template <typename T, typename Convert>
+        const T& Converted(const Convert& convert) const
+        {
+            const auto index = ConversionIndex<T>();
+
+            std::lock_guard<std::mutex> guard(conversionsMutex_);
+
+            if (index >= conversions_.size())
+                conversions_.resize(index + 1);
+
+            auto& slot = conversions_[index];
+            if (!slot)
+                slot = std::make_shared<T>(convert(value_));
+
+            return *static_cast<const T*>(slot.get());
+        }
+
+    private:
+
+        // Returns the next unused index into the conversions.
+        static std::size_t NextConversionIndex();
+
+        // Returns the index into the conversions for the type 'T'.
+        template <typename T>
+        static std::size_t ConversionIndex()
+        {
+            static const std::size_t index = NextConversionIndex();
+            return index;
+        }
+
+        Variable                                            value_;
+        unsigned int                                        precision_;
+
+        mutable std::once_flag                              literalFlag_;
+        mutable std::string                                 literal_;
+
+        mutable std::mutex                                  conversionsMutex_;
+        mutable std::vector<std::shared_ptr<const void>>    conversions_;
+
+};
+
+//! Returns the value of the constant with the working precision of the current thread.
+Variable LoadConst(const ConstantValue& value);
+
+//! Returns true if the value is the standard constant "pi" or "e" with this identifier (i.e. not a redefinition).
+bool IsStdConst(const std::string& ident, const ConstantValue& value);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,324 @@
+/*
+ * ConstantsSet.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Abacus/ConstantsSet.h>
+
+#include "ConstantValue.h"
+#include "Beautifier.h"
+#include "PrecisionUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+
+
+namespace Ac
+{
+
+
+struct StdConstant
+{
+    const char* ident;
+    const char* literal;
+};
+
+static const StdConstant stdConstants[] =
+{
+    { "pi", "3.141592653589793238462643383279502884197169399375105820974944" },
+    { "e",  "2.718281828459045235360287471352662497757247093699959574966967" },
+};
+
+// Parses the literal with enough precision to keep all of its digits.
+static Variable ParseLiteral(const std::string& literal)
+{
+    const auto digits = static_cast<unsigned int>(std::count_if(
+        literal.begin(), literal.end(),
+        [](char chr) { return std::isdigit(static_cast<unsigned char>(chr)) != 0; }
+    ));
+
+    ScopedPrecision scope(std::max(float_precision_ctrl.precision(), digits));
+    return Variable(literal);
+}
+
+// Returns the values of the standard constants, which are parsed only once and shared by all sets.
+static const std::vector<std::pair<Symbol, ConstantsSet::ValuePtr>>& StdValues()
+{
+    static const auto values = []()
+    {
+        std::vector<std::pair<Symbol, ConstantsSet::ValuePtr>> v;
+        for (const auto& c : stdConstants)
+            v.emplace_back(InternSymbol(c.ident), std::make_shared<ConstantValue>(ParseLiteral(c.literal)));
+        return v;
+    }();
+    return values;
+}
+
+// Returns true if the value contains floats with another precision.
+static bool NeedsRounding(const Variable& x, unsigned int prec)
+{
+    auto AnyNeedsRounding = [prec](const std::vector<Variable>& v)
+    {
+        return std::any_of(v.begin(), v.end(), [prec](const Variable& c) { return NeedsRounding(c, prec); });
+    };
+
+    if (x.IsVector())
+        return AnyNeedsRounding(x.GetVector());
+    if (x.IsMatrix())
+        return AnyNeedsRounding(x.GetMatrix().elements);
+    if (x.IsComplex())
+        return (x.GetComplex().real().precision() != prec || x.GetComplex().imag().precision() != prec);
+    if (x.IsFloat())
+        return (x.GetFloat().precision() != prec);
+
+    return false;
+}
+
+static void Round(Variable& x, unsigned int prec)
+{
+    if (x.IsVector())
+    {
+        for (auto& c : x.GetVector())
+            Round(c, prec);
+    }
+    else if (x.IsMatrix())
+    {
+        auto m = x.GetMatrix();
+        for (auto& c : m.elements)
+            Round(c, prec);
+        x = Variable(std::move(m));
+    }
+    else if (x.IsComplex())
+        x = Variable(complex_float(Extended(x.GetComplex().real(), prec), Extended(x.GetComplex().imag(), prec)));
+    else if (x.IsFloat())
+        x = Variable(Extended(x.GetFloat(), prec));
+}
+
+static std::size_t Hash(Symbol symbol)
+{
+    /* Fibonacci hashing spreads consecutive symbols over the table */
+    return static_cast<std::size_t>(static_cast<std::uint32_t>(symbol * 2654435769u));
+}
+
+
+/*
+ * ConstantValue class
+ */
+
+ConstantValue::ConstantValue(Variable value) :
+    value_      ( std::move(value)                  ),
+    precision_  ( float_precision_ctrl.precision()  )
+{
+}
+
+const std::string& ConstantValue::Literal() const
+{
+    std::call_once(
+        literalFlag_,
+        [this]()
+        {
+            /* Write scientific notation as literal (e.g. "1.5E20"), so the value can be parsed again */
+            NumberFormat fmt;
+            fmt.expPrefix = "E";
+
+            auto x = value_;
+            {
+                ScopedPrecision scope(precision_);
+                x.ResolveRational();
+            }
+
+            FormatValue(literal_, x, fmt);
+        }
+    );
+    return literal_;
+}
+
+std::size_t ConstantValue::NextConversionIndex()
+{
+    static std::atomic<std::size_t> nextIndex(0);
+    return nextIndex++;
+}
+
+Variable LoadConst(const ConstantValue& value)
+{
+    /* Return a copy (which shares its payload), unless it must be rounded */
+    auto x = value.Get();
+
+    const auto prec = float_precision_ctrl.precision();
+    if (NeedsRounding(x, prec))
+        Round(x, prec);
+
+    return x;
+}
+
+bool IsStdConst(const std::string& ident, const ConstantValue& value)
+{
+    const auto& values = StdValues();
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (values[i].second.get() == &value)
+            return (ident == stdConstants[i].ident);
+    }
+
+    return false;
+}
+
+
+/*
+ * ConstantsSet class
+ */
+
+AC_EXPORT ConstantsSet::ConstantsSet()
+{
+    ResetStd();
+}
+
+AC_EXPORT void ConstantsSet::ResetStd()
+{
+    for (const auto& c : StdValues())
+        Set(c.first, c.second);
+}
+
+AC_EXPORT void ConstantsSet::Clear()
+{
+    slots_.clear();
+    size_ = 0;
+}
+
+AC_EXPORT bool ConstantsSet::Set(const std::string& ident, const std::string& literal)
+{
+    if (!IsIdentifier(ident))
+        return false;
+
+    try
+    {
+        Set(InternSymbol(ident), std::make_shared<ConstantValue>(ParseLiteral(literal)));
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+AC_EXPORT bool ConstantsSet::Remove(const std::string& ident)
+{
+    /* Identifiers which were never interned cannot be defined */
+    Symbol symbol = 0;
+    return (FindSymbol(ident, symbol) && Remove(symbol));
+}
+
+AC_EXPORT bool ConstantsSet::Contains(const std::string& ident) const
+{
+    Symbol symbol = 0;
+    return (FindSymbol(ident, symbol) && Contains(symbol));
+}
+
+AC_EXPORT std::vector<std::pair<std::string, std::string>> ConstantsSet::List() const
+{
+    std::vector<std::pair<std::string, std::string>> list;
+    list.reserve(size_);
+
+    for (const auto& slot : slots_)
+    {
+        if (slot.value)
+            list.emplace_back(SymbolName(slot.symbol), slot.value->Literal());
+    }
+
+    std::sort(list.begin(), list.end());
+
+    return list;
+}
+
+AC_EXPORT const ConstantValue* ConstantsSet::Find(Symbol symbol) const
+{
+    if (slots_.empty())
+        return nullptr;
+    return slots_[Probe(symbol)].value.get();
+}
+
+AC_EXPORT void ConstantsSet::Set(Symbol symbol, ValuePtr value)
+{
+    /* Keep the load factor at most 1/2 */
+    if ((size_ + 1) * 2 > slots_.size())
+        Rehash(std::max<std::size_t>(16, slots_.size() * 2));
+
+    auto& slot = slots_[Probe(symbol)];
+
+    if (!slot.value)
+    {
+        slot.symbol = symbol;
+        ++size_;
+    }
+
+    slot.value = std::move(value);
+}
+
+AC_EXPORT bool ConstantsSet::Remove(Symbol symbol)
+{
+    if (slots_.empty())
+        return false;
+
+    auto i = Probe(symbol);
+    if (!slots_[i].value)
+        return false;
+
+    slots_[i].value.reset();
+    --size_;
+
+    /* Move the following entries of the probe sequence backwards, so lookups need no tombstones */
+    const auto mask = slots_.size() - 1;
+
+    for (auto j = (i + 1) & mask; slots_[j].value; j = (j + 1) & mask)
+    {
+        /* Keep the entry if its home slot lies cyclically in (i, j] */
+        const auto k = Hash(slots_[j].symbol) & mask;
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+
+        slots_[i] = std::move(slots_[j]);
+        i = j;
+    }
+
+    return true;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+std::size_t ConstantsSet::Probe(Symbol symbol) const
+{
+    const auto mask = slots_.size() - 1;
+
+    auto i = Hash(symbol) & mask;
+    while (slots_[i].value && slots_[i].symbol != symbol)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+void ConstantsSet::Rehash(std::size_t capacity)
+{
+    auto slots = std::move(slots_);
+    slots_ = std::vector<Slot>(capacity);
+
+    for (auto& slot : slots)
+    {
+        if (slot.value)
+            slots_[Probe(slot.symbol)] = std::move(slot);
+    }
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
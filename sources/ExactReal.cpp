@@ -0,0 +1,1079 @@
+/*
+ * ExactReal.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "ExactReal.h"
+#include "Variable.h"
+#include "ConstantValue.h"
+#include "PrecisionUtils.h"
+
+#include <Abacus/Visitor.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <stack>
+#include <vector>
+
+
+namespace Ac
+{
+
+
+static void Error(const std::string& msg)
+{
+    throw std::runtime_error("math error: " + msg);
+}
+
+
+/* --- Magnitudes ---
+Approximations are plain float_precision values with enough digits for their absolute error bound.
+All bounds below are powers of ten, so they only need the decimal exponents of the approximations.
+*/
+
+// Exponent of an unknown or zero magnitude.
+static const int noExp = INT_MIN / 4;
+
+// Number of digits up to which a divisor or logarithm argument is refined before it is considered to be zero.
+static const int maxRefinement = 250;
+
+// Number of digits beyond twice the result precision up to which a result is refined before it is printed as zero.
+static const int zeroRefinement = 32;
+
+// Returns an exponent 'm' with |x| < 10^m.
+static int UpperExp(const float_precision& x)
+{
+    return (IsZero(x) ? noExp : x.exponent() + 1);
+}
+
+// Returns an exponent 'm' with |y| <= 10^m for every y with |y - x| <= 10^-k.
+static int UpperExp(const float_precision& x, int k)
+{
+    return std::max(UpperExp(x), -k) + 1;
+}
+
+// Returns an exponent 'm' with |y| >= 10^m for every y with |y - x| <= 10^-k, or 'noExp' if y can be zero.
+static int LowerExp(const float_precision& x, int k)
+{
+    if (IsZero(x) || x.exponent() <= -k)
+        return noExp;
+    return x.exponent() - 1;
+}
+
+// Returns the number of digits to round a value with |x| < 10^m to an absolute error of at most 10^-k/200.
+static unsigned int Digits(int m, int k)
+{
+    return static_cast<unsigned int>(std::max(m + k + 2, 2));
+}
+
+static int CeilHalf(int x)
+{
+    return (x >= 0 ? (x + 1) / 2 : x / 2);
+}
+
+static float_precision Zero()
+{
+    return float_precision(0, 2, ROUND_NEAR);
+}
+
+// Returns 2*10^e.
+static float_precision TwoPowerOfTen(int e)
+{
+    float_precision x(2, 2, ROUND_NEAR);
+    x.exponent(e);
+    return x;
+}
+
+static float_precision Rounded(const float_precision& x, unsigned int digits)
+{
+    float_precision y(x);
+    y.mode(ROUND_NEAR);
+    y.precision(digits);
+    return y;
+}
+
+// Stores 'src' in 'dst' with the precision of 'src' (assignments round to the precision of the left hand side).
+static void Assign(float_precision& dst, float_precision&& src)
+{
+    dst.precision(std::max(dst.precision(), src.precision()));
+    dst.mode(src.mode());
+    dst = std::move(src);
+}
+
+// Returns an exponent 'm' with |x| >= 10^m for the value of the node, refining it until it is bounded away from zero.
+static int LowerExpOf(RealNode& node, int kMin, const char* errorMsg)
+{
+    for (int k = kMin;; k = std::max(16, 2*k))
+    {
+        auto m = LowerExp(node.Approx(k), k);
+        if (m != noExp)
+            return m;
+        if (k > maxRefinement)
+            Error(errorMsg);
+    }
+}
+
+
+/*
+ * RealNode class
+ */
+
+const float_precision& RealNode::Approx(int k)
+{
+    if (!hasApprox_ || k > approxK_)
+    {
+        /* Refine geometrically, so that repeated requests for a few more digits are amortized */
+        if (hasApprox_ && approxK_ > 0)
+            k = std::max(k, approxK_ + approxK_/2);
+
+        Assign(approx_, Compute(k));
+        approxK_ = (IsExact() ? INT_MAX : k);
+        hasApprox_ = true;
+    }
+    return approx_;
+}
+
+
+/* --- Nodes --- */
+
+using RealNodeRef = ExactRealPtr;
+
+// Node of an exact integer, rational, or decimal value.
+class ExactNode : public RealNode
+{
+
+    public:
+
+        ExactNode(Variable&& value) :
+            value_( std::move(value) )
+        {
+        }
+
+        bool IsExact() const override
+        {
+            return !value_.IsRational();
+        }
+
+        const Variable& Value() const
+        {
+            return value_;
+        }
+
+    protected:
+
+        float_precision Compute(int k) override
+        {
+            if (value_.IsFloat())
+                return value_.GetFloat();
+
+            const auto& num = value_.GetInt();
+            if (!value_.IsRational())
+                return float_precision(num, static_cast<unsigned int>(std::max(num.size(), 2)), ROUND_NEAR);
+
+            /* Divide with relative errors of numerator, denominator, and quotient below 10^-(k+2) */
+            const auto& den = value_.GetDenom();
+            const auto digits = Digits(num.size() - den.size() + 1, k) + 2;
+
+            float_precision q(num, digits, ROUND_NEAR);
+            q /= float_precision(den, digits, ROUND_NEAR);
+            return q;
+        }
+
+    private:
+
+        Variable value_;
+
+};
+
+class PiNode : public RealNode
+{
+
+    protected:
+
+        float_precision Compute(int k) override
+        {
+            return _float_table(_PI, Digits(1, k + 2));
+        }
+
+};
+
+class NegNode : public RealNode
+{
+
+    public:
+
+        NegNode(const RealNodeRef& a) :
+            a_( a )
+        {
+        }
+
+    protected:
+
+        float_precision Compute(int k) override
+        {
+            return -a_->Approx(k);
+        }
+
+    private:
+
+        RealNodeRef a_;
+
+};
+
+class AddNode : public RealNode
+{
+
+    public:
+
+        AddNode(const RealNodeRef& a, const RealNodeRef& b, bool subtract) :
+            a_          ( a        ),
+            b_          ( b        ),
+            subtract_   ( subtract )
+        {
+        }
+
+    protected:
+
+        float_precision Compute(int k) override
+        {
+            /* Both operands with an error of 10^-(k+2), and the rounded sum with another 10^-(k+2) */
+            const auto& x = a_->Approx(k + 2);
+            const auto& y = b_->Approx(k + 2);
+
+            auto s = Rounded(x, Digits(std::max(UpperExp(x), UpperExp(y)) + 1, k));
+            if (subtract_)
+                s -= y;
+            else
+                s += y;
+
+            return s;
+        }
+
+    private:
+
+        RealNodeRef a_, b_;
+        bool        subtract_;
+
+};
+
+class MulNode : public RealNode
+{
+
+    public:
+
+        MulNode(const RealNodeRef& a, const RealNodeRef& b) :
+            a_( a ),
+            b_( b )
+        {
+        }
+
+    protected:
+
+        float_precision Compute(int k) override
+        {
+            /* Bound the magnitudes with coarse approximations first */
+            const int mx = UpperExp(a_->Approx(0), 0);
+            const int my = UpperExp(b_->Approx(0), 0);
+
+            if (mx + my + k + 2 < 0)
+                return Zero();
+
+            /* |x'y' - xy| <= |y'|*|x' - x| + |x|*|y' - y| */
+            const auto& x = a_->Approx(k + my + 2);
+            const auto& y = b_->Approx(k + mx + 2);
+
+            auto p = Rounded(x, Digits(mx + my, k));
+            p *= y;
+
+            return p;
+        }
+
+    private:
+
+        RealNodeRef a_, b_;
+
+};
+
+class DivNode : public RealNode
+{
+
+    public:
+
+        DivNode(const RealNodeRef& a, const RealNodeRef& b) :
+            a_( a ),
+            b_( b )
+        {
+        }
+
+    protected:
+
+        float_precision Compute(int k) override
+        {
+            /* Bound the divisor away from zero, and the dividend with a coarse approximation */
+            const int ly = LowerExpOf(*b_, 0, "division by zero");
+            const int mx = UpperExp(a_->Approx(0), 0);
+
+            if (mx - ly + k + 2 < 0)
+                return Zero();
+
+            /* |x'/y' - x/y| <= |x' - x|/|y'| + |x|*|y' - y|/(|y|*|y'|) */
+            const auto& x = a_->Approx(k - ly + 2);
+            const auto& y = b_->Approx(std::max(k + mx - 2*ly + 2, -ly + 1));
+
+            auto q = Rounded(x, Digits(mx - ly, k));
+            q /= y;
+
+            return q;
+        }
+
+    private:
+
+        RealNodeRef a_, b_;
+
+};
+
+enum class RealFunc
+{
+    Sqrt,
+    Exp,
+    Log,
+    Sin,
+    Cos,
+    Atan,
+    Abs,
+};
+
+/*
+Node of an elementary function, whose error is the propagated error of the argument (bounded by the derivative)
+plus the rounding error of the float_precision function, which is kept below 10^-(k+2) with guard digits.
+*/
+class FuncNode : public RealNode
+{
+
+    public:
+
+        FuncNode(RealFunc func, const RealNodeRef& a) :
+            func_   ( func ),
+            a_      ( a    )
+        {
+        }
+
+    protected:
+
+        float_precision Compute(int k) override
+        {
+            switch (func_)
+            {
+                case RealFunc::Sqrt:
+                    return ComputeSqrt(k);
+                case RealFunc::Exp:
+                    return ComputeExp(k);
+                case RealFunc::Log:
+                    return ComputeLog(k);
+                case RealFunc::Sin:
+                    return sin(Arg(k + 2, Digits(1, k + 2)));
+                case RealFunc::Cos:
+                    return cos(Arg(k + 2, Digits(1, k + 2)));
+                case RealFunc::Atan:
+                    return atan(Arg(k + 2, Digits(1, k + 2)));
+                case RealFunc::Abs:
+                    return abs(a_->Approx(k));
+            }
+            return Zero();
+        }
+
+    private:
+
+        // Returns the argument with an absolute error of 10^-ka, rounded to at least 'digits' digits.
+        float_precision Arg(int ka, unsigned int digits)
+        {
+            const auto& x = a_->Approx(ka);
+            return Rounded(x, std::max(digits, Digits(UpperExp(x), ka)));
+        }
+
+        float_precision ComputeSqrt(int k)
+        {
+            const auto& x = a_->Approx(k + 2);
+            const int lx = LowerExp(x, k + 2);
+
+            if (lx == noExp)
+            {
+                /* |sqrt(x') - sqrt(x)| <= sqrt(|x' - x|) for tiny arguments */
+                auto y = Arg(2*k + 4, Digits(1, k + 2));
+                if (y.sign() < 0)
+                    y = Zero();
+                return sqrt(y);
+            }
+
+            if (x.sign() < 0)
+                Error("square root of negative value");
+
+            /* sqrt'(x) <= 10^(-lx/2)/2 */
+            const int mx = UpperExp(x, k + 2);
+            return sqrt(Arg(k + 2 + CeilHalf(-lx), Digits(CeilHalf(mx), k + 2)));
+        }
+
+        float_precision ComputeExp(int k)
+        {
+            /* exp(x) <= 10^e for all arguments within 0.1 of the coarse approximation */
+            const double x0 = static_cast<double>(a_->Approx(1));
+            if (x0 > 1.0e9)
+                Error("out of range");
+
+            const int e = static_cast<int>(std::floor((x0 + 0.1) * 0.43429448190325176)) + 1;
+            if (e + k + 2 < 0)
+                return Zero();
+
+            /* exp'(x) = exp(x) <= 10^e */
+            return exp(Arg(std::max(k + e + 2, 1), Digits(e, k + 2)));
+        }
+
+        float_precision ComputeLog(int k)
+        {
+            /* log'(x) = 1/x <= 10^-lx */
+            const int lx = LowerExpOf(*a_, 0, "logarithm of zero");
+            if (a_->Approx(1 - lx).sign() < 0)
+                Error("logarithm of negative value");
+
+            const int ka = k - lx + 2;
+            const int mx = UpperExp(a_->Approx(ka), ka);
+
+            /* |log(x)| <= 2.31*max(|mx|, |lx|) */
+            const double l = 2.31 * std::max(std::abs(mx), std::abs(lx)) + 1.0;
+            const int e = static_cast<int>(std::ceil(std::log10(l))) + 1;
+
+            return log(Arg(ka, Digits(e, k + 2)));
+        }
+
+        RealFunc    func_;
+        RealNodeRef a_;
+
+};
+
+
+/* --- Graph builder --- */
+
+class RealGraphBuilder : private Visitor
+{
+
+    public:
+
+        RealNodeRef Build(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet)
+        {
+            mode_           = mode;
+            constantsSet_   = &constantsSet;
+
+            Visit(ast);
+            return Pop();
+        }
+
+    private:
+
+        static const int maxFoldIterations = 100000;
+
+        /* --- Visitor --- */
+
+        void VisitUnaryExpr(UnaryExpr* ast, void*) override
+        {
+            Visit(ast->expr);
+            auto a = Pop();
+
+            using Op = UnaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Keep:
+                    Push(a);
+                    break;
+                case Op::Negate:
+                    Push(MakeNeg(a));
+                    break;
+                case Op::Factorial:
+                    Push(MakeExactIntOp(a, a, "!", [](Variable& x, Variable&) { x.Factorial(); }));
+                    break;
+                case Op::Norm:
+                    Push(MakeFunc(RealFunc::Abs, a));
+                    break;
+                default:
+                    Error("unknown unary operator");
+                    break;
+            }
+        }
+
+        void VisitBinaryExpr(BinaryExpr* ast, void*) override
+        {
+            Visit(ast->exprL);
+            auto a = Pop();
+
+            Visit(ast->exprR);
+            auto b = Pop();
+
+            using Op = BinaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Add:
+                    Push(MakeAdd(a, b, false));
+                    break;
+                case Op::Sub:
+                    Push(MakeAdd(a, b, true));
+                    break;
+                case Op::Mul:
+                    Push(MakeMul(a, b));
+                    break;
+                case Op::Div:
+                    Push(MakeDiv(a, b));
+                    break;
+                case Op::Pow:
+                    Push(MakePow(a, b));
+                    break;
+                case Op::IntDiv:
+                    Push(MakeExactIntOp(a, b, "div", [](Variable& x, Variable& y) { x.IntDiv(y); }));
+                    break;
+                case Op::Mod:
+                    Push(MakeExactIntOp(a, b, "mod", [](Variable& x, Variable& y) { x.Mod(y); }));
+                    break;
+                case Op::LShift:
+                    Push(MakeExactIntOp(a, b, "<<", [](Variable& x, Variable& y) { x.LShift(y); }));
+                    break;
+                case Op::RShift:
+                    Push(MakeExactIntOp(a, b, ">>", [](Variable& x, Variable& y) { x.RShift(y); }));
+                    break;
+                default:
+                    Error("unknown binary operator");
+                    break;
+            }
+        }
+
+        void VisitLiteralExpr(LiteralExpr* ast, void*) override
+        {
+            Push(MakeDecimal(ast->value));
+        }
+
+        void VisitIdentExpr(IdentExpr* ast, void*) override
+        {
+            /* Fold indices hide all constants */
+            auto idx = indices_.find(ast->value);
+            if (idx != indices_.end())
+            {
+                Push(MakeExact(Variable(idx->second)));
+                return;
+            }
+
+            auto value = constantsSet_->Find(ast->symbol);
+            if (!value)
+            {
+                if (ast->value == "i")
+                    Error("complex numbers are not supported in exact-real mode");
+                Error("undefined constant '" + ast->value + "'");
+            }
+
+            if (value->Get().IsComplex())
+                Error("complex numbers are not supported in exact-real mode");
+            if (!value->Get().IsScalar())
+                Error("vectors are not supported in exact-real mode");
+
+            /* Standard constants are the exact numbers, not their stored digits */
+            if (IsStdConst(ast->value, *value))
+            {
+                if (ast->value == "pi")
+                    Push(Pi());
+                else
+                    Push(MakeFunc(RealFunc::Exp, MakeInt(1)));
+            }
+            else if (value->Get().IsRational())
+                Push(MakeExact(Variable(value->Get())));
+            else
+                Push(MakeDecimal(value->Literal()));
+        }
+
+        void VisitFuncExpr(FuncExpr* ast, void*) override
+        {
+            const auto& f = ast->name;
+
+            auto Arg = [&](std::size_t i) -> RealNodeRef
+            {
+                if (i >= ast->args.size())
+                    Error("too few arguments for function '" + f + "'");
+                Visit(ast->args[i]);
+                return Pop();
+            };
+
+            auto ArgCount = [&](std::size_t n)
+            {
+                if (ast->args.size() != n)
+                    Error("function '" + f + "' requires exactly " + std::to_string(n) + " argument(s)");
+            };
+
+            auto Deg2Rad = [&](const RealNodeRef& x) -> RealNodeRef
+            {
+                return (mode_.degree ? MakeMul(x, MakeDiv(Pi(), MakeInt(180))) : x);
+            };
+
+            auto Rad2Deg = [&](const RealNodeRef& x) -> RealNodeRef
+            {
+                return (mode_.degree ? MakeMul(x, MakeDiv(MakeInt(180), Pi())) : x);
+            };
+
+            if (f == "sqrt" || f == "exp" || f == "log" || f == "abs")
+            {
+                ArgCount(1);
+                auto func = (f == "sqrt" ? RealFunc::Sqrt : f == "exp" ? RealFunc::Exp : f == "log" ? RealFunc::Log : RealFunc::Abs);
+                Push(MakeFunc(func, Arg(0)));
+            }
+            else if (f == "log10")
+            {
+                ArgCount(1);
+                Push(MakeDiv(MakeFunc(RealFunc::Log, Arg(0)), Ln10()));
+            }
+            else if (f == "sin" || f == "cos")
+            {
+                ArgCount(1);
+                Push(MakeFunc(f == "sin" ? RealFunc::Sin : RealFunc::Cos, Deg2Rad(Arg(0))));
+            }
+            else if (f == "tan")
+            {
+                ArgCount(1);
+                auto x = Deg2Rad(Arg(0));
+                Push(MakeDiv(MakeFunc(RealFunc::Sin, x), MakeFunc(RealFunc::Cos, x)));
+            }
+            else if (f == "atan")
+            {
+                ArgCount(1);
+                Push(Rad2Deg(MakeFunc(RealFunc::Atan, Arg(0))));
+            }
+            else if (f == "asin" || f == "acos")
+            {
+                ArgCount(1);
+
+                /* asin(x) = 2*atan(x/(1 + sqrt(1 - x^2))), which has no singularity at |x| = 1 */
+                auto x = Arg(0);
+                auto root = MakeFunc(RealFunc::Sqrt, MakeAdd(MakeInt(1), MakeMul(x, x), true));
+                auto y = MakeMul(MakeInt(2), MakeFunc(RealFunc::Atan, MakeDiv(x, MakeAdd(MakeInt(1), root, false))));
+
+                /* acos(x) = pi/2 - asin(x) */
+                if (f == "acos")
+                    y = MakeAdd(MakeDiv(Pi(), MakeInt(2)), y, true);
+
+                Push(Rad2Deg(y));
+            }
+            else if (f == "sinh" || f == "cosh" || f == "tanh")
+            {
+                ArgCount(1);
+
+                auto x = Arg(0);
+                auto ep = MakeFunc(RealFunc::Exp, x);
+                auto en = MakeFunc(RealFunc::Exp, MakeNeg(x));
+
+                auto s = MakeAdd(ep, en, true);
+                auto c = MakeAdd(ep, en, false);
+
+                if (f == "sinh")
+                    Push(MakeDiv(s, MakeInt(2)));
+                else if (f == "cosh")
+                    Push(MakeDiv(c, MakeInt(2)));
+                else
+                    Push(MakeDiv(s, c));
+            }
+            else if (f == "asinh" || f == "acosh")
+            {
+                ArgCount(1);
+
+                /* log(x + sqrt(x^2 +- 1)) */
+                auto x = Arg(0);
+                auto root = MakeFunc(RealFunc::Sqrt, MakeAdd(MakeMul(x, x), MakeInt(1), f == "acosh"));
+                Push(MakeFunc(RealFunc::Log, MakeAdd(x, root, false)));
+            }
+            else if (f == "atanh")
+            {
+                ArgCount(1);
+
+                /* log((1 + x)/(1 - x))/2 */
+                auto x = Arg(0);
+                auto q = MakeDiv(MakeAdd(MakeInt(1), x, false), MakeAdd(MakeInt(1), x, true));
+                Push(MakeDiv(MakeFunc(RealFunc::Log, q), MakeInt(2)));
+            }
+            else if (f == "pow")
+            {
+                ArgCount(2);
+                auto x = Arg(0);
+                Push(MakePow(x, Arg(1)));
+            }
+            else
+                Error("function '" + f + "' is not supported in exact-real mode");
+        }
+
+        void VisitFoldExpr(FoldExpr* ast, void*) override
+        {
+            /* Index range must be exact integers */
+            Visit(ast->initExpr);
+            auto idx = ExactInt(Pop(), "fold function '" + ast->func + "' can only have discrete iterations");
+
+            Visit(ast->iterExpr);
+            auto idxEnd = ExactInt(Pop(), "fold function '" + ast->func + "' can only have discrete iterations");
+
+            if (indices_.find(ast->index) != indices_.end() || constantsSet_->Contains(ast->indexSymbol))
+                Error("index variable '" + ast->index + "' already defined in this scope");
+
+            const bool isSum = (ast->func == "sum");
+
+            /* Fold exact terms immediately, and collect all others for a balanced tree of nodes */
+            Variable exact(int_precision(isSum ? 0 : 1));
+            std::vector<RealNodeRef> terms;
+
+            for (int n = 0; idx <= idxEnd; ++idx, ++n)
+            {
+                if (n >= maxFoldIterations)
+                    Error("too many fold iterations in exact-real mode");
+
+                indices_[ast->index] = idx;
+
+                Visit(ast->loopExpr);
+                auto term = Pop();
+
+                if (auto value = ExactValue(term))
+                {
+                    auto x = *value;
+                    auto y = exact;
+
+                    if (isSum)
+                        y.Add(x);
+                    else
+                        y.Mul(x);
+
+                    if (!y.IsFloat())
+                    {
+                        exact = std::move(y);
+                        continue;
+                    }
+
+                    /* Accumulated value has grown too large for rational arithmetic */
+                    terms.push_back(MakeExact(std::move(exact)));
+                    exact = Variable(int_precision(isSum ? 0 : 1));
+                }
+
+                terms.push_back(term);
+            }
+
+            indices_.erase(ast->index);
+
+            terms.push_back(MakeExact(std::move(exact)));
+
+            /* Combine terms pairwise to keep the graph shallow */
+            while (terms.size() > 1)
+            {
+                std::vector<RealNodeRef> next;
+                for (std::size_t i = 0; i + 1 < terms.size(); i += 2)
+                    next.push_back(isSum ? MakeAdd(terms[i], terms[i + 1], false) : MakeMul(terms[i], terms[i + 1]));
+                if (terms.size() % 2 != 0)
+                    next.push_back(terms.back());
+                terms = std::move(next);
+            }
+
+            Push(terms.front());
+        }
+
+        void VisitVectorExpr(VectorExpr*, void*) override
+        {
+            Error("vectors are not supported in exact-real mode");
+        }
+
+        void VisitDefExpr(DefExpr*, void*) override
+        {
+            Error("definitions are not supported in exact-real mode");
+        }
+
+        /* --- Node construction with exact folding --- */
+
+        static const Variable* ExactValue(const RealNodeRef& node)
+        {
+            /* Only integers and rationals, since exact decimals are too large for rational arithmetic */
+            if (auto exact = dynamic_cast<const ExactNode*>(node.get()))
+            {
+                if (!exact->Value().IsFloat())
+                    return &(exact->Value());
+            }
+            return nullptr;
+        }
+
+        static int_precision ExactInt(const RealNodeRef& node, const std::string& errorMsg)
+        {
+            auto value = ExactValue(node);
+            if (!value || value->IsRational())
+                Error(errorMsg);
+            return value->GetInt();
+        }
+
+        static RealNodeRef MakeExact(Variable&& value)
+        {
+            return std::make_shared<ExactNode>(std::move(value));
+        }
+
+        static RealNodeRef MakeInt(int value)
+        {
+            return MakeExact(Variable(int_precision(value)));
+        }
+
+        // Returns an exact node for the decimal number (e.g. "-1.25E-3").
+        static RealNodeRef MakeDecimal(const std::string& s)
+        {
+            /* Split into digits and decimal exponent */
+            auto expPos = s.find_first_of("eE");
+            int exp = (expPos != std::string::npos ? std::stoi(s.substr(expPos + 1)) : 0);
+
+            std::string digits;
+            bool isNeg = false;
+
+            for (std::size_t i = 0, n = std::min(expPos, s.size()); i < n; ++i)
+            {
+                const char c = s[i];
+                if (c == '-')
+                    isNeg = true;
+                else if (c == '.')
+                    exp -= static_cast<int>(n - i - 1);
+                else if (c >= '0' && c <= '9')
+                    digits += c;
+            }
+
+            auto start = digits.find_first_not_of('0');
+            digits = (isNeg ? "-" : "+") + (start != std::string::npos ? digits.substr(start) : "0");
+
+            Variable value((int_precision(digits.c_str())));
+            if (exp > 0)
+            {
+                Variable scale(ipow(int_precision(10), int_precision(exp)));
+                value.Mul(scale);
+            }
+            else if (exp < 0)
+            {
+                Variable scale(ipow(int_precision(10), int_precision(-exp)));
+                value.Div(scale);
+
+                /* Keep decimals which are too large for rational arithmetic with all of their digits */
+                if (value.IsFloat())
+                    value = Variable(float_precision(s.c_str(), static_cast<unsigned int>(digits.size()) + 1, ROUND_NEAR));
+            }
+
+            return MakeExact(std::move(value));
+        }
+
+        template <typename Op>
+        static RealNodeRef MakeExactOp(const RealNodeRef& a, const RealNodeRef& b, const Op& op)
+        {
+            auto x = ExactValue(a);
+            auto y = ExactValue(b);
+
+            if (x && y)
+            {
+                auto vx = *x;
+                auto vy = *y;
+                op(vx, vy);
+
+                /* Only keep integers and rationals, but not values that were rounded to floats or became complex */
+                if (!vx.IsFloat() && !vx.IsComplex())
+                    return MakeExact(std::move(vx));
+            }
+
+            return nullptr;
+        }
+
+        template <typename Op>
+        static RealNodeRef MakeExactIntOp(const RealNodeRef& a, const RealNodeRef& b, const std::string& op, const Op& func)
+        {
+            auto x = ExactValue(a);
+            auto y = ExactValue(b);
+
+            if (!x || !y || x->IsRational() || y->IsRational())
+                Error("operator '" + op + "' requires exact integers in exact-real mode");
+
+            auto vx = *x;
+            auto vy = *y;
+            func(vx, vy);
+
+            return MakeExact(std::move(vx));
+        }
+
+        static RealNodeRef MakeNeg(const RealNodeRef& a)
+        {
+            if (auto x = ExactValue(a))
+            {
+                auto v = *x;
+                v.Negate();
+                return MakeExact(std::move(v));
+            }
+            return std::make_shared<NegNode>(a);
+        }
+
+        static RealNodeRef MakeAdd(const RealNodeRef& a, const RealNodeRef& b, bool subtract)
+        {
+            if (auto c = MakeExactOp(a, b, [subtract](Variable& x, Variable& y) { if (subtract) x.Sub(y); else x.Add(y); }))
+                return c;
+            return std::make_shared<AddNode>(a, b, subtract);
+        }
+
+        static RealNodeRef MakeMul(const RealNodeRef& a, const RealNodeRef& b)
+        {
+            if (auto c = MakeExactOp(a, b, [](Variable& x, Variable& y) { x.Mul(y); }))
+                return c;
+            return std::make_shared<MulNode>(a, b);
+        }
+
+        static RealNodeRef MakeDiv(const RealNodeRef& a, const RealNodeRef& b)
+        {
+            if (auto c = MakeExactOp(a, b, [](Variable& x, Variable& y) { x.Div(y); }))
+                return c;
+            return std::make_shared<DivNode>(a, b);
+        }
+
+        static RealNodeRef MakeFunc(RealFunc func, const RealNodeRef& a)
+        {
+            return std::make_shared<FuncNode>(func, a);
+        }
+
+        static RealNodeRef MakePow(const RealNodeRef& a, const RealNodeRef& b)
+        {
+            if (auto c = MakeExactOp(a, b, [](Variable& x, Variable& y) { x.Pow(y); }))
+                return c;
+
+            auto y = ExactValue(b);
+            if (y && !y->IsRational())
+            {
+                /* Integral exponents by squaring */
+                auto n = abs(y->GetInt());
+                if (n.size() > 10)
+                    Error("exponent too large in exact-real mode");
+
+                auto e = static_cast<unsigned long>(n);
+                RealNodeRef result = MakeInt(1), base = a;
+
+                for (; e > 0; e >>= 1)
+                {
+                    if (e & 1)
+                        result = MakeMul(result, base);
+                    if (e > 1)
+                        base = MakeMul(base, base);
+                }
+
+                return (y->GetInt().sign() < 0 ? MakeDiv(MakeInt(1), result) : result);
+            }
+
+            /* x^y = exp(y*log(x)) */
+            return MakeFunc(RealFunc::Exp, MakeMul(b, MakeFunc(RealFunc::Log, a)));
+        }
+
+        RealNodeRef Pi()
+        {
+            if (!pi_)
+                pi_ = std::make_shared<PiNode>();
+            return pi_;
+        }
+
+        RealNodeRef Ln10()
+        {
+            if (!ln10_)
+                ln10_ = MakeFunc(RealFunc::Log, MakeInt(10));
+            return ln10_;
+        }
+
+        /* --- Node stack --- */
+
+        void Push(const RealNodeRef& node)
+        {
+            nodes_.push(node);
+        }
+
+        RealNodeRef Pop()
+        {
+            if (nodes_.empty())
+                Error("stack underflow");
+            auto node = nodes_.top();
+            nodes_.pop();
+            return node;
+        }
+
+        std::stack<RealNodeRef>                 nodes_;
+        std::map<std::string, int_precision>    indices_;
+        RealNodeRef                             pi_;
+        RealNodeRef                             ln10_;
+
+        ComputeMode                             mode_;
+        const ConstantsSet*                     constantsSet_ = nullptr;
+
+};
+
+
+/*
+ * Global functions
+ */
+
+ExactRealPtr BuildRealGraph(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet)
+{
+    RealGraphBuilder builder;
+    return builder.Build(ast, mode, constantsSet);
+}
+
+float_precision RoundRealGraph(RealNode& node)
+{
+    const auto digits = float_precision_ctrl.precision();
+    const auto mode = float_precision_ctrl.mode();
+
+    float_precision y(0, digits, mode);
+
+    if (node.IsExact())
+    {
+        y = node.Approx(0);
+        return y;
+    }
+
+    /* Find the magnitude of the value with growing absolute precision */
+    int k = 0, lx = noExp;
+
+    while (lx == noExp)
+    {
+        const auto& x = node.Approx(k);
+        lx = LowerExp(x, k);
+
+        /* Value is indistinguishable from zero */
+        if (lx == noExp && k > zeroRefinement + 2*static_cast<int>(digits))
+            return y;
+
+        k = std::max(16, 2*k);
+    }
+
+    /*
+    Refine until both ends of the error interval are rounded to the same number,
+    and fall back to the approximation itself for exact ties
+    */
+    k = static_cast<int>(digits) - lx + 2;
+
+    for (int i = 0; i < 8; ++i, k += k/4 + 8)
+    {
+        const auto& x = node.Approx(k);
+        const auto guard = Digits(UpperExp(x, k), k);
+
+        float_precision lo(0, guard, mode), hi(0, guard, mode);
+        lo = x;
+        hi = x;
+        lo -= TwoPowerOfTen(-k);
+        hi += TwoPowerOfTen(-k);
+
+        lo.precision(digits);
+        hi.precision(digits);
+
+        if (lo == hi)
+            return lo;
+    }
+
+    y = node.Approx(k);
+    return y;
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
@@ -0,0 +1,70 @@
+/*
+ * ExactReal.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_EXACT_REAL_H__
+#define __AC_EXACT_REAL_H__
+
+
+#include "precpkg/iprecision.h"
+#include "precpkg/fprecision.h"
+
+#include <Abacus/Abacus.h>
+
+
+namespace Ac
+{
+
+
+/*
+Node of the lazily refined computation graph for the exact-real mode.
+Each node approximates its exact real value to any absolute precision on demand, and keeps its best approximation,
+so refining a result only recomputes the nodes whose previous approximations are not precise enough.
+*/
+class RealNode
+{
+
+    public:
+
+        virtual ~RealNode() = default;
+
+        //! Returns an approximation with an absolute error of at most 10^-k.
+        const float_precision& Approx(int k);
+
+        //! Returns true if the approximations of this node are always exact (see Approx).
+        virtual bool IsExact() const
+        {
+            return false;
+        }
+
+    protected:
+
+        //! Computes a new approximation with an absolute error of at most 10^-k.
+        virtual float_precision Compute(int k) = 0;
+
+    private:
+
+        float_precision approx_;
+        int             approxK_    = 0;
+        bool            hasApprox_  = false;
+
+};
+
+//! Builds the computation graph of the expression in the current float context (throws on unsupported expressions).
+ExactRealPtr BuildRealGraph(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet);
+
+//! Returns the value of the graph rounded to the number of digits and the rounding mode of the current float context.
+float_precision RoundRealGraph(RealNode& node);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
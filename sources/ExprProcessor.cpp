@@ -7,6 +7,8 @@
 
 #include "ExprProcessor.h"
 
+#include <stdexcept>
+
 
 namespace Ac
 {
@@ -0,0 +1,1007 @@
+/*
+ * FastComputer.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_FAST_COMPUTER_H__
+#define __AC_FAST_COMPUTER_H__
+
+
+#include "precpkg/iprecision.h"
+#include "precpkg/fprecision.h"
+#include "Variable.h"
+#include "FastMath.h"
+#include "ConstantValue.h"
+#include "ByteCode.h"
+
+#include <Abacus/Abacus.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stack>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace Ac
+{
+
+
+/*
+Traits of the hardware floating-point type for the fast computer (see FastMath.h for the declaration).
+Each specialization provides the unit roundoff, the maximal error of the elementary functions (in ulps),
+and the conversions from literals and to 'float_precision'.
+*/
+template <>
+struct FastTraits<long double>
+{
+    //! Returns the maximal number of decimal digits which can be certified.
+    static unsigned int Digits()
+    {
+        return std::numeric_limits<long double>::digits10;
+    }
+
+    //! Returns the unit roundoff, i.e. the maximal relative error of a correctly rounded operation.
+    static double Unit()
+    {
+        return static_cast<double>(std::numeric_limits<long double>::epsilon()) * 0.5;
+    }
+
+    //! Returns the maximal error of the C library's elementary functions (in ulps).
+    static double FuncUlps()
+    {
+        return 8.0;
+    }
+
+    //! Returns the maximal relative error of a parsed literal.
+    static double ParseError()
+    {
+        return Unit();
+    }
+
+    //! Returns the largest magnitude up to which all integers are exact.
+    static double MaxInt()
+    {
+        return std::ldexp(1.0, std::numeric_limits<long double>::digits - 1);
+    }
+
+    static bool Parse(const std::string& s, long double& x)
+    {
+        char* end = nullptr;
+        x = std::strtold(s.c_str(), &end);
+        return (end != nullptr && *end == '\0');
+    }
+
+    static double ToDouble(long double x)
+    {
+        return static_cast<double>(x);
+    }
+
+    static float_precision ToFloat(long double x, unsigned int digits)
+    {
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "%.*Le", static_cast<int>(digits - 1), x);
+        return float_precision(buf, digits, ROUND_NEAR);
+    }
+
+    static int_precision ToInt(long double x)
+    {
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "%.0Lf", (x == 0.0L ? 0.0L : x));
+        return int_precision(buf);
+    }
+
+    static long double Pi()
+    {
+        return 3.141592653589793238462643383279502884L;
+    }
+};
+
+
+/*
+Computes an expression tree in a fixed-size floating-point type 'T' and keeps a running bound of
+the absolute error for each intermediate value. The result is only returned if the error bound
+certifies all requested digits, i.e. the interval around the result rounds to the same decimal number.
+Everything which is not supported (vectors, definitions, huge integers, ambiguous domains) is left for
+the arbitrary precision computer.
+*/
+template <typename T>
+class FastComputer : private Visitor
+{
+
+    public:
+
+        /**
+        Computes the specified expression tree.
+        \param[in] digits Specifies the number of decimal digits which must be certified.
+        \param[out] result Receives the result rounded to 'digits' digits (with the current rounding mode).
+        \return True if the result could be certified, otherwise false.
+        */
+        bool ComputeExpr(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet, unsigned int digits, Variable& result)
+        {
+            mode_           = mode;
+            constantsSet_   = &constantsSet;
+
+            try
+            {
+                Visit(ast);
+                return (values_.size() == 1 && Certify(values_.top(), digits, result));
+            }
+            catch (const Uncertified&)
+            {
+                return false;
+            }
+        }
+
+    private:
+
+        using Traits = FastTraits<T>;
+
+        struct Value
+        {
+            T       x;              // approximate value
+            double  err     = 0.0;  // bound of the absolute error of 'x'
+            bool    isInt   = false;// exact integer value (err is always 0)
+        };
+
+        //! Exception to leave the fast computation.
+        struct Uncertified {};
+
+        /* --- Visitor --- */
+
+        void VisitUnaryExpr(UnaryExpr* ast, void*) override
+        {
+            Visit(ast->expr);
+            auto& a = Top();
+
+            using Op = UnaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Keep:
+                    break;
+                case Op::Negate:
+                    a.x = -a.x;
+                    break;
+                case Op::Factorial:
+                    Factorial(a);
+                    break;
+                case Op::Norm:
+                    a.x = Abs(a.x);
+                    break;
+                default:
+                    Bail();
+                    break;
+            }
+        }
+
+        void VisitBinaryExpr(BinaryExpr* ast, void*) override
+        {
+            Visit(ast->exprL);
+            Visit(ast->exprR);
+
+            auto b = Pop();
+            auto& a = Top();
+
+            using Op = BinaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Add:
+                    Add(a, b);
+                    break;
+                case Op::Sub:
+                    b.x = -b.x;
+                    Add(a, b);
+                    break;
+                case Op::Mul:
+                    Mul(a, b);
+                    break;
+                case Op::Div:
+                    Div(a, b);
+                    break;
+                case Op::IntDiv:
+                    IntDiv(a, b);
+                    break;
+                case Op::Mod:
+                    Mod(a, b);
+                    break;
+                case Op::Pow:
+                    Pow(a, b);
+                    break;
+                case Op::LShift:
+                    Shift(a, b, true);
+                    break;
+                case Op::RShift:
+                    Shift(a, b, false);
+                    break;
+                default:
+                    Bail();
+                    break;
+            }
+
+            Check(a);
+        }
+
+        void VisitLiteralExpr(LiteralExpr* ast, void*) override
+        {
+            Push(Literal(ast->value));
+        }
+
+        void VisitIdentExpr(IdentExpr* ast, void*) override
+        {
+            /* Find index variable of a fold expression first */
+            if (auto index = FindIndex(ast->symbol))
+            {
+                Push(*index);
+                return;
+            }
+
+            /* Find constant (only real scalars), whose digits are converted only once */
+            auto value = constantsSet_->Find(ast->symbol);
+            if (!value || !value->Get().IsScalar() || value->Get().IsComplex())
+                Bail();
+
+            Push(value->Converted<Value>([this](const Variable& x) { return ConstValue(x); }));
+        }
+
+        void VisitFuncExpr(FuncExpr* ast, void*) override
+        {
+            using std::sin; using std::cos; using std::tan; using std::asin; using std::acos; using std::atan; using std::atan2;
+            using std::sinh; using std::cosh; using std::tanh; using std::asinh; using std::acosh; using std::atanh;
+            using std::pow; using std::sqrt; using std::exp; using std::log; using std::log10; using std::floor; using std::ceil;
+
+            /* Only built-in functions are computed here */
+            if (!ast->func || ast->func->impl)
+                Bail();
+
+            const auto f = static_cast<Function>(ast->func->id);
+            const auto n = ast->args.size();
+
+            auto Param = [&](std::size_t i) -> Value
+            {
+                Visit(ast->args[i]);
+                auto a = Pop();
+                if (a.isInt)
+                    a.isInt = false;
+                return a;
+            };
+
+            /* Unary functions */
+            if (n == 1)
+            {
+                Value a;
+
+                switch (f)
+                {
+                    case Function::Sin:
+                    case Function::Cos:
+                    case Function::Tan:
+                    {
+                        a = Deg2Rad(Param(0));
+                        Reduce(a);
+                        if (f == Function::Sin)
+                            Func(a, sin(a.x), a.err);
+                        else if (f == Function::Cos)
+                            Func(a, cos(a.x), a.err);
+                        else
+                        {
+                            /* Derivative 1/cos^2 must be bounded within the error interval */
+                            auto xd = Traits::ToDouble(a.x);
+                            auto c = std::abs(std::cos(xd)) - a.err - (std::abs(xd) + 1.0) * 4.0 * DBL_EPSILON;
+                            if (c <= 0.0)
+                                Bail();
+                            Func(a, tan(a.x), a.err / (c*c));
+                        }
+                    }
+                    break;
+
+                    case Function::ASin:
+                    case Function::ACos:
+                    {
+                        a = Param(0);
+                        auto m = std::abs(Traits::ToDouble(a.x)) + a.err;
+                        if (m >= 1.0)
+                            Bail();
+                        Func(a, (f == Function::ASin ? asin(a.x) : acos(a.x)), a.err / std::sqrt(1.0 - m*m));
+                        Rad2Deg(a);
+                    }
+                    break;
+
+                    case Function::ATan:
+                    {
+                        a = Param(0);
+                        Func(a, atan(a.x), a.err);
+                        Rad2Deg(a);
+                    }
+                    break;
+
+                    case Function::Sinh:
+                    case Function::Cosh:
+                    {
+                        a = Param(0);
+                        Reduce(a);
+                        auto m = std::abs(Traits::ToDouble(a.x)) + a.err;
+                        if (f == Function::Sinh)
+                            Func(a, sinh(a.x), a.err * std::cosh(m));
+                        else
+                            Func(a, cosh(a.x), a.err * std::sinh(m));
+                    }
+                    break;
+
+                    case Function::Tanh:
+                    {
+                        a = Param(0);
+                        Reduce(a);
+                        Func(a, tanh(a.x), a.err);
+                    }
+                    break;
+
+                    case Function::ASinh:
+                    {
+                        a = Param(0);
+                        Func(a, asinh(a.x), a.err + LogError());
+                    }
+                    break;
+
+                    case Function::ACosh:
+                    {
+                        a = Param(0);
+                        auto m = Traits::ToDouble(a.x) - a.err;
+                        if (m <= 1.0)
+                            Bail();
+                        Func(a, acosh(a.x), a.err / std::sqrt(m*m - 1.0) + LogError());
+                    }
+                    break;
+
+                    case Function::ATanh:
+                    {
+                        a = Param(0);
+                        auto m = std::abs(Traits::ToDouble(a.x)) + a.err;
+                        if (m >= 1.0)
+                            Bail();
+                        Func(a, atanh(a.x), a.err / (1.0 - m*m) + LogError());
+                    }
+                    break;
+
+                    case Function::Sqrt:
+                    {
+                        a = Param(0);
+                        auto xd = Traits::ToDouble(a.x);
+                        if (xd - a.err < 0.0 || a.x < T(0))
+                            Bail();
+                        auto d = std::sqrt(xd - a.err) + std::sqrt(xd);
+                        Func(a, sqrt(a.x), (d > 0.0 ? a.err / d : std::sqrt(a.err)));
+                    }
+                    break;
+
+                    case Function::Exp:
+                    {
+                        a = Param(0);
+                        Reduce(a);
+                        auto r = exp(a.x);
+                        Func(a, r, Mag(r) * std::expm1(a.err) * (1.0 + 1e-12));
+                    }
+                    break;
+
+                    case Function::Log:
+                    case Function::Log10:
+                    {
+                        a = Param(0);
+                        auto m = Traits::ToDouble(a.x) - a.err;
+                        if (m <= 0.0 || a.x <= T(0))
+                            Bail();
+                        if (f == Function::Log)
+                            Func(a, log(a.x), a.err / m + LogError());
+                        else
+                            Func(a, log10(a.x), a.err / (m * 2.302585092994045) + LogError());
+                    }
+                    break;
+
+                    case Function::Abs:
+                        Visit(ast->args[0]);
+                        Top().x = Abs(Top().x);
+                        return;
+
+                    case Function::Ceil:
+                    case Function::Floor:
+                        Visit(ast->args[0]);
+                        Integral(Top(), f == Function::Ceil);
+                        return;
+
+                    case Function::Sign:
+                        Visit(ast->args[0]);
+                        Sign(Top());
+                        return;
+
+                    case Function::Min:
+                    case Function::Max:
+                        Visit(ast->args[0]);
+                        return;
+
+                    default:
+                        Bail();
+                        break;
+                }
+
+                Push(a);
+            }
+            else if (n == 2 && (f == Function::ATan2 || f == Function::Pow))
+            {
+                auto a = Param(0);
+                auto b = Param(1);
+
+                if (f == Function::Pow)
+                    PowFloat(a, b);
+                else
+                {
+                    /* Bound the gradient (x, -y)/(x^2 + y^2) within the error box, and avoid the branch cut */
+                    auto y = Traits::ToDouble(a.x), x = Traits::ToDouble(b.x);
+                    auto r = std::sqrt(x*x + y*y) - std::sqrt(a.err*a.err + b.err*b.err);
+                    if (r <= 0.0 || (x < 0.0 && std::abs(y) <= a.err))
+                        Bail();
+                    auto e = a.err * b.err;
+                    Func(a, atan2(a.x, b.x), (std::abs(x)*a.err + std::abs(y)*b.err + e) / (r*r));
+                    Rad2Deg(a);
+                }
+
+                Push(a);
+            }
+            else if (n > 1 && (f == Function::Min || f == Function::Max))
+            {
+                /* Minimum and maximum are 1-Lipschitz, so the largest error bound is kept */
+                Visit(ast->args[0]);
+                for (std::size_t i = 1; i < n; ++i)
+                {
+                    Visit(ast->args[i]);
+                    auto b = Pop();
+                    auto& a = Top();
+
+                    Unify(a, b);
+                    if (f == Function::Min ? (b.x < a.x) : (b.x > a.x))
+                        a.x = b.x;
+                    a.err = std::max(a.err, b.err);
+                }
+                return;
+            }
+            else
+                Bail();
+        }
+
+        void VisitFoldExpr(FoldExpr* ast, void*) override
+        {
+            /* Index variable must not shadow a constant or the index of an enclosing fold (which is an error in the slow path) */
+            if (constantsSet_->Contains(ast->indexSymbol) || FindIndex(ast->indexSymbol))
+                Bail();
+
+            Visit(ast->initExpr);
+            auto first = Pop();
+
+            Visit(ast->iterExpr);
+            auto last = Pop();
+
+            if (!first.isInt || !last.isInt)
+                Bail();
+
+            bool isSum = (ast->func == "sum");
+            Value result = Integer(isSum ? 0 : 1);
+
+            if (last.x >= first.x)
+            {
+                /* Only short loops are worth to be computed here */
+                if (Traits::ToDouble(last.x) - Traits::ToDouble(first.x) >= maxFoldIterations)
+                    Bail();
+
+                indices_.push_back({ ast->indexSymbol, first });
+
+                for (auto idx = first.x; idx <= last.x; idx += T(1))
+                {
+                    indices_.back().second.x = idx;
+                    Visit(ast->loopExpr);
+                    auto val = Pop();
+
+                    if (isSum)
+                        Add(result, val);
+                    else
+                        Mul(result, val);
+
+                    Check(result);
+                }
+
+                indices_.pop_back();
+            }
+
+            Push(result);
+        }
+
+        void VisitVectorExpr(VectorExpr*, void*) override
+        {
+            Bail();
+        }
+
+        void VisitDefExpr(DefExpr*, void*) override
+        {
+            Bail();
+        }
+
+        /* --- Arithmetic with error bounds --- */
+
+        static void Bail()
+        {
+            throw Uncertified();
+        }
+
+        static T Abs(const T& x)
+        {
+            return (x < T(0) ? -x : x);
+        }
+
+        static double Mag(const T& x)
+        {
+            return std::abs(Traits::ToDouble(x));
+        }
+
+        // Rounds an error bound upwards to compensate the rounding of its own computation.
+        static double Up(double e)
+        {
+            return e * (1.0 + 1e-12);
+        }
+
+        // Adds the rounding error of a correctly rounded operation.
+        static void Round(Value& a)
+        {
+            a.err = Up(a.err + Mag(a.x) * Traits::Unit());
+        }
+
+        static Value Integer(int i)
+        {
+            Value v;
+            v.x     = T(i);
+            v.isInt = true;
+            return v;
+        }
+
+        Value Literal(const std::string& s)
+        {
+            Value v;
+
+            if (!Traits::Parse(s, v.x))
+                Bail();
+
+            if (s.find('.') == std::string::npos && s.find('E') == std::string::npos)
+            {
+                /* Integers must be exact */
+                if (Mag(v.x) > Traits::MaxInt())
+                    Bail();
+                v.isInt = true;
+            }
+            else
+                v.err = Up(Mag(v.x) * Traits::ParseError());
+
+            Check(v);
+            return v;
+        }
+
+        // Returns the value of a constant from its stored digits (the quotient of a rational with its error bound).
+        Value ConstValue(const Variable& x)
+        {
+            if (x.IsFloat())
+            {
+                /* Mantissa "+d1d2...dn" has the value d1.d2...dn * 10^exponent */
+                const auto& f = x.GetFloat();
+                const auto& m = *f.ref_mantissa();
+
+                std::string s;
+                s.reserve(m.size() + 16);
+
+                if (m[0] == '-')
+                    s += '-';
+                s += m[1];
+                s += '.';
+                s.append(m, 2, std::string::npos);
+                s += 'E';
+                s += std::to_string(f.exponent());
+
+                return Literal(s);
+            }
+
+            auto a = Literal(*x.GetInt().pointer());
+            if (x.IsRational())
+            {
+                Div(a, Literal(*x.GetDenom().pointer()));
+                Check(a);
+            }
+
+            return a;
+        }
+
+        // Leaves the fast computation on overflow, underflow and invalid values.
+        static void Check(const Value& a)
+        {
+            auto m = Mag(a.x);
+            if (!std::isfinite(m) || !std::isfinite(a.err) || m > 1e200 || (m != 0.0 && m < 1e-200) || a.err > 1e200)
+                Bail();
+            if (a.isInt && m > Traits::MaxInt())
+                Bail();
+        }
+
+        static void Unify(Value& a, Value& b)
+        {
+            if (a.isInt != b.isInt)
+                a.isInt = b.isInt = false;
+        }
+
+        static void Add(Value& a, const Value& b)
+        {
+            if (a.isInt && b.isInt)
+                a.x += b.x;
+            else
+            {
+                a.x += b.x;
+                a.err = a.err + b.err;
+                a.isInt = false;
+                Round(a);
+            }
+        }
+
+        static void Mul(Value& a, const Value& b)
+        {
+            if (a.isInt && b.isInt)
+            {
+                if (Mag(a.x) * Mag(b.x) > Traits::MaxInt() * 0.5)
+                    Bail();
+                a.x *= b.x;
+            }
+            else
+            {
+                a.err = Mag(a.x)*b.err + Mag(b.x)*a.err + a.err*b.err;
+                a.x *= b.x;
+                a.isInt = false;
+                Round(a);
+            }
+        }
+
+        static void Div(Value& a, const Value& b)
+        {
+            /* Divisor must be bounded away from zero */
+            auto bm = Mag(b.x);
+            auto bl = bm - b.err;
+            if (b.x == T(0) || bl <= bm * 1e-6)
+                Bail();
+
+            a.err = (Mag(a.x)*b.err + bm*a.err) / (bm*bl);
+            a.x /= b.x;
+            a.isInt = false;
+            Round(a);
+        }
+
+        static void IntDiv(Value& a, const Value& b)
+        {
+            using std::fmod;
+            using std::floor;
+
+            if (!a.isInt || !b.isInt || b.x == T(0))
+                Bail();
+
+            /* Quotient of the dividend without remainder is integral, so rounding to nearest makes it exact */
+            auto r = fmod(a.x, b.x);
+            a.x = floor((a.x - r) / b.x + T(0.5));
+            if (r < T(0))
+                a.x -= T(1);
+        }
+
+        static void Mod(Value& a, const Value& b)
+        {
+            using std::fmod;
+
+            if (!a.isInt || !b.isInt || b.x == T(0))
+                Bail();
+
+            a.x = fmod(a.x, b.x);
+            if (a.x < T(0))
+                a.x += b.x;
+        }
+
+        void Pow(Value& a, Value& b)
+        {
+            Unify(a, b);
+
+            if (a.isInt)
+            {
+                if (b.x < T(0))
+                {
+                    a.isInt = b.isInt = false;
+                    PowFloat(a, b);
+                }
+                else
+                    PowInt(a, b);
+            }
+            else
+                PowFloat(a, b);
+        }
+
+        static void PowInt(Value& a, const Value& b)
+        {
+            using std::floor;
+
+            /* Exponentiation by squaring, each step must stay exact */
+            T base = a.x, r = T(1);
+            std::uint64_t e = 0;
+
+            if (Traits::ToDouble(b.x) >= 1e18)
+            {
+                /* Only 0, 1 and -1 can be raised to huge powers, so keep the parity only */
+                if (Mag(base) > 1.0)
+                    Bail();
+                e = (Traits::ToDouble(b.x - T(2)*floor(b.x / T(2))) != 0.0 ? 3 : 2);
+            }
+            else
+                e = static_cast<std::uint64_t>(Traits::ToDouble(b.x));
+
+            while (e > 0)
+            {
+                if (e & 1)
+                {
+                    if (Mag(r) * Mag(base) > Traits::MaxInt() * 0.5)
+                        Bail();
+                    r *= base;
+                }
+                e >>= 1;
+                if (e > 0)
+                {
+                    if (Mag(base) * Mag(base) > Traits::MaxInt() * 0.5)
+                        Bail();
+                    base *= base;
+                }
+            }
+
+            a.x = r;
+        }
+
+        void PowFloat(Value& a, const Value& b)
+        {
+            using std::pow;
+            using std::floor;
+
+            /* Negative bases are only allowed for exact integral exponents */
+            if (a.x < T(0) && (b.err != 0.0 || floor(b.x) != b.x))
+                Bail();
+
+            /* x'^y' / x^y = exp(y' log(x') - y log(x)) */
+            auto xl = Mag(a.x) - a.err;
+            auto xu = Mag(a.x) + a.err;
+            if (xl <= 0.0)
+                Bail();
+
+            auto l = std::max(std::abs(std::log(xl)), std::abs(std::log(xu)));
+            auto t = (Mag(b.x) + b.err) * (a.err / xl + (l + 1.0) * LogError()) + b.err * l;
+            if (t > 0.5)
+                Bail();
+
+            Func(a, pow(a.x, b.x), 0.0);
+            a.err = Up(a.err + Mag(a.x) * std::expm1(t) * (1.0 + 1e-12));
+        }
+
+        /*
+        Adds the error of an argument reduction by multiples of pi/2 or ln2, which is absolute.
+        The error of the logarithm is also absolute when the result is close to zero.
+        Both are covered generously for the C library as well as for the software types.
+        The software types compute the multiple in double (see FastSinCos), which is only exact below 2^52.
+        */
+        static void Reduce(Value& a)
+        {
+            if (Mag(a.x) >= 4503599627370496.0)
+                Bail();
+            a.err = Up(a.err + Mag(a.x) * 8.0 * Traits::Unit());
+        }
+
+        static double LogError()
+        {
+            return 8.0 * Traits::Unit();
+        }
+
+        // Stores the result 'r' of an elementary function and its propagated error 'dr'.
+        static void Func(Value& a, const T& r, double dr)
+        {
+            a.x     = r;
+            a.err   = Up(dr + Mag(r) * Traits::FuncUlps() * 2.0 * Traits::Unit());
+            a.isInt = false;
+            Check(a);
+        }
+
+        void Shift(Value& a, const Value& b, bool left)
+        {
+            using std::floor;
+
+            if (!a.isInt || !b.isInt || a.x < T(0) || b.x < T(0) || Traits::ToDouble(b.x) > 1023.0)
+                Bail();
+
+            auto s = std::ldexp(1.0, static_cast<int>(Traits::ToDouble(b.x)));
+            if (left)
+            {
+                if (Mag(a.x) * s > Traits::MaxInt() * 0.5)
+                    Bail();
+                a.x *= T(s);
+            }
+            else
+                a.x = floor(a.x / T(s));
+        }
+
+        static void Factorial(Value& a)
+        {
+            if (!a.isInt)
+                Bail();
+
+            /* Negative numbers keep their sign (see Variable::Factorial) */
+            bool isNeg = (a.x < T(0));
+            T n = Abs(a.x), r = T(1);
+
+            for (; n > T(1); n -= T(1))
+            {
+                if (Mag(r) * Mag(n) > Traits::MaxInt() * 0.5)
+                    Bail();
+                r *= n;
+            }
+
+            a.x = (isNeg ? -r : r);
+        }
+
+        static void Integral(Value& a, bool up)
+        {
+            using std::floor;
+            using std::ceil;
+
+            if (a.isInt)
+                return;
+
+            /* The whole error interval must map onto the same integer */
+            auto e = Up(a.err + Mag(a.x) * 4.0 * Traits::Unit());
+            auto lo = (up ? ceil(a.x - T(e)) : floor(a.x - T(e)));
+            auto hi = (up ? ceil(a.x + T(e)) : floor(a.x + T(e)));
+            if (lo != hi)
+                Bail();
+
+            a.x     = lo;
+            a.err   = 0.0;
+            a.isInt = true;
+            Check(a);
+        }
+
+        static void Sign(Value& a)
+        {
+            if (a.x == T(0) && a.err == 0.0)
+                a = Integer(0);
+            else if (Mag(a.x) > a.err)
+                a = Integer(a.x > T(0) ? 1 : -1);
+            else
+                Bail();
+        }
+
+        Value Deg2Rad(Value a) const
+        {
+            if (mode_.degree)
+            {
+                Value k;
+                k.x = Traits::Pi() / T(180);
+                Round(k);
+                Round(k);
+                Mul(a, k);
+            }
+            return a;
+        }
+
+        void Rad2Deg(Value& a) const
+        {
+            if (mode_.degree)
+            {
+                Value k;
+                k.x = T(180) / Traits::Pi();
+                Round(k);
+                Round(k);
+                Mul(a, k);
+            }
+        }
+
+        /* --- Certification --- */
+
+        static float_precision ToFloat(double d, unsigned int digits)
+        {
+            char buf[128];
+            std::snprintf(buf, sizeof(buf), "%.17e", d);
+            return float_precision(buf, digits, ROUND_NEAR);
+        }
+
+        static bool Certify(const Value& a, unsigned int digits, Variable& result)
+        {
+            if (a.isInt)
+            {
+                /* Integers are exact */
+                result = Variable(Traits::ToInt(a.x));
+                return true;
+            }
+
+            /*
+            Enclose the exact value in [lo, hi], including the conversion errors to decimal,
+            and check if both ends are rounded to the same number
+            */
+            const unsigned int guard = digits + 8;
+
+            auto center = Traits::ToFloat(a.x, guard);
+            auto radius = ToFloat(Up(a.err + Mag(a.x) * std::pow(10.0, -static_cast<int>(digits + 5))), guard);
+
+            const auto mode = float_precision_ctrl.mode();
+
+            float_precision lo(0, guard, mode), hi(0, guard, mode);
+            lo = center - radius;
+            hi = center + radius;
+
+            lo.precision(digits);
+            hi.precision(digits);
+
+            if (!(lo == hi))
+                return false;
+
+            result = Variable(std::move(lo));
+            return true;
+        }
+
+        /* --- Value stack --- */
+
+        void Push(const Value& value)
+        {
+            values_.push(value);
+        }
+
+        Value Pop()
+        {
+            if (values_.empty())
+                Bail();
+            auto value = values_.top();
+            values_.pop();
+            return value;
+        }
+
+        // Returns the value of the innermost index variable with the specified identifier, or null if there is no such index variable.
+        const Value* FindIndex(Symbol symbol) const
+        {
+            for (auto it = indices_.rbegin(); it != indices_.rend(); ++it)
+            {
+                if (it->first == symbol)
+                    return &(it->second);
+            }
+            return nullptr;
+        }
+
+        Value& Top()
+        {
+            if (values_.empty())
+                Bail();
+            return values_.top();
+        }
+
+        static const int maxFoldIterations = 4096;
+
+        std::stack<Value>                               values_;
+        std::vector<std::pair<Symbol, Value>>           indices_;
+
+        ComputeMode                                     mode_;
+        const ConstantsSet*                             constantsSet_   = nullptr;
+
+};
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,288 @@
+/*
+ * FastMath.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_FAST_MATH_H__
+#define __AC_FAST_MATH_H__
+
+
+#include <cmath>
+
+
+namespace Ac
+{
+
+
+/*
+Traits of a floating-point type for the fast computer (see FastComputer.h).
+The generic functions below only need 'Unit', 'ToDouble', 'Pi', 'Ln2' and 'Ln10' of these traits.
+*/
+template <typename T>
+struct FastTraits;
+
+/*
+Elementary functions for software floating-point types with a fixed precision (like MultiDouble and fixed_float),
+which must provide the arithmetic operators (including the division by a double), comparisons,
+and the functions 'ldexp' and 'floor'.
+All of them start with the double precision result and refine it with Newton iterations,
+or use argument reduction and Taylor series, until the unit roundoff of 'T' is reached.
+Errors of the argument reductions are absolute (see FastComputer for their bounds).
+*/
+
+// Returns the number of Newton iterations to refine a double precision start value.
+template <typename T>
+int FastNewtonSteps()
+{
+    int steps = 0;
+    for (double bits = 52.0; bits < -std::log2(FastTraits<T>::Unit()); bits *= 2.0)
+        ++steps;
+    return steps;
+}
+
+template <typename T>
+bool FastIsNegligible(const T& term, const T& sum)
+{
+    return std::abs(FastTraits<T>::ToDouble(term)) <= std::abs(FastTraits<T>::ToDouble(sum)) * FastTraits<T>::Unit() * 0.0625;
+}
+
+template <typename T>
+T FastSqrt(const T& x)
+{
+    if (x == T(0))
+        return T(0);
+
+    /* y' = (y + x/y)/2 */
+    T y = T(std::sqrt(FastTraits<T>::ToDouble(x)));
+    for (int i = FastNewtonSteps<T>(); i > 0; --i)
+        y = ldexp(y + x / y, -1);
+
+    return y;
+}
+
+template <typename T>
+T FastExp(const T& x)
+{
+    static const int halvings = 10;
+
+    if (x == T(0))
+        return T(1);
+
+    /* Reduce x = k*ln2 + r with |r| <= ln2/2, and scale r down by 2^halvings */
+    double k = std::floor(FastTraits<T>::ToDouble(x) / 0.6931471805599453 + 0.5);
+    T r = ldexp(x - FastTraits<T>::Ln2() * T(k), -halvings);
+
+    /* Taylor series of exp(r) - 1 */
+    T s = r, term = r;
+    for (int n = 2; n < 100; ++n)
+    {
+        term = term * r / static_cast<double>(n);
+        s += term;
+        if (FastIsNegligible(term, s))
+            break;
+    }
+
+    /* exp(2r) - 1 = (exp(r) - 1)*(exp(r) + 1) */
+    for (int i = 0; i < halvings; ++i)
+        s = s * (s + T(2));
+
+    return ldexp(s + T(1), static_cast<int>(k));
+}
+
+template <typename T>
+T FastLog(const T& x)
+{
+    /* y' = y + x*exp(-y) - 1 */
+    T y = T(std::log(FastTraits<T>::ToDouble(x)));
+    for (int i = FastNewtonSteps<T>(); i > 0; --i)
+        y = y + x * FastExp(-y) - T(1);
+    return y;
+}
+
+template <typename T>
+T FastLog10(const T& x)
+{
+    return FastLog(x) / FastTraits<T>::Ln10();
+}
+
+template <typename T>
+void FastSinCos(const T& x, T& s, T& c)
+{
+    /* Reduce x = k*pi/2 + r with |r| <= pi/4 */
+    const T halfPi = ldexp(FastTraits<T>::Pi(), -1);
+    double k = std::floor(FastTraits<T>::ToDouble(x) / 1.5707963267948966 + 0.5);
+    T r = x - halfPi * T(k);
+
+    /* Taylor series of sin(r), and cos(r) = sqrt(1 - sin(r)^2) which is >= 1/sqrt(2) */
+    T rr = r * r, sr = r, term = r;
+    for (int n = 3; n < 200; n += 2)
+    {
+        term = -term * rr / (static_cast<double>(n) * static_cast<double>(n - 1));
+        sr += term;
+        if (FastIsNegligible(term, sr))
+            break;
+    }
+
+    T cr = FastSqrt((T(1) - sr) * (T(1) + sr));
+
+    /* Select quadrant */
+    switch (static_cast<int>(k - 4.0 * std::floor(k * 0.25)))
+    {
+        case 0: s =  sr; c =  cr; break;
+        case 1: s =  cr; c = -sr; break;
+        case 2: s = -sr; c = -cr; break;
+        default:s = -cr; c =  sr; break;
+    }
+}
+
+template <typename T>
+T FastSin(const T& x)
+{
+    T s, c;
+    FastSinCos(x, s, c);
+    return s;
+}
+
+template <typename T>
+T FastCos(const T& x)
+{
+    T s, c;
+    FastSinCos(x, s, c);
+    return c;
+}
+
+template <typename T>
+T FastTan(const T& x)
+{
+    T s, c;
+    FastSinCos(x, s, c);
+    return s / c;
+}
+
+template <typename T>
+T FastAtan2(const T& y, const T& x)
+{
+    if (x == T(0) && y == T(0))
+        return T(0);
+
+    /* Refine z = atan2(y, x) on the unit circle with Newton iterations of sin(z) = y/r or cos(z) = x/r */
+    T r = FastSqrt(x*x + y*y);
+    T xr = x / r, yr = y / r;
+    T z = T(std::atan2(FastTraits<T>::ToDouble(y), FastTraits<T>::ToDouble(x)));
+    bool useSin = (std::abs(FastTraits<T>::ToDouble(xr)) > std::abs(FastTraits<T>::ToDouble(yr)));
+
+    for (int i = FastNewtonSteps<T>(); i > 0; --i)
+    {
+        T s, c;
+        FastSinCos(z, s, c);
+        if (useSin)
+            z = z + (yr - s) / c;
+        else
+            z = z - (xr - c) / s;
+    }
+
+    return z;
+}
+
+template <typename T>
+T FastAtan(const T& x)
+{
+    return FastAtan2(x, T(1));
+}
+
+template <typename T>
+T FastAsin(const T& x)
+{
+    return FastAtan2(x, FastSqrt((T(1) - x) * (T(1) + x)));
+}
+
+template <typename T>
+T FastAcos(const T& x)
+{
+    return FastAtan2(FastSqrt((T(1) - x) * (T(1) + x)), x);
+}
+
+template <typename T>
+T FastSinh(const T& x)
+{
+    if (std::abs(FastTraits<T>::ToDouble(x)) < 0.5)
+    {
+        /* Taylor series to avoid the cancellation of exp(x) - exp(-x) */
+        T xx = x * x, s = x, term = x;
+        for (int n = 3; n < 200; n += 2)
+        {
+            term = term * xx / (static_cast<double>(n) * static_cast<double>(n - 1));
+            s += term;
+            if (FastIsNegligible(term, s))
+                break;
+        }
+        return s;
+    }
+
+    T e = FastExp(x);
+    return ldexp(e - T(1) / e, -1);
+}
+
+template <typename T>
+T FastCosh(const T& x)
+{
+    T e = FastExp(x);
+    return ldexp(e + T(1) / e, -1);
+}
+
+template <typename T>
+T FastTanh(const T& x)
+{
+    if (std::abs(FastTraits<T>::ToDouble(x)) < 0.5)
+        return FastSinh(x) / FastCosh(x);
+
+    /* tanh(x) = (exp(2x) - 1)/(exp(2x) + 1) */
+    T e = FastExp(ldexp(x, 1));
+    return (e - T(1)) / (e + T(1));
+}
+
+template <typename T>
+T FastAsinh(const T& x)
+{
+    /* Odd function, so avoid the cancellation for negative arguments */
+    if (x < T(0))
+        return -FastAsinh(-x);
+    return FastLog(x + FastSqrt(x*x + T(1)));
+}
+
+template <typename T>
+T FastAcosh(const T& x)
+{
+    return FastLog(x + FastSqrt((x - T(1)) * (x + T(1))));
+}
+
+template <typename T>
+T FastAtanh(const T& x)
+{
+    return ldexp(FastLog((T(1) + x) / (T(1) - x)), -1);
+}
+
+template <typename T>
+T FastPow(const T& x, const T& y)
+{
+    if (x < T(0))
+    {
+        /* Only defined for integral exponents */
+        T r = FastExp(y * FastLog(-x));
+        T h = ldexp(y, -1);
+        return (floor(h) == h ? r : -r);
+    }
+    return FastExp(y * FastLog(x));
+}
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,1153 @@
+/*
+ * FixedPrecision.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_FIXED_PRECISION_H__
+#define __AC_FIXED_PRECISION_H__
+
+
+#include "precpkg/iprecision.h"
+#include "precpkg/fprecision.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+
+namespace Ac
+{
+
+
+/*
+Kernels for unsigned integers of 'N' limbs (32 bit each, least significant limb first).
+The limb counts are template parameters, so the compiler can unroll all loops.
+*/
+
+// r = a + b, returns the carry.
+template <int N>
+inline std::uint32_t LimbAdd(std::uint32_t* r, const std::uint32_t* a, const std::uint32_t* b)
+{
+    std::uint64_t c = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        c += static_cast<std::uint64_t>(a[i]) + b[i];
+        r[i] = static_cast<std::uint32_t>(c);
+        c >>= 32;
+    }
+    return static_cast<std::uint32_t>(c);
+}
+
+// r = a - b, returns the borrow.
+template <int N>
+inline std::uint32_t LimbSub(std::uint32_t* r, const std::uint32_t* a, const std::uint32_t* b)
+{
+    std::uint64_t borrow = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        std::uint64_t t = static_cast<std::uint64_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<std::uint32_t>(t);
+        borrow = (t >> 63);
+    }
+    return static_cast<std::uint32_t>(borrow);
+}
+
+// x += y, returns the carry.
+template <int N>
+inline std::uint32_t LimbAddSmall(std::uint32_t* x, std::uint32_t y)
+{
+    std::uint64_t c = y;
+    for (int i = 0; i < N && c != 0; ++i)
+    {
+        c += x[i];
+        x[i] = static_cast<std::uint32_t>(c);
+        c >>= 32;
+    }
+    return static_cast<std::uint32_t>(c);
+}
+
+// x -= y, returns the borrow.
+template <int N>
+inline std::uint32_t LimbSubSmall(std::uint32_t* x, std::uint32_t y)
+{
+    std::uint64_t borrow = y;
+    for (int i = 0; i < N && borrow != 0; ++i)
+    {
+        std::uint64_t t = static_cast<std::uint64_t>(x[i]) - borrow;
+        x[i] = static_cast<std::uint32_t>(t);
+        borrow = (t >> 63);
+    }
+    return static_cast<std::uint32_t>(borrow);
+}
+
+template <int N>
+inline int LimbCompare(const std::uint32_t* a, const std::uint32_t* b)
+{
+    for (int i = N - 1; i >= 0; --i)
+    {
+        if (a[i] != b[i])
+            return (a[i] < b[i] ? -1 : 1);
+    }
+    return 0;
+}
+
+template <int N>
+inline bool LimbIsZero(const std::uint32_t* x)
+{
+    for (int i = 0; i < N; ++i)
+    {
+        if (x[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+inline int LimbLeadingZeros(std::uint32_t x)
+{
+    int n = 0;
+    for (std::uint32_t bit = 0x80000000u; bit != 0 && (x & bit) == 0; bit >>= 1)
+        ++n;
+    return n;
+}
+
+// Returns the number of significant bits.
+template <int N>
+inline int LimbBitLength(const std::uint32_t* x)
+{
+    for (int i = N - 1; i >= 0; --i)
+    {
+        if (x[i] != 0)
+            return i*32 + 32 - LimbLeadingZeros(x[i]);
+    }
+    return 0;
+}
+
+// x <<= s, the bits shifted out are lost.
+template <int N>
+inline void LimbShiftLeft(std::uint32_t* x, int s)
+{
+    const int l = s / 32, b = s % 32;
+    for (int i = N - 1; i >= 0; --i)
+    {
+        std::uint32_t hi = (i - l >= 0 ? x[i - l] : 0);
+        std::uint32_t lo = (i - l - 1 >= 0 ? x[i - l - 1] : 0);
+        x[i] = (b == 0 ? hi : (hi << b) | (lo >> (32 - b)));
+    }
+}
+
+// x >>= s, returns true if any non-zero bit was shifted out.
+template <int N>
+inline bool LimbShiftRight(std::uint32_t* x, int s)
+{
+    if (s >= 32*N)
+    {
+        bool sticky = !LimbIsZero<N>(x);
+        for (int i = 0; i < N; ++i)
+            x[i] = 0;
+        return sticky;
+    }
+
+    const int l = s / 32, b = s % 32;
+    bool sticky = false;
+
+    for (int i = 0; i < l; ++i)
+        sticky = sticky || (x[i] != 0);
+    if (b != 0)
+        sticky = sticky || ((x[l] << (32 - b)) != 0);
+
+    for (int i = 0; i < N; ++i)
+    {
+        std::uint32_t lo = (i + l < N ? x[i + l] : 0);
+        std::uint32_t hi = (i + l + 1 < N ? x[i + l + 1] : 0);
+        x[i] = (b == 0 ? lo : (lo >> b) | (hi << (32 - b)));
+    }
+
+    return sticky;
+}
+
+// r = a * b (schoolbook multiplication with the full product of N + M limbs).
+template <int N, int M>
+inline void LimbMul(std::uint32_t* r, const std::uint32_t* a, const std::uint32_t* b)
+{
+    for (int i = 0; i < N + M; ++i)
+        r[i] = 0;
+
+    for (int i = 0; i < N; ++i)
+    {
+        std::uint64_t c = 0;
+        for (int j = 0; j < M; ++j)
+        {
+            c += static_cast<std::uint64_t>(a[i]) * b[j] + r[i + j];
+            r[i + j] = static_cast<std::uint32_t>(c);
+            c >>= 32;
+        }
+        r[i + M] = static_cast<std::uint32_t>(c);
+    }
+}
+
+// x = x * m + a, returns the carry.
+template <int N>
+inline std::uint32_t LimbMulSmall(std::uint32_t* x, std::uint32_t m, std::uint32_t a)
+{
+    std::uint64_t c = a;
+    for (int i = 0; i < N; ++i)
+    {
+        c += static_cast<std::uint64_t>(x[i]) * m;
+        x[i] = static_cast<std::uint32_t>(c);
+        c >>= 32;
+    }
+    return static_cast<std::uint32_t>(c);
+}
+
+// x /= d, returns the remainder.
+template <int N>
+inline std::uint32_t LimbDivSmall(std::uint32_t* x, std::uint32_t d)
+{
+    std::uint64_t r = 0;
+    for (int i = N - 1; i >= 0; --i)
+    {
+        r = (r << 32) | x[i];
+        x[i] = static_cast<std::uint32_t>(r / d);
+        r %= d;
+    }
+    return static_cast<std::uint32_t>(r);
+}
+
+/**
+Long division (Knuth, TAOCP Vol. 2, Algorithm D) of 'u' with M limbs by 'v' with N limbs.
+\param[out] q Receives the quotient with M - N + 1 limbs.
+\param[out] r Receives the remainder with N limbs.
+\remarks The leading limb of 'v' must not be zero.
+*/
+template <int M, int N>
+inline void LimbDivMod(std::uint32_t* q, std::uint32_t* r, const std::uint32_t* u, const std::uint32_t* v)
+{
+    static const std::uint64_t base = (1ull << 32);
+
+    if (N == 1)
+    {
+        for (int i = 0; i < M; ++i)
+            q[i] = u[i];
+        r[0] = LimbDivSmall<M>(q, v[0]);
+        return;
+    }
+
+    /* Normalize divisor, so that its leading bit is set */
+    const int s = LimbLeadingZeros(v[N - 1]);
+    std::uint32_t vn[N], un[M + 1];
+
+    for (int i = 0; i < N; ++i)
+        vn[i] = v[i];
+    for (int i = 0; i < M; ++i)
+        un[i] = u[i];
+    un[M] = 0;
+
+    LimbShiftLeft<N>(vn, s);
+    LimbShiftLeft<M + 1>(un, s);
+
+    for (int j = M - N; j >= 0; --j)
+    {
+        /* Estimate quotient limb, which is at most two too large */
+        std::uint64_t num = (static_cast<std::uint64_t>(un[j + N]) << 32) | un[j + N - 1];
+        std::uint64_t qhat = num / vn[N - 1];
+        std::uint64_t rhat = num % vn[N - 1];
+
+        while (qhat >= base || qhat * vn[N >= 2 ? N - 2 : 0] > ((rhat << 32) | un[j + N - 2]))
+        {
+            --qhat;
+            rhat += vn[N - 1];
+            if (rhat >= base)
+                break;
+        }
+
+        /* Multiply and subtract */
+        std::int64_t t = 0;
+        std::uint64_t k = 0;
+
+        for (int i = 0; i < N; ++i)
+        {
+            std::uint64_t p = qhat * vn[i];
+            t = static_cast<std::int64_t>(un[i + j]) - static_cast<std::int64_t>(k) - static_cast<std::int64_t>(p & 0xFFFFFFFFu);
+            un[i + j] = static_cast<std::uint32_t>(t);
+            k = (p >> 32) - (t >> 32);
+        }
+
+        t = static_cast<std::int64_t>(un[j + N]) - static_cast<std::int64_t>(k);
+        un[j + N] = static_cast<std::uint32_t>(t);
+        q[j] = static_cast<std::uint32_t>(qhat);
+
+        /* Add back if the estimate was one too large */
+        if (t < 0)
+        {
+            --q[j];
+            un[j + N] += LimbAdd<N>(un + j, un + j, vn);
+        }
+    }
+
+    /* Denormalize remainder */
+    LimbShiftRight<N + 1>(un, s);
+    for (int i = 0; i < N; ++i)
+        r[i] = un[i];
+}
+
+
+/*
+Signed integer with a fixed number of bits (sign and magnitude), stored inline without heap allocation.
+Results which do not fit into 'Bits' are reduced modulo 2^Bits, so the caller must keep them in range
+(like the fast computer does with 'FastTraits::MaxInt').
+*/
+template <int Bits>
+class fixed_int
+{
+
+    public:
+
+        static_assert(Bits > 0 && Bits % 32 == 0, "number of bits for fixed_int must be a multiple of 32");
+
+        static const int limbs = Bits / 32;
+
+        fixed_int()
+        {
+            for (int i = 0; i < limbs; ++i)
+                limbs_[i] = 0;
+        }
+
+        fixed_int(long long x) :
+            fixed_int()
+        {
+            neg_ = (x < 0);
+            auto m = (neg_ ? 0ull - static_cast<unsigned long long>(x) : static_cast<unsigned long long>(x));
+            for (int i = 0; i < limbs && m != 0; ++i, m >>= 32)
+                limbs_[i] = static_cast<std::uint32_t>(m);
+        }
+
+        //! Parses a decimal integer (with optional sign). Returns false on syntax errors and overflow.
+        static bool Parse(const std::string& s, fixed_int& x)
+        {
+            x = fixed_int();
+
+            std::size_t i = 0, n = s.size();
+            bool isNeg = false;
+
+            if (i < n && (s[i] == '-' || s[i] == '+'))
+                isNeg = (s[i++] == '-');
+
+            if (i == n)
+                return false;
+
+            for (; i < n; ++i)
+            {
+                if (s[i] < '0' || s[i] > '9')
+                    return false;
+                if (LimbMulSmall<limbs>(x.limbs_, 10, static_cast<std::uint32_t>(s[i] - '0')) != 0)
+                    return false;
+            }
+
+            x.neg_ = (isNeg && !x.IsZero());
+            return true;
+        }
+
+        //! Returns the decimal representation, e.g. "-123".
+        std::string ToString() const
+        {
+            if (IsZero())
+                return "0";
+
+            /* Extract chunks of 9 decimal digits */
+            std::uint32_t x[limbs];
+            for (int i = 0; i < limbs; ++i)
+                x[i] = limbs_[i];
+
+            std::string s;
+            while (!LimbIsZero<limbs>(x))
+            {
+                auto chunk = LimbDivSmall<limbs>(x, 1000000000u);
+                for (int i = 0; i < 9 && (chunk != 0 || !LimbIsZero<limbs>(x)); ++i, chunk /= 10)
+                    s += static_cast<char>('0' + chunk % 10);
+            }
+
+            if (neg_)
+                s += '-';
+
+            return std::string(s.rbegin(), s.rend());
+        }
+
+        int_precision ToIntPrecision() const
+        {
+            return int_precision(ToString().c_str());
+        }
+
+        bool IsZero() const
+        {
+            return LimbIsZero<limbs>(limbs_);
+        }
+
+        bool IsNegative() const
+        {
+            return neg_;
+        }
+
+        //! Sets the sign, which is ignored for zero.
+        void SetNegative(bool neg)
+        {
+            neg_ = neg;
+            Normalize();
+        }
+
+        //! Returns the limbs of the magnitude (least significant limb first).
+        std::uint32_t* Data()
+        {
+            return limbs_;
+        }
+
+        const std::uint32_t* Data() const
+        {
+            return limbs_;
+        }
+
+        //! Returns the number of significant bits of the magnitude.
+        int BitLength() const
+        {
+            return LimbBitLength<limbs>(limbs_);
+        }
+
+        //! Returns -1, 0, or 1 if the magnitude of this integer is less than, equal to, or greater than the magnitude of 'rhs'.
+        int CompareMagnitude(const fixed_int& rhs) const
+        {
+            return LimbCompare<limbs>(limbs_, rhs.limbs_);
+        }
+
+        fixed_int operator - () const
+        {
+            auto r = *this;
+            r.neg_ = (!neg_ && !IsZero());
+            return r;
+        }
+
+        fixed_int& operator += (const fixed_int& rhs)
+        {
+            if (neg_ == rhs.neg_)
+                LimbAdd<limbs>(limbs_, limbs_, rhs.limbs_);
+            else if (CompareMagnitude(rhs) >= 0)
+                LimbSub<limbs>(limbs_, limbs_, rhs.limbs_);
+            else
+            {
+                LimbSub<limbs>(limbs_, rhs.limbs_, limbs_);
+                neg_ = rhs.neg_;
+            }
+            Normalize();
+            return *this;
+        }
+
+        fixed_int& operator -= (const fixed_int& rhs)
+        {
+            return (*this += -rhs);
+        }
+
+        fixed_int& operator *= (const fixed_int& rhs)
+        {
+            std::uint32_t r[2*limbs];
+            LimbMul<limbs, limbs>(r, limbs_, rhs.limbs_);
+            for (int i = 0; i < limbs; ++i)
+                limbs_[i] = r[i];
+            neg_ = (neg_ != rhs.neg_);
+            Normalize();
+            return *this;
+        }
+
+        //! Division rounded toward zero (like 'int_precision'). Throws std::runtime_error on division by zero.
+        fixed_int& operator /= (const fixed_int& rhs)
+        {
+            fixed_int q, r;
+            DivMod(*this, rhs, q, r);
+            return (*this = q);
+        }
+
+        //! Remainder with the sign of the dividend. Throws std::runtime_error on division by zero.
+        fixed_int& operator %= (const fixed_int& rhs)
+        {
+            fixed_int q, r;
+            DivMod(*this, rhs, q, r);
+            return (*this = r);
+        }
+
+        fixed_int& operator <<= (int s)
+        {
+            if (s >= Bits)
+                *this = fixed_int();
+            else if (s > 0)
+                LimbShiftLeft<limbs>(limbs_, s);
+            Normalize();
+            return *this;
+        }
+
+        fixed_int& operator >>= (int s)
+        {
+            LimbShiftRight<limbs>(limbs_, s);
+            Normalize();
+            return *this;
+        }
+
+    private:
+
+        static void DivMod(const fixed_int& a, const fixed_int& b, fixed_int& q, fixed_int& r)
+        {
+            if (b.IsZero())
+                throw std::runtime_error("math error: division by zero");
+
+            const int n = b.BitLength();
+
+            if (n <= 32)
+            {
+                q = a;
+                r = fixed_int(static_cast<long long>(LimbDivSmall<limbs>(q.limbs_, b.limbs_[0])));
+            }
+            else
+            {
+                /* Shift both operands, so that the leading limb of the divisor is not zero */
+                std::uint32_t u[2*limbs], v[limbs], qt[limbs + 1];
+
+                for (int i = 0; i < limbs; ++i)
+                {
+                    u[i]            = a.limbs_[i];
+                    u[limbs + i]    = 0;
+                    v[i]            = b.limbs_[i];
+                }
+
+                LimbShiftLeft<2*limbs>(u, Bits - n);
+                LimbShiftLeft<limbs>(v, Bits - n);
+
+                LimbDivMod<2*limbs, limbs>(qt, r.limbs_, u, v);
+                LimbShiftRight<limbs>(r.limbs_, Bits - n);
+
+                for (int i = 0; i < limbs; ++i)
+                    q.limbs_[i] = qt[i];
+            }
+
+            q.neg_ = (a.neg_ != b.neg_);
+            r.neg_ = a.neg_;
+            q.Normalize();
+            r.Normalize();
+        }
+
+        // Zero is never negative.
+        void Normalize()
+        {
+            if (neg_ && IsZero())
+                neg_ = false;
+        }
+
+        std::uint32_t   limbs_[limbs];
+        bool            neg_            = false;
+
+};
+
+template <int Bits>
+fixed_int<Bits> operator + (fixed_int<Bits> a, const fixed_int<Bits>& b) { return (a += b); }
+
+template <int Bits>
+fixed_int<Bits> operator - (fixed_int<Bits> a, const fixed_int<Bits>& b) { return (a -= b); }
+
+template <int Bits>
+fixed_int<Bits> operator * (fixed_int<Bits> a, const fixed_int<Bits>& b) { return (a *= b); }
+
+template <int Bits>
+fixed_int<Bits> operator / (fixed_int<Bits> a, const fixed_int<Bits>& b) { return (a /= b); }
+
+template <int Bits>
+fixed_int<Bits> operator % (fixed_int<Bits> a, const fixed_int<Bits>& b) { return (a %= b); }
+
+template <int Bits>
+fixed_int<Bits> operator << (fixed_int<Bits> a, int s) { return (a <<= s); }
+
+template <int Bits>
+fixed_int<Bits> operator >> (fixed_int<Bits> a, int s) { return (a >>= s); }
+
+template <int Bits>
+int Compare(const fixed_int<Bits>& a, const fixed_int<Bits>& b)
+{
+    if (a.IsNegative() != b.IsNegative())
+        return (a.IsNegative() ? -1 : 1);
+    auto c = a.CompareMagnitude(b);
+    return (a.IsNegative() ? -c : c);
+}
+
+template <int Bits> bool operator == (const fixed_int<Bits>& a, const fixed_int<Bits>& b) { return Compare(a, b) == 0; }
+template <int Bits> bool operator != (const fixed_int<Bits>& a, const fixed_int<Bits>& b) { return Compare(a, b) != 0; }
+template <int Bits> bool operator <  (const fixed_int<Bits>& a, const fixed_int<Bits>& b) { return Compare(a, b) <  0; }
+template <int Bits> bool operator <= (const fixed_int<Bits>& a, const fixed_int<Bits>& b) { return Compare(a, b) <= 0; }
+template <int Bits> bool operator >  (const fixed_int<Bits>& a, const fixed_int<Bits>& b) { return Compare(a, b) >  0; }
+template <int Bits> bool operator >= (const fixed_int<Bits>& a, const fixed_int<Bits>& b) { return Compare(a, b) >= 0; }
+
+
+/*
+Binary floating-point number with a mantissa of 'Bits' bits, stored inline without heap allocation:
+the value is m * 2^e with a normalized mantissa 'm' (leading bit set) of type fixed_int<Bits>.
+All operations are rounded to nearest (quotients may be truncated), so their relative error is below 2^(1-Bits).
+The exponent is a plain integer without overflow checks (the fast computer bounds all values).
+*/
+template <int Bits>
+class fixed_float
+{
+
+    public:
+
+        static_assert(Bits >= 64, "number of bits for fixed_float must be at least 64");
+
+        static const int limbs = fixed_int<Bits>::limbs;
+
+        fixed_float() = default;
+
+        fixed_float(double x)
+        {
+            if (x != 0.0)
+            {
+                int k = 0;
+                auto f = std::frexp(std::abs(x), &k);
+                auto u = static_cast<std::uint64_t>(std::ldexp(f, 64));
+
+                m_.Data()[limbs - 1] = static_cast<std::uint32_t>(u >> 32);
+                m_.Data()[limbs - 2] = static_cast<std::uint32_t>(u);
+                m_.SetNegative(x < 0.0);
+                e_ = k - Bits;
+            }
+        }
+
+        fixed_float(int x) :
+            fixed_float( static_cast<double>(x) )
+        {
+        }
+
+        //! Converts an integer, which is rounded if it has more than 'Bits' significant bits.
+        template <int IntBits>
+        explicit fixed_float(const fixed_int<IntBits>& x)
+        {
+            /* Pad the integer, so that it has at least as many limbs as the mantissa */
+            std::uint32_t w[fixed_int<IntBits>::limbs + limbs];
+            for (int i = 0; i < fixed_int<IntBits>::limbs + limbs; ++i)
+                w[i] = (i < fixed_int<IntBits>::limbs ? x.Data()[i] : 0);
+            *this = Pack(w, 0, x.IsNegative());
+        }
+
+        bool IsZero() const
+        {
+            return m_.IsZero();
+        }
+
+        bool IsNegative() const
+        {
+            return m_.IsNegative();
+        }
+
+        //! Returns the binary exponent of the leading bit, i.e. 2^Exponent() <= |x| < 2^(Exponent() + 1).
+        int Exponent() const
+        {
+            return e_ + Bits - 1;
+        }
+
+        double ToDouble() const
+        {
+            if (IsZero())
+                return 0.0;
+
+            auto u = (static_cast<std::uint64_t>(m_.Data()[limbs - 1]) << 32) | m_.Data()[limbs - 2];
+
+            auto x = std::ldexp(static_cast<double>(u), e_ + Bits - 64);
+            return (IsNegative() ? -x : x);
+        }
+
+        //! Returns the integral part (rounded toward zero), which must fit into 'IntBits'.
+        template <int IntBits>
+        fixed_int<IntBits> ToInt() const
+        {
+            fixed_int<IntBits> r;
+
+            if (e_ < 0 && e_ > -Bits)
+            {
+                auto m = m_;
+                LimbShiftRight<limbs>(m.Data(), -e_);
+                for (int i = 0; i < limbs && i < fixed_int<IntBits>::limbs; ++i)
+                    r.Data()[i] = m.Data()[i];
+            }
+            else if (e_ >= 0)
+            {
+                for (int i = 0; i < limbs && i < fixed_int<IntBits>::limbs; ++i)
+                    r.Data()[i] = m_.Data()[i];
+                r <<= e_;
+            }
+
+            r.SetNegative(IsNegative());
+            return r;
+        }
+
+        fixed_float operator - () const
+        {
+            auto r = *this;
+            r.m_ = -m_;
+            return r;
+        }
+
+        fixed_float& operator += (const fixed_float& rhs)
+        {
+            return (*this = *this + rhs);
+        }
+
+        fixed_float& operator -= (const fixed_float& rhs)
+        {
+            return (*this = *this - rhs);
+        }
+
+        fixed_float& operator *= (const fixed_float& rhs)
+        {
+            return (*this = *this * rhs);
+        }
+
+        fixed_float& operator /= (const fixed_float& rhs)
+        {
+            return (*this = *this / rhs);
+        }
+
+        friend fixed_float operator + (const fixed_float& a, const fixed_float& b)
+        {
+            if (a.IsZero())
+                return b;
+            if (b.IsZero())
+                return a;
+
+            /* Let 'x' be the operand with the larger magnitude */
+            const bool swap = (a.e_ < b.e_ || (a.e_ == b.e_ && a.m_.CompareMagnitude(b.m_) < 0));
+            const auto& x = (swap ? b : a);
+            const auto& y = (swap ? a : b);
+
+            /* Align mantissas with two guard limbs and one limb for the carry */
+            std::uint32_t wx[limbs + 3], wy[limbs + 3];
+            wx[0] = wx[1] = wy[0] = wy[1] = 0;
+            wx[limbs + 2] = wy[limbs + 2] = 0;
+
+            for (int i = 0; i < limbs; ++i)
+            {
+                wx[i + 2] = x.m_.Data()[i];
+                wy[i + 2] = y.m_.Data()[i];
+            }
+
+            bool sticky = LimbShiftRight<limbs + 3>(wy, x.e_ - y.e_);
+
+            if (x.IsNegative() == y.IsNegative())
+                LimbAdd<limbs + 3>(wx, wx, wy);
+            else
+            {
+                /* Truncated bits of 'y' lie strictly between the last guard bit and zero */
+                LimbSub<limbs + 3>(wx, wx, wy);
+                if (sticky)
+                    LimbSubSmall<limbs + 3>(wx, 1);
+            }
+
+            return Pack(wx, x.e_ - 64, x.IsNegative());
+        }
+
+        friend fixed_float operator - (const fixed_float& a, const fixed_float& b)
+        {
+            return a + (-b);
+        }
+
+        friend fixed_float operator * (const fixed_float& a, const fixed_float& b)
+        {
+            if (a.IsZero() || b.IsZero())
+                return fixed_float();
+
+            std::uint32_t w[2*limbs];
+            LimbMul<limbs, limbs>(w, a.m_.Data(), b.m_.Data());
+
+            return Pack(w, a.e_ + b.e_, a.IsNegative() != b.IsNegative());
+        }
+
+        friend fixed_float operator / (const fixed_float& a, const fixed_float& b)
+        {
+            if (b.IsZero())
+                throw std::runtime_error("math error: division by zero");
+            if (a.IsZero())
+                return fixed_float();
+
+            /* (m_a * 2^Bits) / m_b has Bits or Bits + 1 significant bits, the remainder is truncated */
+            std::uint32_t u[2*limbs], q[limbs + 1], r[limbs];
+            for (int i = 0; i < limbs; ++i)
+            {
+                u[i] = 0;
+                u[limbs + i] = a.m_.Data()[i];
+            }
+
+            LimbDivMod<2*limbs, limbs>(q, r, u, b.m_.Data());
+
+            return Pack(q, a.e_ - b.e_ - Bits, a.IsNegative() != b.IsNegative());
+        }
+
+        //! Division by a double, which is fast for small integers (like the denominators of Taylor series).
+        friend fixed_float operator / (const fixed_float& a, double b)
+        {
+            if (b >= 1.0 && b < 4294967296.0 && std::floor(b) == b)
+            {
+                if (a.IsZero())
+                    return fixed_float();
+
+                std::uint32_t w[limbs + 1];
+                w[0] = 0;
+                for (int i = 0; i < limbs; ++i)
+                    w[i + 1] = a.m_.Data()[i];
+
+                LimbDivSmall<limbs + 1>(w, static_cast<std::uint32_t>(b));
+
+                return Pack(w, a.e_ - 32, a.IsNegative());
+            }
+            return a / fixed_float(b);
+        }
+
+        friend int Compare(const fixed_float& a, const fixed_float& b)
+        {
+            const int sa = (a.IsZero() ? 0 : (a.IsNegative() ? -1 : 1));
+            const int sb = (b.IsZero() ? 0 : (b.IsNegative() ? -1 : 1));
+
+            if (sa != sb || sa == 0)
+                return (sa < sb ? -1 : (sa > sb ? 1 : 0));
+
+            /* Both mantissas are normalized, so the exponents are compared first */
+            int c = (a.e_ != b.e_ ? (a.e_ < b.e_ ? -1 : 1) : a.m_.CompareMagnitude(b.m_));
+            return (sa < 0 ? -c : c);
+        }
+
+        friend fixed_float ldexp(const fixed_float& x, int e)
+        {
+            auto r = x;
+            if (!r.IsZero())
+                r.e_ += e;
+            return r;
+        }
+
+        friend fixed_float floor(const fixed_float& x)
+        {
+            if (x.IsZero() || x.e_ >= 0)
+                return x;
+
+            if (x.e_ <= -Bits)
+                return (x.IsNegative() ? fixed_float(-1) : fixed_float());
+
+            /* Clear fractional bits */
+            auto r = x;
+            const int n = -x.e_;
+            bool frac = false;
+
+            for (int i = 0; i < limbs && i*32 < n; ++i)
+            {
+                auto mask = (n - i*32 >= 32 ? 0xFFFFFFFFu : (1u << (n - i*32)) - 1u);
+                frac = frac || ((r.m_.Data()[i] & mask) != 0);
+                r.m_.Data()[i] &= ~mask;
+            }
+
+            return (x.IsNegative() && frac ? r - fixed_float(1) : r);
+        }
+
+    private:
+
+        // Rounds the unsigned integer 'w' to 'Bits' bits and returns w * 2^e with the specified sign.
+        template <int M>
+        static fixed_float Pack(std::uint32_t (&w)[M], int e, bool neg)
+        {
+            fixed_float r;
+
+            const int n = LimbBitLength<M>(w);
+            if (n == 0)
+                return r;
+
+            int s = n - Bits;
+
+            if (s > 0)
+            {
+                /* Round to nearest with the first bit shifted out */
+                LimbShiftRight<M>(w, s - 1);
+                const bool half = ((w[0] & 1u) != 0);
+                LimbShiftRight<M>(w, 1);
+
+                if (half && LimbAddSmall<limbs>(w, 1) != 0)
+                {
+                    /* Mantissa overflowed to 2^Bits */
+                    w[limbs - 1] = 0x80000000u;
+                    ++s;
+                }
+            }
+            else if (s < 0)
+                LimbShiftLeft<M>(w, -s);
+
+            for (int i = 0; i < limbs; ++i)
+                r.m_.Data()[i] = w[i];
+
+            r.m_.SetNegative(neg);
+            r.e_ = e + s;
+
+            return r;
+        }
+
+        fixed_int<Bits> m_;
+        int             e_  = 0;
+
+};
+
+template <int Bits> bool operator == (const fixed_float<Bits>& a, const fixed_float<Bits>& b) { return Compare(a, b) == 0; }
+template <int Bits> bool operator != (const fixed_float<Bits>& a, const fixed_float<Bits>& b) { return Compare(a, b) != 0; }
+template <int Bits> bool operator <  (const fixed_float<Bits>& a, const fixed_float<Bits>& b) { return Compare(a, b) <  0; }
+template <int Bits> bool operator <= (const fixed_float<Bits>& a, const fixed_float<Bits>& b) { return Compare(a, b) <= 0; }
+template <int Bits> bool operator >  (const fixed_float<Bits>& a, const fixed_float<Bits>& b) { return Compare(a, b) >  0; }
+template <int Bits> bool operator >= (const fixed_float<Bits>& a, const fixed_float<Bits>& b) { return Compare(a, b) >= 0; }
+
+/* --- Rounding --- */
+
+template <int Bits>
+fixed_float<Bits> ceil(const fixed_float<Bits>& x)
+{
+    return -floor(-x);
+}
+
+template <int Bits>
+fixed_float<Bits> fmod(const fixed_float<Bits>& x, const fixed_float<Bits>& y)
+{
+    auto q = x / y;
+    return x - y * (q < fixed_float<Bits>(0) ? ceil(q) : floor(q));
+}
+
+/* --- Elementary functions --- */
+
+template <int Bits> fixed_float<Bits> sqrt (const fixed_float<Bits>& x) { return FastSqrt(x);  }
+template <int Bits> fixed_float<Bits> exp  (const fixed_float<Bits>& x) { return FastExp(x);   }
+template <int Bits> fixed_float<Bits> log  (const fixed_float<Bits>& x) { return FastLog(x);   }
+template <int Bits> fixed_float<Bits> log10(const fixed_float<Bits>& x) { return FastLog10(x); }
+template <int Bits> fixed_float<Bits> sin  (const fixed_float<Bits>& x) { return FastSin(x);   }
+template <int Bits> fixed_float<Bits> cos  (const fixed_float<Bits>& x) { return FastCos(x);   }
+template <int Bits> fixed_float<Bits> tan  (const fixed_float<Bits>& x) { return FastTan(x);   }
+template <int Bits> fixed_float<Bits> asin (const fixed_float<Bits>& x) { return FastAsin(x);  }
+template <int Bits> fixed_float<Bits> acos (const fixed_float<Bits>& x) { return FastAcos(x);  }
+template <int Bits> fixed_float<Bits> atan (const fixed_float<Bits>& x) { return FastAtan(x);  }
+template <int Bits> fixed_float<Bits> sinh (const fixed_float<Bits>& x) { return FastSinh(x);  }
+template <int Bits> fixed_float<Bits> cosh (const fixed_float<Bits>& x) { return FastCosh(x);  }
+template <int Bits> fixed_float<Bits> tanh (const fixed_float<Bits>& x) { return FastTanh(x);  }
+template <int Bits> fixed_float<Bits> asinh(const fixed_float<Bits>& x) { return FastAsinh(x); }
+template <int Bits> fixed_float<Bits> acosh(const fixed_float<Bits>& x) { return FastAcosh(x); }
+template <int Bits> fixed_float<Bits> atanh(const fixed_float<Bits>& x) { return FastAtanh(x); }
+
+template <int Bits> fixed_float<Bits> atan2(const fixed_float<Bits>& y, const fixed_float<Bits>& x) { return FastAtan2(y, x); }
+template <int Bits> fixed_float<Bits> pow  (const fixed_float<Bits>& x, const fixed_float<Bits>& y) { return FastPow(x, y);   }
+
+
+/* --- Traits --- */
+
+template <int Bits>
+struct FastTraits< fixed_float<Bits> >
+{
+    using T = fixed_float<Bits>;
+
+    //! Returns the maximal number of decimal digits which can be certified (64 for 256 bits, 141 for 512 bits).
+    static unsigned int Digits()
+    {
+        return static_cast<unsigned int>((Bits - 8) * 0.30103) - 10;
+    }
+
+    //! Returns a bound of the relative error of the arithmetic operations, with a margin of 7 bits over the rounding error.
+    static double Unit()
+    {
+        return std::ldexp(1.0, 8 - Bits);
+    }
+
+    //! Returns the maximal error of the elementary functions (in units of 'Unit').
+    static double FuncUlps()
+    {
+        return 4.0;
+    }
+
+    //! Returns the maximal relative error of a parsed literal.
+    static double ParseError()
+    {
+        return 64.0 * Unit();
+    }
+
+    //! Integers up to this magnitude fit into the mantissa, so they stay exact in all operations.
+    static double MaxInt()
+    {
+        return std::ldexp(1.0, Bits - 4);
+    }
+
+    static bool Parse(const std::string& s, T& x)
+    {
+        const int maxDigits = static_cast<int>(Digits()) + 20, chunkDigits = 9;
+
+        std::size_t i = 0, n = s.size();
+        bool isNeg = false;
+
+        if (i < n && (s[i] == '-' || s[i] == '+'))
+            isNeg = (s[i++] == '-');
+
+        /* Accumulate mantissa in chunks of 9 digits, which is exact while it fits into the mantissa */
+        int numDigits = 0, exponent = 0, chunkLen = 0;
+        std::uint32_t chunk = 0;
+        bool hasDigits = false, hasPoint = false;
+        x = T(0);
+
+        for (; i < n; ++i)
+        {
+            char c = s[i];
+            if (c == '.' && !hasPoint)
+                hasPoint = true;
+            else if (c >= '0' && c <= '9')
+            {
+                hasDigits = true;
+                if (numDigits == 0 && c == '0')
+                {
+                    if (hasPoint)
+                        --exponent;
+                }
+                else if (numDigits < maxDigits)
+                {
+                    chunk = chunk * 10 + static_cast<std::uint32_t>(c - '0');
+                    ++numDigits;
+                    if (hasPoint)
+                        --exponent;
+                    if (++chunkLen == chunkDigits)
+                    {
+                        x = x * T(1e9) + T(static_cast<double>(chunk));
+                        chunk = 0;
+                        chunkLen = 0;
+                    }
+                }
+                else if (!hasPoint)
+                    ++exponent;
+            }
+            else
+                break;
+        }
+
+        if (chunkLen > 0)
+            x = x * T(std::pow(10.0, chunkLen)) + T(static_cast<double>(chunk));
+
+        if (!hasDigits)
+            return false;
+
+        /* Decimal exponent */
+        if (i < n && (s[i] == 'E' || s[i] == 'e'))
+        {
+            char* end = nullptr;
+            long e = std::strtol(s.c_str() + i + 1, &end, 10);
+            if (end == s.c_str() + i + 1 || *end != '\0' || e > 400 || e < -400)
+                return false;
+            exponent += static_cast<int>(e);
+        }
+        else if (i < n)
+            return false;
+
+        if (exponent > 400 || exponent < -400)
+            return false;
+
+        if (exponent > 0)
+            x = x * PowerOfTen(exponent);
+        else if (exponent < 0)
+            x = x / PowerOfTen(-exponent);
+
+        if (isNeg)
+            x = -x;
+
+        return true;
+    }
+
+    static double ToDouble(const T& x)
+    {
+        return x.ToDouble();
+    }
+
+    static float_precision ToFloat(const T& x, unsigned int digits)
+    {
+        if (x.IsZero())
+            return float_precision(0, digits, ROUND_NEAR);
+
+        /* Scale to an integer with 'digits' decimal digits, which must fit into the mantissa */
+        const int maxDigits = static_cast<int>((Bits - 2) * 0.30103);
+        const int n = std::min(static_cast<int>(digits), maxDigits);
+        const int k = n - 1 - static_cast<int>(std::floor(std::log10(std::abs(x.ToDouble()))));
+
+        auto y = (x.IsNegative() ? -x : x);
+        if (k > 0)
+            y = y * PowerOfTen(k);
+        else if (k < 0)
+            y = y / PowerOfTen(-k);
+
+        auto m = floor(y + T(0.5)).template ToInt<Bits>();
+
+        auto s = (x.IsNegative() ? "-" : "") + m.ToString() + "E" + std::to_string(-k);
+        return float_precision(s.c_str(), digits, ROUND_NEAR);
+    }
+
+    static int_precision ToInt(const T& x)
+    {
+        return x.template ToInt<Bits>().ToIntPrecision();
+    }
+
+    static T Pi()
+    {
+        static const T pi = Constant(
+            "3.1415926535897932384626433832795028841971693993751058209749445923078164062862089986280348253421170679"
+            "821480865132823066470938446095505822317253594081284811174502841027019"
+        );
+        return pi;
+    }
+
+    static T Ln2()
+    {
+        static const T ln2 = Constant(
+            "0.6931471805599453094172321214581765680755001343602552541206800094933936219696947156058633269964186875"
+            "4200148102057068573368552023575813055703267075163507596193072757082837"
+        );
+        return ln2;
+    }
+
+    static T Ln10()
+    {
+        static const T ln10 = Constant(
+            "2.3025850929940456840179914546843642076011014886287729760333279009675726096773524802359972050895982983"
+            "419677840422862486334095254650828067566662873690987816894829072083256"
+        );
+        return ln10;
+    }
+
+    private:
+
+        // Returns 10^e by squaring, which is exact while 5^e fits into the mantissa.
+        static T PowerOfTen(int e)
+        {
+            T p(1), b(10);
+            for (; e > 0; e >>= 1)
+            {
+                if (e & 1)
+                    p *= b;
+                if (e > 1)
+                    b *= b;
+            }
+            return p;
+        }
+
+        static T Constant(const char* s)
+        {
+            T x;
+            Parse(s, x);
+            return x;
+        }
+};
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,167 @@
+/*
+ * Functions.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Abacus/Functions.h>
+
+#include "ByteCode.h"
+
+#include <deque>
+#include <mutex>
+
+
+namespace Ac
+{
+
+
+struct BuiltinFunction
+{
+    const char* name;
+    int         numParams;
+    bool        pure;
+};
+
+// Built-in functions in the order of their IDs (see enum class Function).
+static const BuiltinFunction builtinFunctions[] =
+{
+    { "sin",         1, true  },
+    { "cos",         1, true  },
+    { "tan",         1, true  },
+    { "sincos",      1, true  },
+    { "sinh",        1, true  },
+    { "cosh",        1, true  },
+    { "tanh",        1, true  },
+    { "asin",        1, true  },
+    { "acos",        1, true  },
+    { "atan",        1, true  },
+    { "atan2",       2, true  },
+    { "asinh",       1, true  },
+    { "acosh",       1, true  },
+    { "atanh",       1, true  },
+    { "pow",         2, true  },
+    { "sqrt",        1, true  },
+    { "exp",         1, true  },
+    { "log",         1, true  },
+    { "log10",       1, true  },
+    { "abs",         1, true  },
+    { "re",          1, true  },
+    { "im",          1, true  },
+    { "arg",         1, true  },
+    { "conj",        1, true  },
+    { "ceil",        1, true  },
+    { "floor",       1, true  },
+    { "sign",        1, true  },
+    { "rand",        0, false },
+    { "min",        -1, true  },
+    { "max",        -1, true  },
+    { "norm",        1, true  },
+    { "dot",         2, true  },
+    { "cross",       2, true  },
+    { "normalize",   1, true  },
+    { "matmul",      2, true  },
+    { "transpose",   1, true  },
+    { "det",         1, true  },
+    { "inv",         1, true  },
+    { "solve",       2, true  },
+};
+
+/*
+Registry of all functions. The descriptors keep their addresses while the registry grows,
+so the parser can resolve each function call to its descriptor only once.
+*/
+class FunctionRegistry
+{
+
+    public:
+
+        FunctionRegistry()
+        {
+            for (const auto& entry : builtinFunctions)
+                Add(entry.name, entry.numParams, entry.pure);
+        }
+
+        FunctionDesc& Add(const std::string& name, int numParams, bool pure)
+        {
+            FunctionDesc desc;
+            {
+                desc.name       = name;
+                desc.symbol     = InternSymbol(name);
+                desc.id         = static_cast<FunctionID>(functions_.size());
+                desc.numParams  = numParams;
+                desc.pure       = pure;
+            }
+            functions_.push_back(std::move(desc));
+
+            /* Index descriptor by its symbol */
+            auto& entry = functions_.back();
+            if (entry.symbol >= bySymbol_.size())
+                bySymbol_.resize(entry.symbol + 1, nullptr);
+            bySymbol_[entry.symbol] = &entry;
+
+            return entry;
+        }
+
+        const FunctionDesc* Find(Symbol symbol) const
+        {
+            return (symbol < bySymbol_.size() ? bySymbol_[symbol] : nullptr);
+        }
+
+        std::mutex& Mutex()
+        {
+            return mutex_;
+        }
+
+    private:
+
+        std::mutex                          mutex_;
+        std::deque<FunctionDesc>            functions_;
+        std::vector<const FunctionDesc*>    bySymbol_;
+
+};
+
+static FunctionRegistry& GetRegistry()
+{
+    static FunctionRegistry registry;
+    return registry;
+}
+
+AC_EXPORT bool RegisterFunction(const std::string& name, int numParams, const NativeFunction& impl, bool pure)
+{
+    if (!impl || !IsIdentifier(name) || numParams < -1)
+        return false;
+
+    auto symbol = InternSymbol(name);
+
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.Mutex());
+
+    if (registry.Find(symbol))
+        return false;
+
+    registry.Add(name, numParams, pure).impl = impl;
+
+    return true;
+}
+
+AC_EXPORT const FunctionDesc* FindFunction(Symbol symbol)
+{
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.Mutex());
+    return registry.Find(symbol);
+}
+
+AC_EXPORT const FunctionDesc* FindFunction(const std::string& name)
+{
+    Symbol symbol = 0;
+    return (FindSymbol(name, symbol) ? FindFunction(symbol) : nullptr);
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
@@ -0,0 +1,1373 @@
+/*
+ * Interval.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "Interval.h"
+#include "Variable.h"
+#include "ConstantValue.h"
+#include "IntervalKernels.h"
+#include "PrecisionUtils.h"
+
+#include <Abacus/Visitor.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <stack>
+#include <vector>
+
+
+namespace Ac
+{
+
+
+static void Error(const std::string& msg)
+{
+    throw std::runtime_error("math error: " + msg);
+}
+
+
+/* --- Bounds ---
+Interval bounds are float_precision values with a few guard digits, which are rounded down (lower bounds) or up (upper bounds).
+Sums and products of bounds are exact before their final rounding, so they only need the directed rounding modes.
+Quotients and elementary functions are not correctly rounded in precpkg, so they are computed with extra digits,
+and their bounds are widened by an error bound in units of the last place of the bounds.
+*/
+
+// Number of guard digits of the interval bounds.
+static const unsigned int guardDigits = 4;
+
+// Number of extra digits with which quotients and elementary functions are computed.
+static const unsigned int funcDigits = 2;
+
+// Decimal exponent of the error bound of elementary functions in units of the last place (i.e. 100 ulps).
+static const int funcErrorExp = 2;
+
+static bool IsNonNegative(const float_precision& x)
+{
+    return (x.sign() > 0 || IsZero(x));
+}
+
+static bool IsNonPositive(const float_precision& x)
+{
+    return (x.sign() < 0 || IsZero(x));
+}
+
+static bool IsInteger(const float_precision& x)
+{
+    return (floor(x) == x);
+}
+
+// Returns the decimal exponent of the magnitude of x, or 0 if x is zero.
+static int Exp(const float_precision& x)
+{
+    return (IsZero(x) ? 0 : x.exponent());
+}
+
+// Returns the decimal exponent of the distance between |x| and 1, which bounds the conditioning of functions with singularities at 1.
+static int UnitDistExp(const float_precision& x)
+{
+    auto d = abs(x);
+    d -= float_precision(1);
+    return Exp(d);
+}
+
+static int Sign(const float_precision& x)
+{
+    return (IsZero(x) ? 0 : x.sign());
+}
+
+static float_precision PowerOfTen(int e)
+{
+    return float_precision(("1E" + std::to_string(e)).c_str(), 1, ROUND_NEAR);
+}
+
+static bool IsPoint(const RealInterval& x)
+{
+    return (x.lower == x.upper);
+}
+
+
+/* --- Interval computer --- */
+
+class IntervalComputer : private Visitor
+{
+
+    public:
+
+        IntervalComputer(unsigned int prec) :
+            prec_( prec )
+        {
+        }
+
+        RealInterval Compute(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet)
+        {
+            mode_           = mode;
+            constantsSet_   = &constantsSet;
+
+            Visit(ast);
+            return Pop();
+        }
+
+    private:
+
+        /* --- Visitor --- */
+
+        void VisitUnaryExpr(UnaryExpr* ast, void*) override
+        {
+            Visit(ast->expr);
+            auto a = Pop();
+
+            using Op = UnaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Keep:
+                    Push(a);
+                    break;
+                case Op::Negate:
+                    Push(Neg(a));
+                    break;
+                case Op::Factorial:
+                    Push(ExactIntOp(a, a, "!", [](Variable& x, Variable&) { x.Factorial(); }));
+                    break;
+                case Op::Norm:
+                    Push(Abs(a));
+                    break;
+                default:
+                    Error("unknown unary operator");
+                    break;
+            }
+        }
+
+        void VisitBinaryExpr(BinaryExpr* ast, void*) override
+        {
+            Visit(ast->exprL);
+            auto a = Pop();
+
+            Visit(ast->exprR);
+            auto b = Pop();
+
+            using Op = BinaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Add:
+                    Push(Add(a, b));
+                    break;
+                case Op::Sub:
+                    Push(Add(a, Neg(b)));
+                    break;
+                case Op::Mul:
+                    Push(Mul(a, b));
+                    break;
+                case Op::Div:
+                    Push(Div(a, b));
+                    break;
+                case Op::Pow:
+                    Push(Pow(a, b));
+                    break;
+                case Op::IntDiv:
+                    Push(ExactIntOp(a, b, "div", [](Variable& x, Variable& y) { x.IntDiv(y); }));
+                    break;
+                case Op::Mod:
+                    Push(ExactIntOp(a, b, "mod", [](Variable& x, Variable& y) { x.Mod(y); }));
+                    break;
+                case Op::LShift:
+                    Push(ExactIntOp(a, b, "<<", [](Variable& x, Variable& y) { x.LShift(y); }));
+                    break;
+                case Op::RShift:
+                    Push(ExactIntOp(a, b, ">>", [](Variable& x, Variable& y) { x.RShift(y); }));
+                    break;
+                default:
+                    Error("unknown binary operator");
+                    break;
+            }
+        }
+
+        void VisitLiteralExpr(LiteralExpr* ast, void*) override
+        {
+            Push(Decimal(ast->value));
+        }
+
+        void VisitIdentExpr(IdentExpr* ast, void*) override
+        {
+            /* Fold indices hide all constants */
+            auto idx = indices_.find(ast->value);
+            if (idx != indices_.end())
+            {
+                Push(Int(idx->second));
+                return;
+            }
+
+            auto value = constantsSet_->Find(ast->symbol);
+            if (!value)
+            {
+                if (ast->value == "i")
+                    Error("complex numbers are not supported in interval mode");
+                Error("undefined constant '" + ast->value + "'");
+            }
+
+            if (value->Get().IsComplex())
+                Error("complex numbers are not supported in interval mode");
+            if (!value->Get().IsScalar())
+                Error("vectors are not supported in interval mode");
+
+            /* Standard constants are the exact numbers, not their stored digits */
+            if (IsStdConst(ast->value, *value))
+            {
+                if (ast->value == "pi")
+                    Push(Pi());
+                else
+                    Push(ExpFunc(Int(1)));
+            }
+            else if (value->Get().IsRational())
+                Push(Div(Int(value->Get().GetInt()), Int(value->Get().GetDenom())));
+            else
+                Push(Decimal(value->Literal()));
+        }
+
+        void VisitFuncExpr(FuncExpr* ast, void*) override
+        {
+            const auto& f = ast->name;
+
+            auto Arg = [&](std::size_t i) -> RealInterval
+            {
+                if (i >= ast->args.size())
+                    Error("too few arguments for function '" + f + "'");
+                Visit(ast->args[i]);
+                return Pop();
+            };
+
+            auto ArgCount = [&](std::size_t n)
+            {
+                if (ast->args.size() != n)
+                    Error("function '" + f + "' requires exactly " + std::to_string(n) + " argument(s)");
+            };
+
+            auto Deg2Rad = [&](const RealInterval& x) -> RealInterval
+            {
+                return (mode_.degree ? Mul(x, Div(Pi(), Int(180))) : x);
+            };
+
+            auto Rad2Deg = [&](const RealInterval& x) -> RealInterval
+            {
+                return (mode_.degree ? Mul(x, Div(Int(180), Pi())) : x);
+            };
+
+            if (f == "sin" || f == "cos")
+            {
+                ArgCount(1);
+                Push(SinCos(Deg2Rad(Arg(0)), f == "cos"));
+            }
+            else if (f == "tan")
+            {
+                ArgCount(1);
+                Push(Tan(Deg2Rad(Arg(0))));
+            }
+            else if (f == "sinh" || f == "tanh")
+            {
+                ArgCount(1);
+                auto func = [&f](const float_precision& x) { return (f == "sinh" ? sinh(x) : tanh(x)); };
+                Push(Monotonic(Arg(0), true, func, [](const float_precision& x, const float_precision& y) {
+                    return std::max(Exp(y), 0) + std::max(Exp(x), 0);
+                }));
+            }
+            else if (f == "cosh")
+            {
+                ArgCount(1);
+                Push(Cosh(Arg(0)));
+            }
+            else if (f == "asin" || f == "acos")
+            {
+                ArgCount(1);
+
+                auto x = Arg(0);
+                if (x.lower < float_precision(-1) || x.upper > float_precision(1))
+                    throw float_precision::domain_error();
+
+                auto func = [&f](const float_precision& x) { return (f == "asin" ? asin(x) : acos(x)); };
+                Push(Rad2Deg(Monotonic(x, f == "asin", func, [](const float_precision& x, const float_precision& y) {
+                    return std::max(Exp(y), 0) + std::max(-UnitDistExp(x), 0);
+                })));
+            }
+            else if (f == "atan")
+            {
+                ArgCount(1);
+                Push(Rad2Deg(Monotonic(Arg(0), true, [](const float_precision& x) { return atan(x); }, RelativeError)));
+            }
+            else if (f == "asinh")
+            {
+                ArgCount(1);
+                Push(Monotonic(Arg(0), true, [](const float_precision& x) { return asinh(x); }, AbsoluteError));
+            }
+            else if (f == "acosh")
+            {
+                ArgCount(1);
+
+                auto x = Arg(0);
+                if (x.lower < float_precision(1))
+                    throw float_precision::domain_error();
+
+                Push(Monotonic(x, true, [](const float_precision& x) { return acosh(x); }, [](const float_precision& x, const float_precision& y) {
+                    return std::max(Exp(y), 0) + std::max(-UnitDistExp(x), 0);
+                }));
+            }
+            else if (f == "atanh")
+            {
+                ArgCount(1);
+
+                auto x = Arg(0);
+                if (x.lower <= float_precision(-1) || x.upper >= float_precision(1))
+                    throw float_precision::domain_error();
+
+                Push(Monotonic(x, true, [](const float_precision& x) { return atanh(x); }, [](const float_precision& x, const float_precision& y) {
+                    return std::max(Exp(y), 0) + std::max(-UnitDistExp(x), 0);
+                }));
+            }
+            else if (f == "pow")
+            {
+                ArgCount(2);
+                auto x = Arg(0);
+                Push(Pow(x, Arg(1)));
+            }
+            else if (f == "sqrt")
+            {
+                ArgCount(1);
+
+                auto x = Arg(0);
+                if (!IsNonNegative(x.lower))
+                    throw float_precision::domain_error();
+
+                Push(Monotonic(x, true, [](const float_precision& x) { return sqrt(x); }, RelativeError));
+            }
+            else if (f == "exp")
+            {
+                ArgCount(1);
+                Push(ExpFunc(Arg(0)));
+            }
+            else if (f == "log")
+            {
+                ArgCount(1);
+                Push(Log(Arg(0)));
+            }
+            else if (f == "log10")
+            {
+                ArgCount(1);
+                Push(Div(Log(Arg(0)), Log(Int(10))));
+            }
+            else if (f == "abs")
+            {
+                ArgCount(1);
+                Push(Abs(Arg(0)));
+            }
+            else if (f == "ceil" || f == "floor")
+            {
+                ArgCount(1);
+
+                /* Rounding to integers is monotonic and exact */
+                auto x = Arg(0);
+                if (f == "ceil")
+                    Push({ Down(ceil(x.lower)), Up(ceil(x.upper)) });
+                else
+                    Push({ Down(floor(x.lower)), Up(floor(x.upper)) });
+            }
+            else if (f == "sign")
+            {
+                ArgCount(1);
+                auto x = Arg(0);
+                Push({ Int(Sign(x.lower)).lower, Int(Sign(x.upper)).upper });
+            }
+            else if (f == "min" || f == "max")
+            {
+                if (ast->args.empty())
+                    Error("function '" + f + "' requires at least 1 argument");
+
+                /* Both bounds are monotonic in all arguments */
+                auto result = Arg(0);
+                for (std::size_t i = 1; i < ast->args.size(); ++i)
+                {
+                    auto x = Arg(i);
+                    if (f == "min")
+                    {
+                        result.lower = std::min(result.lower, x.lower);
+                        result.upper = std::min(result.upper, x.upper);
+                    }
+                    else
+                    {
+                        result.lower = std::max(result.lower, x.lower);
+                        result.upper = std::max(result.upper, x.upper);
+                    }
+                }
+
+                Push(result);
+            }
+            else
+                Error("function '" + f + "' is not supported in interval mode");
+        }
+
+        void VisitFoldExpr(FoldExpr* ast, void*) override
+        {
+            /* Index range must be exact integers */
+            Visit(ast->initExpr);
+            auto idx = ExactInt(Pop(), "fold function '" + ast->func + "' can only have discrete iterations");
+
+            Visit(ast->iterExpr);
+            auto idxEnd = ExactInt(Pop(), "fold function '" + ast->func + "' can only have discrete iterations");
+
+            if (indices_.find(ast->index) != indices_.end() || constantsSet_->Contains(ast->indexSymbol))
+                Error("index variable '" + ast->index + "' already defined in this scope");
+
+            const bool isSum = (ast->func == "sum");
+
+            auto result = Int(isSum ? 0 : 1);
+
+            for (; idx <= idxEnd; ++idx)
+            {
+                indices_[ast->index] = idx;
+
+                Visit(ast->loopExpr);
+                auto term = Pop();
+
+                result = (isSum ? Add(result, term) : Mul(result, term));
+            }
+
+            indices_.erase(ast->index);
+
+            Push(result);
+        }
+
+        void VisitVectorExpr(VectorExpr*, void*) override
+        {
+            Error("vectors are not supported in interval mode");
+        }
+
+        void VisitDefExpr(DefExpr*, void*) override
+        {
+            Error("definitions are not supported in interval mode");
+        }
+
+        /* --- Bounds --- */
+
+        // Returns x rounded down to the precision of the bounds.
+        float_precision Down(const float_precision& x) const
+        {
+            float_precision y(0, prec_, ROUND_DOWN);
+            y = x;
+            return y;
+        }
+
+        // Returns x rounded up to the precision of the bounds.
+        float_precision Up(const float_precision& x) const
+        {
+            float_precision y(0, prec_, ROUND_UP);
+            y = x;
+            return y;
+        }
+
+        // Returns x with the extra digits for quotients and elementary functions.
+        float_precision Extended(const float_precision& x) const
+        {
+            float_precision y(0, prec_ + funcDigits, ROUND_NEAR);
+            y = x;
+            return y;
+        }
+
+        // Returns an interval which contains all values within 10^e of x.
+        RealInterval Enclose(const float_precision& x, int e) const
+        {
+            const auto err = PowerOfTen(e);
+
+            auto lo = Down(x);
+            lo -= err;
+
+            auto hi = Up(x);
+            hi += err;
+
+            return { lo, hi };
+        }
+
+        // Returns the decimal exponent of the error bound of a function value with the magnitude 10^m.
+        int FuncErrorExp(int m) const
+        {
+            return m - static_cast<int>(prec_) + 1 + funcErrorExp;
+        }
+
+        /* --- Arithmetic --- */
+
+        RealInterval Int(const int_precision& n) const
+        {
+            return { float_precision(n, prec_, ROUND_DOWN), float_precision(n, prec_, ROUND_UP) };
+        }
+
+        RealInterval Int(int n) const
+        {
+            return Int(int_precision(n));
+        }
+
+        // Returns the enclosure of the decimal number (e.g. "-1.25E-3"), which is a point if it fits into the bounds.
+        RealInterval Decimal(const std::string& s) const
+        {
+            return { float_precision(s.c_str(), prec_, ROUND_DOWN), float_precision(s.c_str(), prec_, ROUND_UP) };
+        }
+
+        static RealInterval Neg(const RealInterval& a)
+        {
+            return { -a.upper, -a.lower };
+        }
+
+        static RealInterval Abs(const RealInterval& a)
+        {
+            if (IsNonNegative(a.lower))
+                return a;
+            if (IsNonPositive(a.upper))
+                return Neg(a);
+            return { float_precision(0), std::max(-a.lower, a.upper) };
+        }
+
+        RealInterval Add(const RealInterval& a, const RealInterval& b) const
+        {
+            auto lo = Down(a.lower);
+            lo += b.lower;
+
+            auto hi = Up(a.upper);
+            hi += b.upper;
+
+            return { lo, hi };
+        }
+
+        float_precision MulDown(const float_precision& x, const float_precision& y) const
+        {
+            auto z = Down(x);
+            z *= y;
+            return z;
+        }
+
+        float_precision MulUp(const float_precision& x, const float_precision& y) const
+        {
+            auto z = Up(x);
+            z *= y;
+            return z;
+        }
+
+        RealInterval Mul(const RealInterval& a, const RealInterval& b) const
+        {
+            if (IsPoint(a) && IsPoint(b))
+            {
+                /* Exact product of two points, which is rounded in both directions */
+                float_precision z(0, 2*prec_, ROUND_NEAR);
+                z = a.lower;
+                z *= b.lower;
+                return { Down(z), Up(z) };
+            }
+
+            const auto &al = a.lower, &ah = a.upper, &bl = b.lower, &bh = b.upper;
+
+            /* Select the bounds by the signs of the intervals, which needs only two products except for two intervals containing zero */
+            if (IsNonNegative(al))
+            {
+                if (IsNonNegative(bl))
+                    return { MulDown(al, bl), MulUp(ah, bh) };
+                if (IsNonPositive(bh))
+                    return { MulDown(ah, bl), MulUp(al, bh) };
+                return { MulDown(ah, bl), MulUp(ah, bh) };
+            }
+
+            if (IsNonPositive(ah))
+            {
+                if (IsNonNegative(bl))
+                    return { MulDown(al, bh), MulUp(ah, bl) };
+                if (IsNonPositive(bh))
+                    return { MulDown(ah, bh), MulUp(al, bl) };
+                return { MulDown(al, bh), MulUp(al, bl) };
+            }
+
+            if (IsNonNegative(bl))
+                return { MulDown(al, bh), MulUp(ah, bh) };
+            if (IsNonPositive(bh))
+                return { MulDown(ah, bl), MulUp(al, bl) };
+
+            return { std::min(MulDown(al, bh), MulDown(ah, bl)), std::max(MulUp(al, bl), MulUp(ah, bh)) };
+        }
+
+        // Returns an enclosure of x/y, whose quotient is not correctly rounded.
+        RealInterval Quotient(const float_precision& x, const float_precision& y) const
+        {
+            auto q = Extended(x);
+            q /= y;
+            return Enclose(q, Exp(q) - static_cast<int>(prec_) + 1);
+        }
+
+        RealInterval Div(const RealInterval& a, const RealInterval& b) const
+        {
+            if (IsNonPositive(b.lower) && IsNonNegative(b.upper))
+                throw float_precision::divide_by_zero();
+
+            if (IsPoint(a) && IsPoint(b))
+                return Quotient(a.lower, b.lower);
+
+            const auto &al = a.lower, &ah = a.upper, &bl = b.lower, &bh = b.upper;
+
+            if (bl.sign() > 0)
+            {
+                if (IsNonNegative(al))
+                    return { Quotient(al, bh).lower, Quotient(ah, bl).upper };
+                if (IsNonPositive(ah))
+                    return { Quotient(al, bl).lower, Quotient(ah, bh).upper };
+                return { Quotient(al, bl).lower, Quotient(ah, bl).upper };
+            }
+
+            if (IsNonNegative(al))
+                return { Quotient(ah, bh).lower, Quotient(al, bl).upper };
+            if (IsNonPositive(ah))
+                return { Quotient(ah, bl).lower, Quotient(al, bh).upper };
+            return { Quotient(ah, bh).lower, Quotient(al, bh).upper };
+        }
+
+        // Returns x^n for x >= 0 by repeated squaring, where all products are rounded in the same direction.
+        float_precision PowBound(const float_precision& x, unsigned long n, enum round_mode mode) const
+        {
+            float_precision y(1, prec_, mode), base(0, prec_, mode);
+            base = x;
+
+            for (; n > 0; n >>= 1)
+            {
+                if (n & 1)
+                    y *= base;
+                if (n > 1)
+                    base *= base;
+            }
+
+            return y;
+        }
+
+        RealInterval IntPow(const RealInterval& a, unsigned long n) const
+        {
+            if (n == 0)
+                return Int(1);
+
+            const bool isOdd = ((n & 1) != 0);
+
+            if (IsNonNegative(a.lower))
+                return { PowBound(a.lower, n, ROUND_DOWN), PowBound(a.upper, n, ROUND_UP) };
+
+            if (IsNonPositive(a.upper))
+            {
+                if (isOdd)
+                    return { -PowBound(-a.lower, n, ROUND_UP), -PowBound(-a.upper, n, ROUND_DOWN) };
+                return { PowBound(-a.upper, n, ROUND_DOWN), PowBound(-a.lower, n, ROUND_UP) };
+            }
+
+            if (isOdd)
+                return { -PowBound(-a.lower, n, ROUND_UP), PowBound(a.upper, n, ROUND_UP) };
+            return { float_precision(0), PowBound(std::max(-a.lower, a.upper), n, ROUND_UP) };
+        }
+
+        RealInterval Pow(const RealInterval& a, const RealInterval& b)
+        {
+            /* Integral exponents with directed rounding, which also covers negative bases */
+            if (IsPoint(b) && IsInteger(b.lower) && Exp(b.lower) < 9)
+            {
+                auto n = b.lower.to_int_precision();
+                if (n.sign() < 0)
+                    return Div(Int(1), IntPow(a, static_cast<unsigned long>(-n)));
+                return IntPow(a, static_cast<unsigned long>(n));
+            }
+
+            /* x^y = exp(y*log(x)) */
+            if (a.lower.sign() > 0 && !IsZero(a.lower))
+                return ExpFunc(Mul(b, Log(a)));
+
+            /* 0^y = 0 for y > 0 */
+            if (IsZero(a.lower) && b.lower.sign() > 0 && !IsZero(b.lower))
+            {
+                if (IsZero(a.upper))
+                    return a;
+                return { float_precision(0), ExpFunc(Mul(b, Log({ a.upper, a.upper }))).upper };
+            }
+
+            throw float_precision::domain_error();
+        }
+
+        /* --- Elementary functions --- */
+
+        // Returns the magnitude exponent of a function value with a relative error bound.
+        static int RelativeError(const float_precision&, const float_precision& y)
+        {
+            return Exp(y);
+        }
+
+        // Returns the magnitude exponent of a function value with an absolute error bound for values up to 1.
+        static int AbsoluteError(const float_precision&, const float_precision& y)
+        {
+            return std::max(Exp(y), 0);
+        }
+
+        /*
+        Returns an enclosure of f(x) for an exact x, where m(x, f(x)) is the magnitude exponent for the error bound.
+        Zeros and ones at zero are exact (e.g. sin(0) and exp(0)).
+        */
+        template <typename F, typename M>
+        RealInterval FuncAt(const float_precision& x, const F& f, const M& m) const
+        {
+            const auto y = f(Extended(x));
+
+            if (IsZero(x) && (IsZero(y) || y == float_precision(1)))
+                return { Down(y), Up(y) };
+
+            return Enclose(y, FuncErrorExp(m(x, y)));
+        }
+
+        // Returns an enclosure of a monotonic function, which is evaluated only once for points.
+        template <typename F, typename M>
+        RealInterval Monotonic(const RealInterval& x, bool increasing, const F& f, const M& m) const
+        {
+            if (IsPoint(x))
+                return FuncAt(x.lower, f, m);
+
+            auto a = FuncAt(x.lower, f, m);
+            auto b = FuncAt(x.upper, f, m);
+
+            if (increasing)
+                return { a.lower, b.upper };
+            else
+                return { b.lower, a.upper };
+        }
+
+        RealInterval ExpFunc(const RealInterval& x) const
+        {
+            return Monotonic(x, true, [](const float_precision& x) { return exp(x); }, [](const float_precision& x, const float_precision& y) {
+                return Exp(y) + std::max(Exp(x), 0);
+            });
+        }
+
+        RealInterval Log(const RealInterval& x) const
+        {
+            if (!(x.lower.sign() > 0 && !IsZero(x.lower)))
+                throw float_precision::domain_error();
+            return Monotonic(x, true, [](const float_precision& x) { return log(x); }, AbsoluteError);
+        }
+
+        RealInterval Cosh(const RealInterval& x) const
+        {
+            auto func = [](const float_precision& x) { return cosh(x); };
+
+            auto magnitude = [](const float_precision& x, const float_precision& y) {
+                return Exp(y) + std::max(Exp(x), 0);
+            };
+
+            if (IsNonNegative(x.lower))
+                return Monotonic(x, true, func, magnitude);
+            if (IsNonPositive(x.upper))
+                return Monotonic(x, false, func, magnitude);
+
+            /* Minimum at zero */
+            auto a = FuncAt(x.lower, func, magnitude);
+            auto b = FuncAt(x.upper, func, magnitude);
+
+            return { Int(1).lower, std::max(a.upper, b.upper) };
+        }
+
+        /*
+        Returns the indices k of all points 'offset + k*pi' which may lie in the interval, or false if the interval is too wide.
+        The indices are found approximately, and verified with the enclosure of pi.
+        */
+        bool FindPiMultiples(const RealInterval& x, const RealInterval& offset, std::vector<int_precision>& indices)
+        {
+            const auto pi = Pi();
+
+            /* Intervals of at least one period or beyond the precision of pi contain all kinds of points */
+            auto width = Up(x.upper);
+            width -= x.lower;
+
+            auto period = Down(pi.lower);
+            period *= float_precision(2);
+
+            if (width >= period || std::max(Exp(x.lower), Exp(x.upper)) + 3 >= static_cast<int>(prec_))
+                return false;
+
+            auto kBegin = floor((x.lower - offset.upper) / pi.upper).to_int_precision() - int_precision(1);
+            auto kEnd   = ceil((x.upper - offset.lower) / pi.lower).to_int_precision() + int_precision(1);
+
+            for (auto k = kBegin; k <= kEnd; ++k)
+            {
+                auto t = Add(offset, Mul(Int(k), pi));
+                if (!(t.upper < x.lower) && !(t.lower > x.upper))
+                    indices.push_back(k);
+            }
+
+            return true;
+        }
+
+        RealInterval SinCos(const RealInterval& x, bool cosine)
+        {
+            auto func = [cosine](const float_precision& x) { return (cosine ? cos(x) : sin(x)); };
+
+            /* Absolute error bound, which grows with the argument reduction */
+            auto magnitude = [](const float_precision& x, const float_precision&) {
+                return std::max(Exp(x), 0);
+            };
+
+            RealInterval result;
+
+            if (IsPoint(x))
+                result = FuncAt(x.lower, func, magnitude);
+            else
+            {
+                /* Extrema at 'offset + k*pi' with value (-1)^k, where the offset is pi/2 for the sine and zero for the cosine */
+                std::vector<int_precision> indices;
+                if (!FindPiMultiples(x, (cosine ? Int(0) : Div(Pi(), Int(2))), indices))
+                    return { Int(-1).lower, Int(1).upper };
+
+                auto a = FuncAt(x.lower, func, magnitude);
+                auto b = FuncAt(x.upper, func, magnitude);
+
+                result = { std::min(a.lower, b.lower), std::max(a.upper, b.upper) };
+
+                for (const auto& k : indices)
+                {
+                    if ((k % int_precision(2)) == int_precision(0))
+                        result.upper = Int(1).upper;
+                    else
+                        result.lower = Int(-1).lower;
+                }
+            }
+
+            /* Clamp the error bounds to the range of both functions */
+            result.lower = std::max(result.lower, Int(-1).lower);
+            result.upper = std::min(result.upper, Int(1).upper);
+
+            return result;
+        }
+
+        RealInterval Tan(const RealInterval& x)
+        {
+            /* Poles at pi/2 + k*pi */
+            std::vector<int_precision> indices;
+            if (!FindPiMultiples(x, Div(Pi(), Int(2)), indices) || !indices.empty())
+                throw float_precision::domain_error();
+
+            /* Error of the argument reduction, amplified by the derivative 1 + tan(x)^2 */
+            return Monotonic(x, true, [](const float_precision& x) { return tan(x); }, [](const float_precision& x, const float_precision& y) {
+                return std::max(Exp(x), 0) + std::max(Exp(y), 0) + std::max(2*Exp(y) + 1, 0);
+            });
+        }
+
+        RealInterval Pi()
+        {
+            if (!hasPi_)
+            {
+                /* Digits of pi from the table of precpkg, which are correct up to their last place */
+                auto x = _float_table(_PI, prec_ + funcDigits);
+                pi_ = Enclose(x, -static_cast<int>(prec_) + 1);
+                hasPi_ = true;
+            }
+            return pi_;
+        }
+
+        /* --- Exact integer operations --- */
+
+        static int_precision ExactInt(const RealInterval& x, const std::string& errorMsg)
+        {
+            if (!IsPoint(x) || !IsInteger(x.lower))
+                Error(errorMsg);
+            return x.lower.to_int_precision();
+        }
+
+        template <typename Op>
+        RealInterval ExactIntOp(const RealInterval& a, const RealInterval& b, const std::string& op, const Op& func) const
+        {
+            const auto errorMsg = "operator '" + op + "' requires exact integers in interval mode";
+
+            Variable x(ExactInt(a, errorMsg));
+            Variable y(ExactInt(b, errorMsg));
+            func(x, y);
+
+            if (x.IsFloat() || x.IsRational() || x.IsComplex())
+                Error(errorMsg);
+
+            return Int(x.GetInt());
+        }
+
+        /* --- Interval stack --- */
+
+        void Push(const RealInterval& x)
+        {
+            values_.push(x);
+        }
+
+        RealInterval Pop()
+        {
+            if (values_.empty())
+                Error("stack underflow");
+            auto x = values_.top();
+            values_.pop();
+            return x;
+        }
+
+        std::stack<RealInterval>                values_;
+        std::map<std::string, int_precision>    indices_;
+        RealInterval                            pi_;
+        bool                                    hasPi_          = false;
+
+        unsigned int                            prec_           = 0;
+
+        ComputeMode                             mode_;
+        const ConstantsSet*                     constantsSet_   = nullptr;
+
+};
+
+
+/* --- Hardware interval computer --- */
+
+// Number of decimal digits up to which the hardware intervals are tried first.
+static const unsigned int fastDigits = 15;
+
+// Number of fold iterations which are computed together in one batch.
+static const std::size_t foldBatchSize = 1024;
+
+// Largest magnitude up to which all integers are exact doubles.
+static const double maxExactInt = 9007199254740992.0;
+
+/*
+Computes an expression tree with batches of hardware double intervals (see IntervalKernels.h).
+The iterations of a fold are computed together in batches, with the index variable as batch of consecutive integers,
+and the enclosures of all batches are summed (or multiplied) pairwise.
+Everything which is not supported (functions, nested folds, integer operators, domain errors) is left for the interval computer.
+*/
+class FastIntervalComputer : private Visitor
+{
+
+    public:
+
+        /**
+        Computes the specified expression tree.
+        \param[out] lower Receives the lower bound of the result.
+        \param[out] upper Receives the upper bound of the result.
+        \return True if the expression could be computed, otherwise false.
+        */
+        bool Compute(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet, double& lower, double& upper)
+        {
+            mode_           = mode;
+            constantsSet_   = &constantsSet;
+
+            try
+            {
+                /* Set the rounding mode only once for all kernels */
+                ScopedRoundUp roundUp;
+
+                Visit(ast);
+
+                /* Single values are cheaper and tighter with the interval computer, only folds are worth the batches */
+                if (!hasFold_)
+                    return false;
+
+                auto x = Pop();
+                lower = -x.negLower.front();
+                upper = x.upper.front();
+
+                return true;
+            }
+            catch (const Unsupported&)
+            {
+                return false;
+            }
+        }
+
+    private:
+
+        //! Exception to leave the hardware computation.
+        struct Unsupported {};
+
+        /* --- Visitor --- */
+
+        void VisitUnaryExpr(UnaryExpr* ast, void*) override
+        {
+            Visit(ast->expr);
+            auto& a = Top();
+
+            using Op = UnaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Keep:
+                    break;
+                case Op::Negate:
+                    std::swap(a.negLower, a.upper);
+                    break;
+                case Op::Norm:
+                    IntervalAbs(a, a);
+                    break;
+                default:
+                    Bail();
+                    break;
+            }
+        }
+
+        void VisitBinaryExpr(BinaryExpr* ast, void*) override
+        {
+            Visit(ast->exprL);
+            Visit(ast->exprR);
+
+            auto b = Pop();
+            auto& a = Top();
+
+            using Op = BinaryExpr::Operators;
+
+            switch (ast->op)
+            {
+                case Op::Add:
+                    Broadcast(a, b);
+                    IntervalAdd(a, b, a);
+                    break;
+                case Op::Sub:
+                    Broadcast(a, b);
+                    IntervalSub(a, b, a);
+                    break;
+                case Op::Mul:
+                    Broadcast(a, b);
+                    IntervalMul(a, b, a);
+                    break;
+                case Op::Div:
+                    Broadcast(a, b);
+                    if (!IntervalDiv(a, b, a))
+                        Bail();
+                    break;
+                case Op::Pow:
+                    Pow(a, b);
+                    break;
+                default:
+                    Bail();
+                    break;
+            }
+
+            Check(a);
+        }
+
+        void VisitLiteralExpr(LiteralExpr* ast, void*) override
+        {
+            Push(Literal(ast->value));
+        }
+
+        void VisitIdentExpr(IdentExpr* ast, void*) override
+        {
+            /* Fold index is a batch of integers */
+            if (ast->value == index_)
+            {
+                Push(indexBatch_);
+                return;
+            }
+
+            /* Find constant (only real scalars, and no rationals whose literals are rounded) */
+            auto value = constantsSet_->Find(ast->symbol);
+            if (!value || !value->Get().IsScalar() || value->Get().IsComplex() || value->Get().IsRational())
+                Bail();
+
+            Push(Literal(value->Literal()));
+        }
+
+        void VisitFuncExpr(FuncExpr* ast, void*) override
+        {
+            const auto& f = ast->name;
+
+            if (f == "sqrt" && ast->args.size() == 1)
+            {
+                Visit(ast->args.front());
+                if (!IntervalSqrt(Top(), Top()))
+                    Bail();
+            }
+            else if (f == "abs" && ast->args.size() == 1)
+            {
+                Visit(ast->args.front());
+                IntervalAbs(Top(), Top());
+            }
+            else if (f == "pow" && ast->args.size() == 2)
+            {
+                Visit(ast->args[0]);
+                Visit(ast->args[1]);
+                auto b = Pop();
+                Pow(Top(), b);
+                Check(Top());
+            }
+            else
+                Bail();
+        }
+
+        void VisitFoldExpr(FoldExpr* ast, void*) override
+        {
+            /* Only outermost folds, whose index range is exact */
+            if (!index_.empty() || constantsSet_->Contains(ast->indexSymbol))
+                Bail();
+
+            Visit(ast->initExpr);
+            const auto first = ExactInt(Pop());
+
+            Visit(ast->iterExpr);
+            const auto last = ExactInt(Pop());
+
+            const bool isSum = (ast->func == "sum");
+
+            /* Enclosures of all batches, which are combined pairwise at the end */
+            IntervalBatch batches;
+
+            index_ = ast->index;
+
+            for (double k = first; k <= last; k += static_cast<double>(foldBatchSize))
+            {
+                /* Batch of consecutive indices */
+                const auto n = static_cast<std::size_t>(std::min(last - k + 1.0, static_cast<double>(foldBatchSize)));
+
+                indexBatch_.negLower.resize(n);
+                indexBatch_.upper.resize(n);
+
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    indexBatch_.negLower[i] = -(k + static_cast<double>(i));
+                    indexBatch_.upper[i]    =   k + static_cast<double>(i);
+                }
+
+                Visit(ast->loopExpr);
+                auto terms = Pop();
+
+                if (terms.Size() == 1 && n > 1)
+                    terms = IntervalBatch(n, -terms.negLower.front(), terms.upper.front());
+
+                double negLower = 0.0, upper = 0.0;
+
+                if (isSum)
+                    IntervalSum(terms, negLower, upper);
+                else
+                    IntervalProduct(terms, negLower, upper);
+
+                batches.negLower.push_back(negLower);
+                batches.upper.push_back(upper);
+            }
+
+            index_.clear();
+
+            double negLower = 0.0, upper = 0.0;
+
+            if (isSum)
+                IntervalSum(batches, negLower, upper);
+            else
+                IntervalProduct(batches, negLower, upper);
+
+            IntervalBatch result(1, -negLower, upper);
+            Check(result);
+
+            hasFold_ = true;
+
+            Push(result);
+        }
+
+        void VisitVectorExpr(VectorExpr*, void*) override
+        {
+            Bail();
+        }
+
+        void VisitDefExpr(DefExpr*, void*) override
+        {
+            Bail();
+        }
+
+        /* --- Values --- */
+
+        static void Bail()
+        {
+            throw Unsupported();
+        }
+
+        // Leaves the computation for results which have overflown (also hidden by the maxima of the kernels).
+        static void Check(const IntervalBatch& x)
+        {
+            for (std::size_t i = 0, n = x.Size(); i < n; ++i)
+            {
+                if (!std::isfinite(x.negLower[i]) || !std::isfinite(x.upper[i]))
+                    Bail();
+            }
+        }
+
+        // Returns the enclosure of the decimal number (e.g. "-1.25E-3").
+        static IntervalBatch Literal(const std::string& s)
+        {
+            char* end = nullptr;
+            const double x = std::strtod(s.c_str(), &end);
+
+            if (end == nullptr || *end != '\0' || !std::isfinite(x))
+                Bail();
+
+            /* Integers with up to 15 digits are exact, all others are within one ulp */
+            if (s.size() <= 15 && s.find_first_not_of("-0123456789") == std::string::npos)
+                return IntervalBatch(1, x, x);
+
+            return IntervalBatch(1, std::nextafter(x, -HUGE_VAL), std::nextafter(x, HUGE_VAL));
+        }
+
+        static double ExactInt(const IntervalBatch& x)
+        {
+            const double lower = -x.negLower.front(), upper = x.upper.front();
+            if (x.Size() != 1 || lower != upper || std::floor(lower) != lower || std::abs(lower) >= maxExactInt)
+                Bail();
+            return lower;
+        }
+
+        // Expands a single interval to the batch size of the other operand.
+        static void Broadcast(IntervalBatch& a, IntervalBatch& b)
+        {
+            if (a.Size() == 1 && b.Size() > 1)
+                a = IntervalBatch(b.Size(), -a.negLower.front(), a.upper.front());
+            else if (b.Size() == 1 && a.Size() > 1)
+                b = IntervalBatch(a.Size(), -b.negLower.front(), b.upper.front());
+        }
+
+        // Raises the intervals to an exact integral power by repeated squaring.
+        static void Pow(IntervalBatch& a, const IntervalBatch& b)
+        {
+            const double e = ExactInt(b);
+            if (std::abs(e) > 1024.0)
+                Bail();
+
+            auto n = static_cast<unsigned int>(std::abs(e));
+
+            /* Even powers of the magnitudes, so intervals containing zero do not become negative */
+            IntervalBatch base = a;
+            if (n % 2 == 0)
+                IntervalAbs(base, base);
+
+            IntervalBatch result(a.Size(), 1.0, 1.0);
+
+            for (; n > 0; n >>= 1)
+            {
+                if (n & 1)
+                    IntervalMul(result, base, result);
+                if (n > 1)
+                    IntervalMul(base, base, base);
+            }
+
+            if (e < 0.0)
+            {
+                IntervalBatch one(a.Size(), 1.0, 1.0);
+                if (!IntervalDiv(one, result, result))
+                    Bail();
+            }
+
+            a = std::move(result);
+        }
+
+        /* --- Value stack --- */
+
+        void Push(const IntervalBatch& x)
+        {
+            values_.push(x);
+        }
+
+        IntervalBatch Pop()
+        {
+            if (values_.empty())
+                Bail();
+            auto x = std::move(values_.top());
+            values_.pop();
+            return x;
+        }
+
+        IntervalBatch& Top()
+        {
+            if (values_.empty())
+                Bail();
+            return values_.top();
+        }
+
+        std::stack<IntervalBatch>   values_;
+        std::string                 index_;
+        IntervalBatch               indexBatch_;
+        bool                        hasFold_        = false;
+
+        ComputeMode                 mode_;
+        const ConstantsSet*         constantsSet_   = nullptr;
+
+};
+
+// Returns the double exactly converted to a decimal number, which is rounded to the number of digits.
+static float_precision ToFloat(double x, unsigned int digits, enum round_mode mode)
+{
+    if (x == 0.0)
+        return float_precision(0, digits, mode);
+
+    /* x = m * 2^e with an integral mantissa, and m * 2^-k = m * 5^k * 10^-k */
+    int e = 0;
+    const auto m = static_cast<long long>(std::ldexp(std::frexp(x, &e), 53));
+    e -= 53;
+
+    int_precision n(std::to_string(m).c_str());
+
+    if (e >= 0)
+        return float_precision(n * ipow(int_precision(2), int_precision(e)), digits, mode);
+
+    float_precision y(n * ipow(int_precision(5), int_precision(-e)), digits, mode);
+    y.exponent(y.exponent() + e);
+
+    return y;
+}
+
+// Computes the enclosure with hardware intervals, if they are supported and precise enough for the number of digits.
+static bool ComputeFastInterval(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet, unsigned int digits, RealInterval& x)
+{
+    if (digits > fastDigits)
+        return false;
+
+    double lower = 0.0, upper = 0.0;
+
+    FastIntervalComputer computer;
+    if (!computer.Compute(ast, mode, constantsSet, lower, upper))
+        return false;
+
+    /* Only keep enclosures which are narrower than one unit in the last place */
+    if (upper - lower > std::max(std::abs(lower), std::abs(upper)) * std::pow(10.0, 1.0 - static_cast<double>(digits)))
+        return false;
+
+    x = { ToFloat(lower, digits, ROUND_DOWN), ToFloat(upper, digits, ROUND_UP) };
+
+    return true;
+}
+
+
+/*
+ * Global functions
+ */
+
+RealInterval ComputeInterval(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet)
+{
+    const auto digits = float_precision_ctrl.precision();
+
+    RealInterval x;
+
+    /* Try batches of hardware intervals first */
+    if (ComputeFastInterval(ast, mode, constantsSet, digits, x))
+        return x;
+
+    {
+        /* Compute with guard digits, which also apply to all temporary values */
+        const auto prec = digits + guardDigits;
+        ScopedPrecision scope(prec + funcDigits);
+
+        IntervalComputer computer(prec);
+        x = computer.Compute(ast, mode, constantsSet);
+    }
+
+    /* Round outwards to the working precision */
+    float_precision lo(0, digits, ROUND_DOWN), hi(0, digits, ROUND_UP);
+    lo = x.lower;
+    hi = x.upper;
+
+    return { lo, hi };
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
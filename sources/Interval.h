@@ -0,0 +1,54 @@
+/*
+ * Interval.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_INTERVAL_H__
+#define __AC_INTERVAL_H__
+
+
+#include "precpkg/iprecision.h"
+#include "precpkg/fprecision.h"
+
+#include <Abacus/Abacus.h>
+
+
+namespace Ac
+{
+
+
+//! Closed interval [lower, upper] which encloses an exact real value.
+struct RealInterval
+{
+    RealInterval() = default;
+    RealInterval(const RealInterval&) = default;
+
+    // Copies the bounds with their precision and rounding mode, since float_precision::operator= would round them.
+    RealInterval& operator = (const RealInterval& rhs)
+    {
+        lower.assign(rhs.lower);
+        upper.assign(rhs.upper);
+        return *this;
+    }
+
+    float_precision lower;
+    float_precision upper;
+};
+
+/**
+Computes an enclosure of the exact value of the expression with directed rounding (throws on unsupported expressions).
+The bounds are rounded outwards to the number of digits of the current float context.
+*/
+RealInterval ComputeInterval(const ExprPtr& ast, const ComputeMode& mode, const ConstantsSet& constantsSet);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,389 @@
+/*
+ * IntervalKernels.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "IntervalKernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX__)
+#   include <immintrin.h>
+#   define AC_INTERVAL_SIMD
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define AC_INTERVAL_SIMD
+#endif
+
+/*
+The kernels depend on the dynamic rounding mode, so the compiler must neither fold nor reorder them
+(GCC and Clang get '-frounding-math' for this file, see CMakeLists.txt)
+*/
+#if defined(_MSC_VER)
+#   pragma fenv_access (on)
+#endif
+
+
+namespace Ac
+{
+
+
+/* --- Scalar operations --- */
+
+static inline double Add(double a, double b)    { return a + b; }
+static inline double Mul(double a, double b)    { return a * b; }
+static inline double Div(double a, double b)    { return a / b; }
+static inline double Sqrt(double a)             { return std::sqrt(a); }
+static inline double Max(double a, double b)    { return (a > b ? a : b); }
+static inline double Neg(double a)              { return -a; }
+
+template <typename V>
+V Splat(double x);
+
+template <>
+inline double Splat<double>(double x)
+{
+    return x;
+}
+
+
+/* --- SIMD operations --- */
+
+#if defined(__AVX__)
+
+typedef __m256d Pack;
+
+static const std::size_t packSize = 4;
+
+static inline Pack Load(const double* p)        { return _mm256_loadu_pd(p); }
+static inline void Store(double* p, Pack a)     { _mm256_storeu_pd(p, a); }
+static inline Pack Add(Pack a, Pack b)          { return _mm256_add_pd(a, b); }
+static inline Pack Mul(Pack a, Pack b)          { return _mm256_mul_pd(a, b); }
+static inline Pack Div(Pack a, Pack b)          { return _mm256_div_pd(a, b); }
+static inline Pack Sqrt(Pack a)                 { return _mm256_sqrt_pd(a); }
+static inline Pack Max(Pack a, Pack b)          { return _mm256_max_pd(a, b); }
+static inline Pack Neg(Pack a)                  { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+
+template <>
+inline Pack Splat<Pack>(double x)
+{
+    return _mm256_set1_pd(x);
+}
+
+#elif defined(AC_INTERVAL_SIMD)
+
+typedef __m128d Pack;
+
+static const std::size_t packSize = 2;
+
+static inline Pack Load(const double* p)        { return _mm_loadu_pd(p); }
+static inline void Store(double* p, Pack a)     { _mm_storeu_pd(p, a); }
+static inline Pack Add(Pack a, Pack b)          { return _mm_add_pd(a, b); }
+static inline Pack Mul(Pack a, Pack b)          { return _mm_mul_pd(a, b); }
+static inline Pack Div(Pack a, Pack b)          { return _mm_div_pd(a, b); }
+static inline Pack Sqrt(Pack a)                 { return _mm_sqrt_pd(a); }
+static inline Pack Max(Pack a, Pack b)          { return _mm_max_pd(a, b); }
+static inline Pack Neg(Pack a)                  { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+
+template <>
+inline Pack Splat<Pack>(double x)
+{
+    return _mm_set1_pd(x);
+}
+
+#endif
+
+
+/* --- Bounds ---
+Each operation receives the negated lower bounds 'n' and the upper bounds 'h' of its operands.
+Every product or quotient of two endpoints appears once for the upper bound, and once with a negated operand for the negated lower bound.
+*/
+
+struct AddBounds
+{
+    template <typename V>
+    void operator () (V na, V ha, V nb, V hb, V& nlo, V& hi) const
+    {
+        nlo = Add(na, nb);
+        hi  = Add(ha, hb);
+    }
+};
+
+struct SubBounds
+{
+    template <typename V>
+    void operator () (V na, V ha, V nb, V hb, V& nlo, V& hi) const
+    {
+        nlo = Add(na, hb);
+        hi  = Add(ha, nb);
+    }
+};
+
+struct MulBounds
+{
+    template <typename V>
+    void operator () (V na, V ha, V nb, V hb, V& nlo, V& hi) const
+    {
+        /* Endpoint products lower*lower, lower*upper, upper*lower, and upper*upper */
+        nlo = Max(Max(Mul(Neg(na), nb), Mul(na, hb)), Max(Mul(ha, nb), Mul(Neg(ha), hb)));
+        hi  = Max(Max(Mul(na, nb), Mul(Neg(na), hb)), Max(Mul(ha, Neg(nb)), Mul(ha, hb)));
+    }
+};
+
+struct DivBounds
+{
+    template <typename V>
+    void operator () (V na, V ha, V nb, V hb, V& nlo, V& hi) const
+    {
+        /* Endpoint quotients, which are only bounded for divisors without zero */
+        nlo = Max(Max(Div(Neg(na), nb), Div(na, hb)), Max(Div(ha, nb), Div(Neg(ha), hb)));
+        hi  = Max(Max(Div(na, nb), Div(Neg(na), hb)), Max(Div(ha, Neg(nb)), Div(ha, hb)));
+    }
+};
+
+struct SqrtBounds
+{
+    template <typename V>
+    void operator () (V na, V ha, V& nlo, V& hi) const
+    {
+        /*
+        The rounded-up root 's' of the lower bound exceeds the exact root by less than one ulp,
+        and s*(1 - 2^-52) is at least one ulp below 's'
+        */
+        auto s = Sqrt(Neg(na));
+        nlo = Mul(s, Splat<V>(-1.0 + DBL_EPSILON));
+        hi  = Sqrt(ha);
+    }
+};
+
+struct AbsBounds
+{
+    template <typename V>
+    void operator () (V na, V ha, V& nlo, V& hi) const
+    {
+        /* |x| >= max(lower, -upper, 0) and |x| <= max(-lower, upper) */
+        nlo = Neg(Max(Max(Neg(na), Neg(ha)), Splat<V>(0.0)));
+        hi  = Max(na, ha);
+    }
+};
+
+
+/* --- Drivers --- */
+
+template <typename Bounds>
+static void Binary(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out, const Bounds& bounds)
+{
+    const auto n = a.Size();
+
+    out.negLower.resize(n);
+    out.upper.resize(n);
+
+    const double* na = a.negLower.data();
+    const double* ha = a.upper.data();
+    const double* nb = b.negLower.data();
+    const double* hb = b.upper.data();
+
+    double* nOut = out.negLower.data();
+    double* hOut = out.upper.data();
+
+    std::size_t i = 0;
+
+    #ifdef AC_INTERVAL_SIMD
+    for (; i + packSize <= n; i += packSize)
+    {
+        Pack nlo, hi;
+        bounds(Load(na + i), Load(ha + i), Load(nb + i), Load(hb + i), nlo, hi);
+        Store(nOut + i, nlo);
+        Store(hOut + i, hi);
+    }
+    #endif
+
+    for (; i < n; ++i)
+    {
+        double nlo, hi;
+        bounds(na[i], ha[i], nb[i], hb[i], nlo, hi);
+        nOut[i] = nlo;
+        hOut[i] = hi;
+    }
+}
+
+template <typename Bounds>
+static void Unary(const IntervalBatch& a, IntervalBatch& out, const Bounds& bounds)
+{
+    const auto n = a.Size();
+
+    out.negLower.resize(n);
+    out.upper.resize(n);
+
+    const double* na = a.negLower.data();
+    const double* ha = a.upper.data();
+
+    double* nOut = out.negLower.data();
+    double* hOut = out.upper.data();
+
+    std::size_t i = 0;
+
+    #ifdef AC_INTERVAL_SIMD
+    for (; i + packSize <= n; i += packSize)
+    {
+        Pack nlo, hi;
+        bounds(Load(na + i), Load(ha + i), nlo, hi);
+        Store(nOut + i, nlo);
+        Store(hOut + i, hi);
+    }
+    #endif
+
+    for (; i < n; ++i)
+    {
+        double nlo, hi;
+        bounds(na[i], ha[i], nlo, hi);
+        nOut[i] = nlo;
+        hOut[i] = hi;
+    }
+}
+
+// Number of values up to which sums are accumulated linearly instead of pairwise.
+static const std::size_t pairwiseBlock = 64;
+
+/*
+Returns the sum of all values, which is an upper bound with the rounding mode upwards.
+Pairwise summation keeps the accumulated rounding errors proportional to the logarithm of the number of values.
+*/
+static double SumUp(const double* p, std::size_t n)
+{
+    if (n > pairwiseBlock)
+    {
+        const auto half = n / 2;
+        return SumUp(p, half) + SumUp(p + half, n - half);
+    }
+
+    double sum = 0.0;
+    std::size_t i = 0;
+
+    #ifdef AC_INTERVAL_SIMD
+    if (n >= packSize)
+    {
+        auto acc = Splat<Pack>(0.0);
+        for (; i + packSize <= n; i += packSize)
+            acc = Add(acc, Load(p + i));
+
+        double lanes[packSize];
+        Store(lanes, acc);
+
+        for (auto lane : lanes)
+            sum += lane;
+    }
+    #endif
+
+    for (; i < n; ++i)
+        sum += p[i];
+
+    return sum;
+}
+
+
+/*
+ * Global functions
+ */
+
+void IntervalAdd(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out)
+{
+    Binary(a, b, out, AddBounds());
+}
+
+void IntervalSub(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out)
+{
+    Binary(a, b, out, SubBounds());
+}
+
+void IntervalMul(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out)
+{
+    Binary(a, b, out, MulBounds());
+}
+
+bool IntervalDiv(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out)
+{
+    /* Divisor contains zero if lower <= 0 <= upper */
+    for (std::size_t i = 0, n = b.Size(); i < n; ++i)
+    {
+        if (b.negLower[i] >= 0.0 && b.upper[i] >= 0.0)
+            return false;
+    }
+
+    Binary(a, b, out, DivBounds());
+
+    return true;
+}
+
+bool IntervalSqrt(const IntervalBatch& a, IntervalBatch& out)
+{
+    for (auto x : a.negLower)
+    {
+        if (x > 0.0)
+            return false;
+    }
+
+    Unary(a, out, SqrtBounds());
+
+    return true;
+}
+
+void IntervalAbs(const IntervalBatch& a, IntervalBatch& out)
+{
+    Unary(a, out, AbsBounds());
+}
+
+void IntervalSum(const IntervalBatch& a, double& negLower, double& upper)
+{
+    negLower    = SumUp(a.negLower.data(), a.Size());
+    upper       = SumUp(a.upper.data(), a.Size());
+}
+
+void IntervalProduct(const IntervalBatch& a, double& negLower, double& upper)
+{
+    if (a.Size() == 0)
+    {
+        negLower    = -1.0;
+        upper       = 1.0;
+        return;
+    }
+
+    /* Multiply the first half with the second half, until a single interval is left */
+    auto x = a;
+
+    while (x.Size() > 1)
+    {
+        const auto n = x.Size(), half = n / 2;
+
+        IntervalBatch lhs, rhs;
+        lhs.negLower.assign(x.negLower.begin(), x.negLower.begin() + half);
+        lhs.upper.assign(x.upper.begin(), x.upper.begin() + half);
+        rhs.negLower.assign(x.negLower.begin() + half, x.negLower.begin() + 2*half);
+        rhs.upper.assign(x.upper.begin() + half, x.upper.begin() + 2*half);
+
+        IntervalMul(lhs, rhs, lhs);
+
+        /* Keep the last interval of an odd number of intervals */
+        if (n % 2 != 0)
+        {
+            lhs.negLower.push_back(x.negLower.back());
+            lhs.upper.push_back(x.upper.back());
+        }
+
+        x = std::move(lhs);
+    }
+
+    negLower    = x.negLower.front();
+    upper       = x.upper.front();
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
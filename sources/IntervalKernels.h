@@ -0,0 +1,103 @@
+/*
+ * IntervalKernels.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_INTERVAL_KERNELS_H__
+#define __AC_INTERVAL_KERNELS_H__
+
+
+#include <cfenv>
+#include <cstddef>
+#include <vector>
+
+
+namespace Ac
+{
+
+
+/*
+Batched interval arithmetic in hardware double precision (with SSE2, or AVX if the compiler targets it).
+A batch stores the negated lower bounds and the upper bounds of its intervals in separate arrays,
+so the lower bound of an operation is the negated upper bound of the same operation with negated operands.
+All bounds are therefore rounded upwards, and the kernels require the rounding mode of a ScopedRoundUp,
+which is set only once for a whole computation instead of switching the mode for each bound.
+*/
+
+// Sets the rounding mode of the current thread to upwards, and restores the previous mode when it goes out of scope.
+class ScopedRoundUp
+{
+
+    public:
+
+        ScopedRoundUp() :
+            mode_( std::fegetround() )
+        {
+            std::fesetround(FE_UPWARD);
+        }
+        ~ScopedRoundUp()
+        {
+            std::fesetround(mode_);
+        }
+
+    private:
+
+        int mode_;
+
+};
+
+//! Batch of the intervals [-negLower[i], upper[i]].
+struct IntervalBatch
+{
+    IntervalBatch() = default;
+
+    // Batch of 'n' copies of the interval [lower, upper].
+    IntervalBatch(std::size_t n, double lower, double upper) :
+        negLower( n, -lower ),
+        upper   ( n,  upper )
+    {
+    }
+
+    std::size_t Size() const
+    {
+        return upper.size();
+    }
+
+    std::vector<double> negLower;
+    std::vector<double> upper;
+};
+
+/*
+Kernels over batches of the same size, where 'out' may be one of the operands.
+The results of all kernels are undefined without the rounding mode of a ScopedRoundUp.
+*/
+
+void IntervalAdd(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out);
+void IntervalSub(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out);
+void IntervalMul(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out);
+
+//! Returns false (and leaves 'out' unchanged) if an interval of 'b' contains zero.
+bool IntervalDiv(const IntervalBatch& a, const IntervalBatch& b, IntervalBatch& out);
+
+//! Returns false (and leaves 'out' unchanged) if an interval of 'a' contains negative values.
+bool IntervalSqrt(const IntervalBatch& a, IntervalBatch& out);
+
+void IntervalAbs(const IntervalBatch& a, IntervalBatch& out);
+
+//! Encloses the sum of all intervals of the batch.
+void IntervalSum(const IntervalBatch& a, double& negLower, double& upper);
+
+//! Encloses the product of all intervals of the batch (by a pairwise reduction).
+void IntervalProduct(const IntervalBatch& a, double& negLower, double& upper);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,447 @@
+/*
+ * MatrixMath.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "MatrixMath.h"
+#include "VectorMath.h"
+#include "Parallel.h"
+#include "PrecisionUtils.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace Ac
+{
+
+
+// Number of rows from which on the kernels process the rows of a matrix on multiple threads.
+static const std::size_t matParallelThreshold = 32;
+
+// Number of rows and columns of the tiles of a matrix product, which reuse the rows of both operands while they are cached.
+static const std::size_t matBlockSize = 16;
+
+static void Error(const std::string& msg)
+{
+    throw std::runtime_error("math error: " + msg);
+}
+
+static void RequireSquare(const Matrix& a)
+{
+    if (a.rows != a.cols)
+        Error("matrix must be square");
+}
+
+// Returns the number of digits for the elimination of 'n' rows, which accumulates O(n) rounding errors in each element.
+static unsigned int GuardDigits(std::size_t n)
+{
+    return float_precision_ctrl.precision() + 2 * static_cast<unsigned int>(std::to_string(n).size()) + 4;
+}
+
+static bool IsExact(const Matrix& a)
+{
+    return std::none_of(
+        a.elements.begin(), a.elements.end(),
+        [](const Variable& x) { return x.IsFloat() || x.IsComplex(); }
+    );
+}
+
+// Returns the matrix, or a vector as single row or column.
+static Matrix ToMatrix(const Variable& x, bool asColumn)
+{
+    if (x.IsMatrix())
+        return x.GetMatrix();
+
+    const auto& v = x.GetVector();
+
+    Matrix m(asColumn ? v.size() : 1, asColumn ? 1 : v.size());
+    m.elements = v;
+
+    return m;
+}
+
+static Matrix Transposed(const Matrix& a)
+{
+    Matrix t(a.cols, a.rows);
+
+    for (std::size_t i = 0; i < a.rows; ++i)
+    {
+        for (std::size_t j = 0; j < a.cols; ++j)
+            t(j, i) = a(i, j);
+    }
+
+    return t;
+}
+
+// Converts all elements into floats or complex numbers with the given precision.
+static void Extend(Matrix& a, unsigned int prec)
+{
+    const auto mode = float_precision_ctrl.mode();
+
+    for (auto& x : a.elements)
+    {
+        if (x.IsComplex())
+            x = Variable(complex_float(Extended(x.GetComplex().real(), prec), Extended(x.GetComplex().imag(), prec)));
+        else if (x.IsFloat())
+            x = Variable(Extended(x.GetFloat(), prec));
+        else
+        {
+            float_precision y(x.GetInt(), prec, mode);
+            if (x.IsRational())
+                y /= float_precision(x.GetDenom(), prec, mode);
+            x = Variable(std::move(y));
+        }
+    }
+}
+
+// Rounds floats and complex numbers to the working precision.
+static void Round(Variable& x)
+{
+    if (x.IsComplex())
+        x = Variable(complex_float(Rounded(x.GetComplex().real()), Rounded(x.GetComplex().imag())));
+    else if (x.IsFloat())
+        x = Variable(Rounded(x.GetFloat()));
+}
+
+// Returns |re| + |im| as magnitude to select pivots, which avoids the square roots of complex magnitudes.
+static float_precision PivotMagnitude(const Variable& x)
+{
+    if (x.IsComplex())
+        return abs(x.GetComplex().real()) + abs(x.GetComplex().imag());
+    return abs(x.GetFloat());
+}
+
+static void SwapRows(Matrix& m, std::size_t i, std::size_t j)
+{
+    std::swap_ranges(&m(i, 0), &m(i, 0) + m.cols, &m(j, 0));
+}
+
+/*
+Transforms the augmented matrix [A | B] with the square matrix A in its first 'n' columns into [U | C],
+where U is upper triangular, and returns false if A is singular. 'sign' is negated with each row exchange.
+With 'fractionFree', Bareiss' algorithm divides each update exactly by the previous pivot,
+so integers stay integers and the last pivot is the determinant of A.
+Otherwise the rows are eliminated with the pivots of largest magnitude (i.e. LU decomposition with partial pivoting).
+*/
+static bool Eliminate(Matrix& m, std::size_t n, bool fractionFree, int& sign)
+{
+    const auto cols = m.cols;
+
+    Variable prevPivot(int_precision(1));
+
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        /* Select the first non-zero pivot for exact elimination, or the pivot of largest magnitude otherwise */
+        auto p = n;
+        float_precision maxMag;
+
+        for (auto r = k; r < n; ++r)
+        {
+            if (!m(r, k).IsZero())
+            {
+                if (fractionFree)
+                {
+                    p = r;
+                    break;
+                }
+
+                auto mag = PivotMagnitude(m(r, k));
+                if (p == n || mag > maxMag)
+                {
+                    p = r;
+                    maxMag = mag;
+                }
+            }
+        }
+
+        if (p == n)
+            return false;
+
+        if (p != k)
+        {
+            SwapRows(m, p, k);
+            sign = -sign;
+        }
+
+        /* Update the rows below the pivot row, which only read the pivot row (through copies, since operations convert their operands) */
+        ParallelFor(
+            n - k - 1, matParallelThreshold,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (auto r = k + 1 + begin; r < k + 1 + end; ++r)
+                {
+                    if (fractionFree)
+                    {
+                        /* m[r][j] = (m[k][k]*m[r][j] - m[r][k]*m[k][j]) / prevPivot */
+                        for (auto j = k + 1; j < cols; ++j)
+                        {
+                            auto x = m(k, k);
+                            auto y = m(r, j);
+                            x.Mul(y);
+
+                            y = m(r, k);
+                            auto z = m(k, j);
+                            y.Mul(z);
+                            x.Sub(y);
+
+                            z = prevPivot;
+                            if (x.IsRational() || z.IsRational())
+                                x.Div(z);
+                            else
+                                x.IntDiv(z);
+
+                            m(r, j) = std::move(x);
+                        }
+                    }
+                    else if (!m(r, k).IsZero())
+                    {
+                        /* m[r][j] -= (m[r][k]/m[k][k])*m[k][j] */
+                        auto l = m(r, k);
+                        auto pivot = m(k, k);
+                        l.Div(pivot);
+
+                        for (auto j = k + 1; j < cols; ++j)
+                        {
+                            auto t = l;
+                            auto y = m(k, j);
+                            t.Mul(y);
+                            m(r, j).Sub(t);
+                        }
+                    }
+
+                    m(r, k) = Variable(int_precision(0));
+                }
+            }
+        );
+
+        if (fractionFree)
+            prevPivot = m(k, k);
+    }
+
+    return true;
+}
+
+// Solves the upper triangular system in the first 'n' columns of an eliminated matrix for each of its remaining columns.
+static Matrix BackSubstitute(const Matrix& m, std::size_t n)
+{
+    Matrix x(n, m.cols - n);
+
+    ParallelFor(
+        x.cols, matParallelThreshold,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto c = begin; c < end; ++c)
+            {
+                for (auto i = n; i-- > 0;)
+                {
+                    auto s = m(i, n + c);
+
+                    for (auto j = i + 1; j < n; ++j)
+                    {
+                        auto t = m(i, j);
+                        auto y = x(j, c);
+                        t.Mul(y);
+                        s.Sub(t);
+                    }
+
+                    auto d = m(i, i);
+                    s.Div(d);
+
+                    x(i, c) = std::move(s);
+                }
+            }
+        }
+    );
+
+    return x;
+}
+
+// Returns the solution x of a*x = b for all columns of b.
+static Matrix SolveColumns(const Matrix& a, const Matrix& b)
+{
+    RequireSquare(a);
+
+    if (a.rows != b.rows)
+        Error("matrix dimensions do not match");
+
+    const auto n = a.rows;
+
+    /* Build augmented matrix [a | b] */
+    Matrix m(n, n + b.cols);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        std::copy(&a(i, 0), &a(i, 0) + n, &m(i, 0));
+        std::copy(&b(i, 0), &b(i, 0) + b.cols, &m(i, n));
+    }
+
+    int sign = 1;
+
+    if (IsExact(m))
+    {
+        if (!Eliminate(m, n, true, sign))
+            Error("matrix is singular");
+        return BackSubstitute(m, n);
+    }
+
+    Matrix x;
+    {
+        const auto prec = GuardDigits(n);
+        ScopedPrecision scope(prec);
+
+        Extend(m, prec);
+        if (!Eliminate(m, n, false, sign))
+            Error("matrix is singular");
+
+        x = BackSubstitute(m, n);
+    }
+
+    for (auto& v : x.elements)
+        Round(v);
+
+    return x;
+}
+
+
+/*
+ * Global functions
+ */
+
+Variable MatMul(const Variable& a, const Variable& b)
+{
+    /* Transpose the right operand, so each element of the product is a dot product of two rows */
+    const auto lhs = ToMatrix(a, false);
+    const auto rhs = Transposed(ToMatrix(b, true));
+
+    if (lhs.cols != rhs.cols)
+        Error("matrix dimensions do not match");
+
+    Matrix c(lhs.rows, rhs.rows);
+
+    /* Convert each row once, instead of once for each of its dot products */
+    std::vector<PackedVector> lhsRows(lhs.rows), rhsRows(rhs.rows);
+
+    ParallelFor(
+        lhs.rows + rhs.rows, matParallelThreshold,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                if (i < lhs.rows)
+                    lhsRows[i] = PackVector(&lhs(i, 0), lhs.cols);
+                else
+                    rhsRows[i - lhs.rows] = PackVector(&rhs(i - lhs.rows, 0), rhs.cols);
+            }
+        }
+    );
+
+    ParallelFor(
+        lhs.rows, matParallelThreshold,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i0 = begin; i0 < end; i0 += matBlockSize)
+            {
+                const auto i1 = std::min(i0 + matBlockSize, end);
+
+                for (std::size_t j0 = 0; j0 < c.cols; j0 += matBlockSize)
+                {
+                    const auto j1 = std::min(j0 + matBlockSize, c.cols);
+
+                    for (auto i = i0; i < i1; ++i)
+                    {
+                        for (auto j = j0; j < j1; ++j)
+                            c(i, j) = DotProduct(lhsRows[i], rhsRows[j]);
+                    }
+                }
+            }
+        }
+    );
+
+    /* Products with vectors are vectors again, and the product of two vectors is a scalar */
+    if (a.IsVector() && b.IsVector())
+        return std::move(c.elements.front());
+    if (a.IsVector() || b.IsVector())
+        return Variable(std::move(c.elements));
+
+    return Variable(std::move(c));
+}
+
+Variable MatTranspose(const Variable& a)
+{
+    return Variable(Transposed(ToMatrix(a, false)));
+}
+
+Variable MatDet(const Matrix& a)
+{
+    RequireSquare(a);
+
+    const auto n = a.rows;
+    auto m = a;
+    int sign = 1;
+
+    if (IsExact(m))
+    {
+        if (!Eliminate(m, n, true, sign))
+            return Variable(int_precision(0));
+
+        auto det = std::move(m(n - 1, n - 1));
+        if (sign < 0)
+            det.Negate();
+
+        return det;
+    }
+
+    Variable det;
+    {
+        const auto prec = GuardDigits(n);
+        ScopedPrecision scope(prec);
+
+        Extend(m, prec);
+        if (!Eliminate(m, n, false, sign))
+            return Variable(int_precision(0));
+
+        /* Product of all pivots */
+        det = m(0, 0);
+        for (std::size_t k = 1; k < n; ++k)
+            det.Mul(m(k, k));
+
+        if (sign < 0)
+            det.Negate();
+    }
+
+    Round(det);
+
+    return det;
+}
+
+Variable MatInverse(const Matrix& a)
+{
+    RequireSquare(a);
+
+    Matrix identity(a.rows, a.rows);
+    for (std::size_t i = 0; i < a.rows; ++i)
+        identity(i, i) = Variable(int_precision(1));
+
+    return Variable(SolveColumns(a, identity));
+}
+
+Variable MatSolve(const Matrix& a, const Variable& b)
+{
+    auto x = SolveColumns(a, ToMatrix(b, true));
+
+    if (b.IsVector())
+        return Variable(std::move(x.elements));
+
+    return Variable(std::move(x));
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
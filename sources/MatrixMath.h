@@ -0,0 +1,49 @@
+/*
+ * MatrixMath.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_MATRIX_MATH_H__
+#define __AC_MATRIX_MATH_H__
+
+
+#include "Variable.h"
+
+
+namespace Ac
+{
+
+
+/*
+Linear algebra over matrices of scalars with the precision and rounding mode of the current float context.
+Matrices of integers and rationals are eliminated exactly with Bareiss' fraction-free algorithm,
+and all others by an LU decomposition with partial pivoting and guard digits, whose results are rounded once.
+Matrices with more than 32 rows distribute their rows over all hardware threads.
+*/
+
+//! Returns the matrix product a*b, where a vector is a row on the left side and a column on the right side.
+Variable MatMul(const Variable& a, const Variable& b);
+
+//! Returns the transposed matrix, or the column matrix of a vector.
+Variable MatTranspose(const Variable& a);
+
+//! Returns the determinant of a square matrix.
+Variable MatDet(const Matrix& a);
+
+//! Returns the inverse of a square matrix (throws if the matrix is singular).
+Variable MatInverse(const Matrix& a);
+
+//! Returns the solution x of a*x = b for a vector or matrix b (throws if the matrix is singular).
+Variable MatSolve(const Matrix& a, const Variable& b);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,608 @@
+/*
+ * MultiDouble.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_MULTI_DOUBLE_H__
+#define __AC_MULTI_DOUBLE_H__
+
+
+#include "precpkg/iprecision.h"
+#include "precpkg/fprecision.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+
+namespace Ac
+{
+
+
+/* --- Error-free transformations --- */
+
+// Returns s = fl(a + b) and the exact error e = a + b - s.
+inline double TwoSum(double a, double b, double& e)
+{
+    double s = a + b;
+    double t = s - a;
+    e = (a - (s - t)) + (b - t);
+    return s;
+}
+
+// Same as TwoSum, but requires |a| >= |b|.
+inline double FastTwoSum(double a, double b, double& e)
+{
+    double s = a + b;
+    e = b - (s - a);
+    return s;
+}
+
+// Returns p = fl(a * b) and the exact error e = a * b - p.
+inline double TwoProd(double a, double b, double& e)
+{
+    double p = a * b;
+    e = std::fma(a, b, -p);
+    return p;
+}
+
+
+/*
+Unevaluated sum of N doubles with decreasing magnitudes (floating-point expansion),
+i.e. a double-double for N = 2 (about 32 digits) and a quad-double for N = 4 (about 64 digits).
+All values are kept in registers or on the stack, no heap allocation is involved.
+*/
+template <int N>
+class MultiDouble
+{
+
+    public:
+
+        MultiDouble()
+        {
+            for (int i = 0; i < N; ++i)
+                c_[i] = 0.0;
+        }
+
+        MultiDouble(double x)
+        {
+            c_[0] = x;
+            for (int i = 1; i < N; ++i)
+                c_[i] = 0.0;
+        }
+
+        MultiDouble(int x) :
+            MultiDouble( static_cast<double>(x) )
+        {
+        }
+
+        MultiDouble(double hi, double lo)
+        {
+            c_[0] = hi;
+            c_[1] = lo;
+            for (int i = 2; i < N; ++i)
+                c_[i] = 0.0;
+        }
+
+        /**
+        Returns the renormalized sum of the first 'm' terms in 'x'.
+        The terms are sorted by decreasing magnitude, accumulated without error (VecSum),
+        and the leading N non-zero terms are extracted (VecSumErrBranch).
+        */
+        static MultiDouble Renormalize(double* x, int m)
+        {
+            for (int i = 1; i < m; ++i)
+            {
+                double v = x[i];
+                int j = i;
+                for (; j > 0 && std::abs(x[j - 1]) < std::abs(v); --j)
+                    x[j] = x[j - 1];
+                x[j] = v;
+            }
+
+            double s = x[m - 1];
+            for (int i = m - 2; i >= 0; --i)
+                s = TwoSum(x[i], s, x[i + 1]);
+            x[0] = s;
+
+            MultiDouble r;
+            int j = 0;
+            double eps = x[0];
+
+            for (int i = 1; i < m && j < N; ++i)
+            {
+                double e;
+                double t = TwoSum(eps, x[i], e);
+                if (e != 0.0)
+                {
+                    r.c_[j++] = t;
+                    eps = e;
+                }
+                else
+                    eps = t;
+            }
+
+            if (j < N)
+                r.c_[j] = eps;
+
+            return r;
+        }
+
+        double operator [] (int i) const
+        {
+            return c_[i];
+        }
+
+        MultiDouble operator - () const
+        {
+            MultiDouble r;
+            for (int i = 0; i < N; ++i)
+                r.c_[i] = -c_[i];
+            return r;
+        }
+
+        MultiDouble& operator += (const MultiDouble& rhs)
+        {
+            return (*this = *this + rhs);
+        }
+
+        MultiDouble& operator -= (const MultiDouble& rhs)
+        {
+            return (*this = *this - rhs);
+        }
+
+        MultiDouble& operator *= (const MultiDouble& rhs)
+        {
+            return (*this = *this * rhs);
+        }
+
+        MultiDouble& operator /= (const MultiDouble& rhs)
+        {
+            return (*this = *this / rhs);
+        }
+
+        //! Returns this value multiplied by a double.
+        MultiDouble Scale(double y) const
+        {
+            double x[2*N];
+            for (int i = 0; i < N; ++i)
+                x[2*i] = TwoProd(c_[i], y, x[2*i + 1]);
+            return Renormalize(x, 2*N);
+        }
+
+    private:
+
+        double c_[N];
+
+};
+
+using DoubleDouble  = MultiDouble<2>;
+using QuadDouble    = MultiDouble<4>;
+
+
+/* --- Arithmetic --- */
+
+template <int N>
+MultiDouble<N> operator + (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    double x[2*N];
+    for (int i = 0; i < N; ++i)
+    {
+        x[i] = a[i];
+        x[N + i] = b[i];
+    }
+    return MultiDouble<N>::Renormalize(x, 2*N);
+}
+
+template <int N>
+MultiDouble<N> operator - (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    return a + (-b);
+}
+
+template <int N>
+MultiDouble<N> operator * (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    /* Exact products of all terms up to order N-1, and the rounded products of order N */
+    double x[N*(N + 1) + N];
+    int m = 0;
+
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; i + j < N; ++j, m += 2)
+            x[m] = TwoProd(a[i], b[j], x[m + 1]);
+    }
+
+    for (int i = 1; i < N; ++i)
+        x[m++] = a[i] * b[N - i];
+
+    return MultiDouble<N>::Renormalize(x, m);
+}
+
+template <int N>
+MultiDouble<N> operator / (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    /* Long division with one double per quotient term */
+    double q[N + 1];
+    MultiDouble<N> r = a;
+
+    for (int i = 0; i <= N; ++i)
+    {
+        q[i] = r[0] / b[0];
+        r -= b.Scale(q[i]);
+    }
+
+    return MultiDouble<N>::Renormalize(q, N + 1);
+}
+
+template <int N>
+MultiDouble<N> operator / (const MultiDouble<N>& a, double b)
+{
+    /* Long division by a double, where each product is exact */
+    double q[N + 1];
+    MultiDouble<N> r = a;
+
+    for (int i = 0; i <= N; ++i)
+    {
+        double e;
+        q[i] = r[0] / b;
+        double p = TwoProd(q[i], b, e);
+        r -= MultiDouble<N>(p, e);
+    }
+
+    return MultiDouble<N>::Renormalize(q, N + 1);
+}
+
+/*
+Double-double arithmetic with the algorithms of Joldes, Muller and Popescu,
+"Tight and rigorous error bounds for basic building blocks of double-word arithmetic" (2017):
+the relative errors of addition, multiplication and division are below 3u^2, 4u^2 and 15u^2 (u = 2^-53).
+*/
+
+inline DoubleDouble operator + (const DoubleDouble& x, const DoubleDouble& y)
+{
+    double sl, tl, vl, zl;
+    double sh = TwoSum(x[0], y[0], sl);
+    double th = TwoSum(x[1], y[1], tl);
+    double vh = FastTwoSum(sh, sl + th, vl);
+    double zh = FastTwoSum(vh, tl + vl, zl);
+    return DoubleDouble(zh, zl);
+}
+
+inline DoubleDouble operator - (const DoubleDouble& x, const DoubleDouble& y)
+{
+    return x + (-y);
+}
+
+inline DoubleDouble operator * (const DoubleDouble& x, const DoubleDouble& y)
+{
+    double cl1, zl;
+    double ch = TwoProd(x[0], y[0], cl1);
+    double tl = std::fma(x[0], y[1], x[1] * y[1]);
+    double cl2 = std::fma(x[1], y[0], tl);
+    double zh = FastTwoSum(ch, cl1 + cl2, zl);
+    return DoubleDouble(zh, zl);
+}
+
+inline DoubleDouble operator / (const DoubleDouble& x, const DoubleDouble& y)
+{
+    double th = x[0] / y[0];
+
+    /* r = y * th */
+    double cl1, tl1, rl;
+    double ch = TwoProd(y[0], th, cl1);
+    double uh = FastTwoSum(ch, y[1] * th, tl1);
+    double rh = FastTwoSum(uh, tl1 + cl1, rl);
+
+    double d = (x[0] - rh) + (x[1] - rl);
+
+    double zl;
+    double zh = FastTwoSum(th, d / y[0], zl);
+    return DoubleDouble(zh, zl);
+}
+
+/* --- Comparison --- */
+
+template <int N>
+int Compare(const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    auto d = (a - b)[0];
+    return (d < 0.0 ? -1 : (d > 0.0 ? 1 : 0));
+}
+
+template <int N>
+bool operator == (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    return Compare(a, b) == 0;
+}
+
+template <int N>
+bool operator != (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    return Compare(a, b) != 0;
+}
+
+template <int N>
+bool operator < (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    return Compare(a, b) < 0;
+}
+
+template <int N>
+bool operator <= (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    return Compare(a, b) <= 0;
+}
+
+template <int N>
+bool operator > (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    return Compare(a, b) > 0;
+}
+
+template <int N>
+bool operator >= (const MultiDouble<N>& a, const MultiDouble<N>& b)
+{
+    return Compare(a, b) >= 0;
+}
+
+/* --- Rounding --- */
+
+template <int N>
+MultiDouble<N> ldexp(const MultiDouble<N>& x, int e)
+{
+    double c[N];
+    for (int i = 0; i < N; ++i)
+        c[i] = std::ldexp(x[i], e);
+    return MultiDouble<N>::Renormalize(c, N);
+}
+
+template <int N>
+MultiDouble<N> floor(const MultiDouble<N>& x)
+{
+    /* Lower terms are only relevant while the higher terms are integral */
+    double c[N] = { 0.0 };
+    for (int i = 0; i < N; ++i)
+    {
+        c[i] = std::floor(x[i]);
+        if (c[i] != x[i])
+            break;
+    }
+    return MultiDouble<N>::Renormalize(c, N);
+}
+
+template <int N>
+MultiDouble<N> ceil(const MultiDouble<N>& x)
+{
+    return -floor(-x);
+}
+
+template <int N>
+MultiDouble<N> fmod(const MultiDouble<N>& x, const MultiDouble<N>& y)
+{
+    auto q = x / y;
+    return x - y * (q < MultiDouble<N>(0) ? ceil(q) : floor(q));
+}
+
+/* --- Elementary functions --- */
+
+template <int N> MultiDouble<N> sqrt (const MultiDouble<N>& x) { return FastSqrt(x);  }
+template <int N> MultiDouble<N> exp  (const MultiDouble<N>& x) { return FastExp(x);   }
+template <int N> MultiDouble<N> log  (const MultiDouble<N>& x) { return FastLog(x);   }
+template <int N> MultiDouble<N> log10(const MultiDouble<N>& x) { return FastLog10(x); }
+template <int N> MultiDouble<N> sin  (const MultiDouble<N>& x) { return FastSin(x);   }
+template <int N> MultiDouble<N> cos  (const MultiDouble<N>& x) { return FastCos(x);   }
+template <int N> MultiDouble<N> tan  (const MultiDouble<N>& x) { return FastTan(x);   }
+template <int N> MultiDouble<N> asin (const MultiDouble<N>& x) { return FastAsin(x);  }
+template <int N> MultiDouble<N> acos (const MultiDouble<N>& x) { return FastAcos(x);  }
+template <int N> MultiDouble<N> atan (const MultiDouble<N>& x) { return FastAtan(x);  }
+template <int N> MultiDouble<N> sinh (const MultiDouble<N>& x) { return FastSinh(x);  }
+template <int N> MultiDouble<N> cosh (const MultiDouble<N>& x) { return FastCosh(x);  }
+template <int N> MultiDouble<N> tanh (const MultiDouble<N>& x) { return FastTanh(x);  }
+template <int N> MultiDouble<N> asinh(const MultiDouble<N>& x) { return FastAsinh(x); }
+template <int N> MultiDouble<N> acosh(const MultiDouble<N>& x) { return FastAcosh(x); }
+template <int N> MultiDouble<N> atanh(const MultiDouble<N>& x) { return FastAtanh(x); }
+
+template <int N> MultiDouble<N> atan2(const MultiDouble<N>& y, const MultiDouble<N>& x) { return FastAtan2(y, x); }
+template <int N> MultiDouble<N> pow  (const MultiDouble<N>& x, const MultiDouble<N>& y) { return FastPow(x, y);   }
+
+
+/* --- Traits --- */
+
+template <int N>
+struct FastTraits< MultiDouble<N> >
+{
+    using T = MultiDouble<N>;
+
+    //! Returns the maximal number of decimal digits which can be certified (28 for double-double, 56 for quad-double).
+    static unsigned int Digits()
+    {
+        return (N == 2 ? 28 : static_cast<unsigned int>(N * 14));
+    }
+
+    //! Returns a bound of the relative error of the arithmetic operations (2^-102 for double-double, 2^-200 for quad-double).
+    static double Unit()
+    {
+        return (N == 2 ? std::ldexp(1.0, -102) : std::ldexp(1.0, -50*N));
+    }
+
+    //! Returns the maximal error of the elementary functions (in ulps, with a margin over the observed errors).
+    static double FuncUlps()
+    {
+        return (N == 2 ? 16.0 : 4.0);
+    }
+
+    //! Returns the maximal relative error of a parsed literal.
+    static double ParseError()
+    {
+        return 64.0 * Unit();
+    }
+
+    //! Integers are only kept in the leading double, so they stay exact in all operations.
+    static double MaxInt()
+    {
+        return std::ldexp(1.0, 52);
+    }
+
+    static bool Parse(const std::string& s, T& x)
+    {
+        static const int maxDigits = 80, chunkDigits = 15;
+
+        std::size_t i = 0, n = s.size();
+        bool isNeg = false;
+
+        if (i < n && (s[i] == '-' || s[i] == '+'))
+            isNeg = (s[i++] == '-');
+
+        /* Accumulate mantissa in chunks of exact doubles, and ignore digits beyond the precision */
+        int numDigits = 0, exponent = 0, chunkLen = 0;
+        double chunk = 0.0;
+        bool hasDigits = false, hasPoint = false;
+        x = T(0);
+
+        for (; i < n; ++i)
+        {
+            char c = s[i];
+            if (c == '.' && !hasPoint)
+                hasPoint = true;
+            else if (c >= '0' && c <= '9')
+            {
+                hasDigits = true;
+                if (numDigits == 0 && c == '0')
+                {
+                    if (hasPoint)
+                        --exponent;
+                }
+                else if (numDigits < maxDigits)
+                {
+                    chunk = chunk * 10.0 + (c - '0');
+                    ++numDigits;
+                    if (hasPoint)
+                        --exponent;
+                    if (++chunkLen == chunkDigits)
+                    {
+                        x = x.Scale(1e15) + T(chunk);
+                        chunk = 0.0;
+                        chunkLen = 0;
+                    }
+                }
+                else if (!hasPoint)
+                    ++exponent;
+            }
+            else
+                break;
+        }
+
+        if (chunkLen > 0)
+            x = x.Scale(std::pow(10.0, chunkLen)) + T(chunk);
+
+        if (!hasDigits)
+            return false;
+
+        /* Decimal exponent */
+        if (i < n && (s[i] == 'E' || s[i] == 'e'))
+        {
+            char* end = nullptr;
+            long e = std::strtol(s.c_str() + i + 1, &end, 10);
+            if (end == s.c_str() + i + 1 || *end != '\0' || e > 400 || e < -400)
+                return false;
+            exponent += static_cast<int>(e);
+        }
+        else if (i < n)
+            return false;
+
+        if (exponent != 0)
+        {
+            if (exponent > 400 || exponent < -400)
+                return false;
+
+            /* Power of ten by squaring */
+            T p(1), b(10);
+            for (int e = std::abs(exponent); e > 0; e >>= 1)
+            {
+                if (e & 1)
+                    p *= b;
+                if (e > 1)
+                    b *= b;
+            }
+
+            x = (exponent > 0 ? x * p : x / p);
+        }
+
+        if (isNeg)
+            x = -x;
+
+        return true;
+    }
+
+    static double ToDouble(const T& x)
+    {
+        return x[0];
+    }
+
+    static float_precision ToFloat(const T& x, unsigned int digits)
+    {
+        /* Each term only needs the digits which are left after the previous terms (about 15 per term) */
+        float_precision r(0, digits + 2, ROUND_NEAR);
+        char buf[128];
+
+        for (int i = 0; i < N && x[i] != 0.0; ++i)
+        {
+            int termDigits = std::max(static_cast<int>(digits) - 15*i, 17);
+            std::snprintf(buf, sizeof(buf), "%.*e", termDigits - 1, x[i]);
+            r += float_precision(buf, digits + 2, ROUND_NEAR);
+        }
+
+        r.precision(digits);
+        return r;
+    }
+
+    static int_precision ToInt(const T& x)
+    {
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "%.0f", x[0] + 0.0);
+        return int_precision(buf);
+    }
+
+    static T Pi()
+    {
+        static const double c[4] = { 3.141592653589793, 1.2246467991473532e-16, -2.9947698097183397e-33, 1.1124542208633653e-49 };
+        return Terms(c);
+    }
+
+    static T Ln2()
+    {
+        static const double c[4] = { 0.6931471805599453, 2.3190468138462996e-17, 5.707708438416212e-34, -3.5824322106018114e-50 };
+        return Terms(c);
+    }
+
+    static T Ln10()
+    {
+        static const double c[4] = { 2.302585092994046, -2.1707562233822494e-16, -9.984262454465777e-33, -4.023357454450206e-49 };
+        return Terms(c);
+    }
+
+    private:
+
+        static T Terms(const double* c)
+        {
+            double x[N];
+            for (int i = 0; i < N; ++i)
+                x[i] = (i < 4 ? c[i] : 0.0);
+            return T::Renormalize(x, N);
+        }
+};
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,275 @@
+/*
+ * Parallel.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "Parallel.h"
+#include "precpkg/fprecision.h"
+
+#include <chrono>
+#include <system_error>
+
+
+namespace Ac
+{
+
+
+static const std::size_t noWorker = ~std::size_t(0);
+
+// Index of the worker (and its queue), which runs on the current thread.
+static thread_local std::size_t workerIndex = noWorker;
+
+
+/*
+ * TaskPool class
+ */
+
+TaskPool::TaskPool() :
+    nextQueue_  ( 0 ),
+    numPending_ ( 0 )
+{
+    const auto numHardwareThreads = std::thread::hardware_concurrency();
+    const std::size_t numWorkers = (numHardwareThreads > 1 ? numHardwareThreads - 1 : 0);
+
+    /* Create all queues before any worker can steal from them */
+    for (std::size_t i = 0; i < numWorkers; ++i)
+        queues_.emplace_back(new Queue());
+
+    /* Start workers (the tasks of queues without worker are stolen by the others) */
+    for (std::size_t i = 0; i < numWorkers; ++i)
+    {
+        try
+        {
+            workers_.emplace_back(&TaskPool::RunWorker, this, i);
+        }
+        catch (const std::system_error&)
+        {
+            break;
+        }
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex_);
+        quit_ = true;
+    }
+    wakeUp_.notify_all();
+
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+TaskPool& TaskPool::Get()
+{
+    static TaskPool pool;
+    return pool;
+}
+
+void TaskPool::Submit(Task task)
+{
+    if (workers_.empty())
+    {
+        task();
+        return;
+    }
+
+    const auto index = (workerIndex < queues_.size() ? workerIndex : (nextQueue_++) % queues_.size());
+
+    /* Count the task first, so it is never popped before it is counted */
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex_);
+        ++numPending_;
+    }
+
+    {
+        auto& queue = *queues_[index];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    wakeUp_.notify_one();
+}
+
+bool TaskPool::RunPendingTask()
+{
+    Task task;
+    if (!PopTask(task))
+        return false;
+    task();
+    return true;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+bool TaskPool::PopTask(Task& task)
+{
+    if (numPending_.load() == 0)
+        return false;
+
+    const auto numQueues = queues_.size();
+
+    /* Pop newest task of the own queue, whose data is most likely still in the cache */
+    if (workerIndex < numQueues)
+    {
+        auto& queue = *queues_[workerIndex];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --numPending_;
+            return true;
+        }
+    }
+
+    /* Steal oldest task of another queue, which is usually the largest portion of work */
+    const auto first = (workerIndex < numQueues ? workerIndex + 1 : 0);
+
+    for (std::size_t i = 0; i < numQueues; ++i)
+    {
+        auto& queue = *queues_[(first + i) % numQueues];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --numPending_;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TaskPool::RunWorker(std::size_t index)
+{
+    workerIndex = index;
+
+    while (true)
+    {
+        if (RunPendingTask())
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeUp_.wait(lock, [this]() { return (quit_ || numPending_.load() > 0); });
+
+        if (quit_)
+            break;
+    }
+}
+
+
+/*
+ * TaskGroup class
+ */
+
+TaskGroup::~TaskGroup()
+{
+    WaitAll();
+}
+
+void TaskGroup::Run(std::function<void()> task)
+{
+    auto state = state_;
+    std::size_t index = 0;
+
+    {
+        std::lock_guard<std::mutex> guard(state->mutex);
+        index = state->errors.size();
+        state->errors.emplace_back();
+        ++state->numRunning;
+    }
+
+    const auto precision    = float_precision_ctrl.precision();
+    const auto mode         = float_precision_ctrl.mode();
+
+    TaskPool::Get().Submit(
+        [state, index, precision, mode, task]()
+        {
+            /* Run task with the float context of the submitting thread, and restore the one of this thread */
+            const auto prevPrecision    = float_precision_ctrl.precision();
+            const auto prevMode         = float_precision_ctrl.mode();
+
+            float_precision_ctrl.precision(precision);
+            float_precision_ctrl.mode(mode);
+
+            std::exception_ptr error;
+
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            float_precision_ctrl.precision(prevPrecision);
+            float_precision_ctrl.mode(prevMode);
+
+            std::lock_guard<std::mutex> guard(state->mutex);
+            state->errors[index] = error;
+            if (--state->numRunning == 0)
+                state->done.notify_all();
+        }
+    );
+}
+
+void TaskGroup::Wait()
+{
+    WaitAll();
+
+    std::vector<std::exception_ptr> errors;
+    {
+        std::lock_guard<std::mutex> guard(state_->mutex);
+        errors.swap(state_->errors);
+    }
+
+    for (const auto& err : errors)
+    {
+        if (err)
+            std::rethrow_exception(err);
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void TaskGroup::WaitAll()
+{
+    auto& pool = TaskPool::Get();
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> guard(state_->mutex);
+            if (state_->numRunning == 0)
+                return;
+        }
+
+        /* Help with pending tasks, or sleep until the tasks of this group are done or new tasks might be stolen */
+        if (!pool.RunPendingTask())
+        {
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            state_->done.wait_for(lock, std::chrono::milliseconds(1), [this]() { return (state_->numRunning == 0); });
+        }
+    }
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
@@ -0,0 +1,168 @@
+/*
+ * Parallel.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_PARALLEL_H__
+#define __AC_PARALLEL_H__
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Ac
+{
+
+
+/**
+Pool of worker threads (one for each hardware thread, except the calling one), which is started on first use.
+Each worker runs the tasks of its own queue in LIFO order, and steals the oldest tasks of the other queues when it runs out of work.
+*/
+class TaskPool
+{
+
+    public:
+
+        using Task = std::function<void()>;
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator = (const TaskPool&) = delete;
+
+        ~TaskPool();
+
+        //! Returns the pool, which is shared by all threads.
+        static TaskPool& Get();
+
+        //! Returns the number of threads, which can run tasks at once (i.e. the workers and the calling thread).
+        std::size_t NumThreads() const
+        {
+            return (workers_.size() + 1);
+        }
+
+        /**
+        Adds the task to the queue of the current worker, or to the queues of all workers in turn if it is called by another thread.
+        If the pool has no workers, the task is run immediately.
+        */
+        void Submit(Task task);
+
+        //! Runs one pending task on the calling thread, and returns false if there was none.
+        bool RunPendingTask();
+
+    private:
+
+        struct Queue
+        {
+            std::mutex          mutex;
+            std::deque<Task>    tasks;
+        };
+
+        TaskPool();
+
+        // Pops the newest task of the own queue (if the thread is a worker), or steals the oldest task of another queue.
+        bool PopTask(Task& task);
+
+        void RunWorker(std::size_t index);
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread>            workers_;
+
+        std::atomic<std::size_t>            nextQueue_;
+        std::atomic<std::size_t>            numPending_;
+
+        std::mutex                          sleepMutex_;
+        std::condition_variable             wakeUp_;
+        bool                                quit_       = false;
+
+};
+
+/**
+Group of tasks on the shared pool, whose completion can be awaited.
+Each task runs with the float precision and rounding mode, which the submitting thread had in 'Run' (they are thread-local).
+While a thread waits for the group, it runs pending tasks of the pool, so tasks can run and await groups themselves.
+*/
+class TaskGroup
+{
+
+    public:
+
+        TaskGroup() = default;
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator = (const TaskGroup&) = delete;
+
+        //! Waits for all tasks, but discards their exceptions.
+        ~TaskGroup();
+
+        //! Submits the task to the pool.
+        void Run(std::function<void()> task);
+
+        //! Waits for all tasks, and rethrows the exception of the first submitted task which failed.
+        void Wait();
+
+    private:
+
+        struct State
+        {
+            std::mutex                      mutex;
+            std::condition_variable         done;
+            std::size_t                     numRunning  = 0;
+            std::vector<std::exception_ptr> errors;
+        };
+
+        void WaitAll();
+
+        std::shared_ptr<State> state_ = std::make_shared<State>();
+
+};
+
+/**
+Calls 'func(begin, end)' for consecutive index ranges which cover [0, n).
+With at least 'threshold' indices the ranges are processed by the shared pool, otherwise 'func(0, n)' is called directly.
+Each range runs with the float precision and rounding mode of the calling thread (which are thread-local),
+and the first exception of all ranges is rethrown in the calling thread.
+*/
+template <typename Func>
+void ParallelFor(std::size_t n, std::size_t threshold, const Func& func)
+{
+    const auto numThreads = std::min(TaskPool::Get().NumThreads(), n);
+
+    if (n < threshold || numThreads < 2)
+    {
+        func(0, n);
+        return;
+    }
+
+    const auto chunkSize = (n + numThreads - 1) / numThreads;
+
+    TaskGroup group;
+
+    for (std::size_t begin = 0; begin < n; begin += chunkSize)
+    {
+        const auto end = std::min(begin + chunkSize, n);
+        group.Run([&func, begin, end]() { func(begin, end); });
+    }
+
+    group.Wait();
+}
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -60,9 +60,11 @@ std::string Parser::GetContextInfo() const
     return "syntax";
 }
 
-bool Parser::IsFuncIdent(const std::string& ident) const
+bool Parser::IsFuncIdent(const std::string& ident, const FunctionDesc* func) const
 {
-    return funcFilter_ != nullptr && funcFilter_(ident);
+    if (funcFilter_ != nullptr)
+        return funcFilter_(ident);
+    return (func != nullptr && func->numParams == 1);
 }
 
 void Parser::ErrorUnexpected()
@@ -129,8 +131,9 @@ ExprPtr Parser::ParseDef(const ExprPtr& identExpr)
 
     auto ast = Make<DefExpr>();
             
-    ast->ident = static_cast<IdentExpr*>(identExpr.get())->value;
-    ast->expr = Parse();
+    ast->ident  = static_cast<IdentExpr*>(identExpr.get())->value;
+    ast->symbol = static_cast<IdentExpr*>(identExpr.get())->symbol;
+    ast->expr   = Parse();
 
     return ast;
 }
@@ -306,26 +309,31 @@ ExprPtr Parser::ParseIdentExpr()
 {
     auto value = Accept(Tokens::Ident)->Spell();
 
+    /* Intern identifier and resolve function only once */
+    auto symbol = InternSymbol(value);
+    auto func = FindFunction(symbol);
+
     if (!Is(Tokens::OpenBracket))
     {
-        if (IsFuncIdent(value) || Is(Tokens::Ident) || Is(Tokens::FloatLiteral) || Is(Tokens::IntLiteral) || Is(Tokens::OpenParen))
+        if (IsFuncIdent(value, func) || Is(Tokens::Ident) || Is(Tokens::FloatLiteral) || Is(Tokens::IntLiteral) || Is(Tokens::OpenParen))
         {
             /* Create function expression */
-            return ParseFuncExpr(std::move(value), true);
+            return ParseFuncExpr(std::move(value), func, true);
         }
         else
         {
             /* Create identifier expression */
             auto ast = Make<IdentExpr>();
 
-            ast->value = value;
+            ast->value  = value;
+            ast->symbol = symbol;
 
             return ast;
         }
     }
 
     /* Create function expression */
-    return ParseFuncExpr(std::move(value));
+    return ParseFuncExpr(std::move(value), func);
 }
 
 // norm_expr: '|' expr '|';
@@ -355,7 +363,8 @@ ExprPtr Parser::ParseFoldExpr()
     
     Accept(Tokens::OpenParen);
 
-    ast->index = Accept(Tokens::Ident)->Spell();
+    ast->index          = Accept(Tokens::Ident)->Spell();
+    ast->indexSymbol    = InternSymbol(ast->index);
 
     Accept(Tokens::Equal);
     ast->initExpr = ParseExpr();
@@ -385,11 +394,12 @@ ExprPtr Parser::ParseVectorExpr()
 }
 
 // func_expr: IDENT (argument_list | value_expr);
-ExprPtr Parser::ParseFuncExpr(std::string&& name, bool singleParam)
+ExprPtr Parser::ParseFuncExpr(std::string&& name, const FunctionDesc* func, bool singleParam)
 {
     auto ast = Make<FuncExpr>();
 
     ast->name = name;
+    ast->func = func;
 
     if (Is(Tokens::Equal))
         Error("can not assign value to function name");
@@ -410,12 +420,12 @@ ExprPtr Parser::ParseFuncExpr(std::string&& name, bool singleParam)
 ExprPtr Parser::BuildBinaryExprTree(std::vector<ExprPtr>& exprs, std::vector<BinaryExpr::Operators>& ops)
 {
     if (exprs.empty())
-        ErrorInternal("sub-expressions must not be empty (" __FUNCTION__ ")");
+        ErrorInternal("sub-expressions must not be empty (" + std::string(__FUNCTION__) + ")");
 
     if (exprs.size() > 1)
     {
         if (exprs.size() != ops.size() + 1)
-            ErrorInternal("sub-expressions and operators have uncorrelated number of elements (" __FUNCTION__ ")");
+            ErrorInternal("sub-expressions and operators have uncorrelated number of elements (" + std::string(__FUNCTION__) + ")");
 
         auto ast = Make<BinaryExpr>();
 
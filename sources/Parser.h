@@ -52,8 +52,8 @@ class Parser : public ExprProcessor
 
         std::string GetContextInfo() const override;
 
-        //! Returns true, if the specified identifier denotes a pre-defined function.
-        bool IsFuncIdent(const std::string& ident) const;
+        //! Returns true, if the specified identifier denotes a function, which can be called without brackets.
+        bool IsFuncIdent(const std::string& ident, const FunctionDesc* func) const;
 
         void ErrorUnexpected();
 
@@ -120,7 +120,7 @@ class Parser : public ExprProcessor
         ExprPtr ParseFoldExpr();
         ExprPtr ParseVectorExpr();
 
-        ExprPtr ParseFuncExpr(std::string&& name, bool singleParam = false);
+        ExprPtr ParseFuncExpr(std::string&& name, const FunctionDesc* func, bool singleParam = false);
 
         ExprPtr BuildBinaryExprTree(std::vector<ExprPtr>& exprs, std::vector<BinaryExpr::Operators>& ops);
 
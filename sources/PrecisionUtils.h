@@ -0,0 +1,87 @@
+/*
+ * PrecisionUtils.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_PRECISION_UTILS_H__
+#define __AC_PRECISION_UTILS_H__
+
+
+#include "ComplexMath.h"
+
+
+namespace Ac
+{
+
+
+//! Sets the working precision of the current thread, and restores the previous one when it goes out of scope.
+class ScopedPrecision
+{
+
+    public:
+
+        ScopedPrecision(unsigned int prec) :
+            precision_( float_precision_ctrl.precision() )
+        {
+            float_precision_ctrl.precision(prec);
+        }
+        ~ScopedPrecision()
+        {
+            float_precision_ctrl.precision(precision_);
+        }
+
+        ScopedPrecision(const ScopedPrecision&) = delete;
+        ScopedPrecision& operator = (const ScopedPrecision&) = delete;
+
+    private:
+
+        unsigned int precision_;
+
+};
+
+inline bool IsZero(const float_precision& x)
+{
+    const auto& m = *x.ref_mantissa();
+    return m.size() == 2 && m[1] == '0';
+}
+
+inline bool IsZero(const complex_float& x)
+{
+    return IsZero(x.real()) && IsZero(x.imag());
+}
+
+//! Returns the value with the given precision (without rounding if it is at least the precision of the value).
+inline float_precision Extended(const float_precision& x, unsigned int prec)
+{
+    float_precision y(0, prec, float_precision_ctrl.mode());
+    y = x;
+    return y;
+}
+
+//! Returns the value rounded to the working precision.
+inline float_precision Rounded(const float_precision& x)
+{
+    return Extended(x, float_precision_ctrl.precision());
+}
+
+inline complex_float Extended(const complex_float& x, unsigned int prec)
+{
+    return complex_float(Extended(x.real(), prec), Extended(x.imag(), prec));
+}
+
+inline complex_float Rounded(const complex_float& x)
+{
+    return complex_float(Rounded(x.real()), Rounded(x.imag()));
+}
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
@@ -206,7 +206,7 @@ TokenPtr Scanner::ScanIdentifier()
         spell += TakeIt();
         
     /* Scan reserved words */
-    if (spell == "mod")
+    if (spell == "mod" || spell == "div")
         return Make(Token::Types::DivOp, spell);
     if (spell == "sum" || spell == "product")
         return Make(Token::Types::FoldFunc, spell);
@@ -0,0 +1,93 @@
+/*
+ * Symbol.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Abacus/Symbol.h>
+
+#include <cctype>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+
+namespace Ac
+{
+
+
+// Table of all interned identifiers, whose strings keep their addresses while the table grows.
+struct SymbolTable
+{
+    std::mutex                              mutex;
+    std::unordered_map<std::string, Symbol> symbols;
+    std::deque<std::string>                 names;
+};
+
+static SymbolTable& GetSymbolTable()
+{
+    static SymbolTable table;
+    return table;
+}
+
+AC_EXPORT Symbol InternSymbol(const std::string& ident)
+{
+    auto& table = GetSymbolTable();
+    std::lock_guard<std::mutex> guard(table.mutex);
+
+    auto it = table.symbols.find(ident);
+    if (it != table.symbols.end())
+        return it->second;
+
+    const auto symbol = static_cast<Symbol>(table.names.size());
+
+    table.names.push_back(ident);
+    table.symbols.emplace(ident, symbol);
+
+    return symbol;
+}
+
+AC_EXPORT bool FindSymbol(const std::string& ident, Symbol& symbol)
+{
+    auto& table = GetSymbolTable();
+    std::lock_guard<std::mutex> guard(table.mutex);
+
+    auto it = table.symbols.find(ident);
+    if (it == table.symbols.end())
+        return false;
+
+    symbol = it->second;
+    return true;
+}
+
+AC_EXPORT const std::string& SymbolName(Symbol symbol)
+{
+    static const std::string invalidName;
+
+    auto& table = GetSymbolTable();
+    std::lock_guard<std::mutex> guard(table.mutex);
+
+    return (symbol < table.names.size() ? table.names[symbol] : invalidName);
+}
+
+AC_EXPORT bool IsIdentifier(const std::string& s)
+{
+    if (s.empty() || !(std::isalpha(static_cast<unsigned char>(s[0])) || s[0] == '_'))
+        return false;
+
+    for (auto chr : s)
+    {
+        if (!(std::isalnum(static_cast<unsigned char>(chr)) || chr == '_'))
+            return false;
+    }
+
+    return (s != "mod" && s != "div" && s != "sum" && s != "product");
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
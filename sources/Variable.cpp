@@ -6,6 +6,9 @@
  */
 
 #include "Variable.h"
+#include "VectorMath.h"
+
+#include <algorithm>
 
 
 namespace Ac
@@ -17,21 +20,150 @@ static void Error(const std::string& msg)
     throw std::runtime_error("math error: " + msg);
 }
 
-Variable::Variable(std::vector<Variable>&& vector) :
-    vector_( std::move(vector) )
+// Returns the payload for modification, and clones it first if it is shared with other values.
+template <typename T>
+static T& Unshared(std::shared_ptr<T>& payload)
+{
+    if (payload.use_count() > 1)
+        payload = std::make_shared<T>(*payload);
+    return *payload;
+}
+
+Variable::Variable() :
+    int_()
+{
+}
+
+Variable::Variable(const Variable& rhs)
+{
+    CopyFrom(rhs);
+}
+
+Variable::Variable(Variable&& rhs)
+{
+    MoveFrom(rhs);
+}
+
+Variable::Variable(std::vector<Variable>&& vector)
+{
+    /* Empty vectors are scalars with value zero */
+    if (vector.empty())
+        new (&int_) std::shared_ptr<int_precision>();
+    else
+    {
+        new (&vector_) std::shared_ptr<std::vector<Variable>>(std::make_shared<std::vector<Variable>>(std::move(vector)));
+        type_ = Type::Vector;
+    }
+}
+
+Variable::Variable(Matrix&& matrix) :
+    matrix_ ( std::make_shared<Matrix>(std::move(matrix)) ),
+    type_   ( Type::Matrix                  )
 {
 }
 
 Variable::Variable(const int_precision& iprec) :
-    iprec_  ( iprec ),
-    isFloat_( false )
+    int_( std::make_shared<int_precision>(iprec) )
+{
+}
+
+Variable::Variable(int_precision&& iprec) :
+    int_( std::make_shared<int_precision>(std::move(iprec)) )
 {
 }
 
 Variable::Variable(const float_precision& fprec) :
-    fprec_  ( fprec ),
-    isFloat_( true  )
+    float_( std::make_shared<float_precision>(fprec) ),
+    type_ ( Type::Float                              )
+{
+}
+
+Variable::Variable(float_precision&& fprec) :
+    float_( std::make_shared<float_precision>(std::move(fprec)) ),
+    type_ ( Type::Float                                         )
+{
+}
+
+Variable::Variable(const complex_float& cprec) :
+    complex_( std::make_shared<complex_float>(cprec) ),
+    type_   ( Type::Complex                          )
+{
+    NormalizeComplex();
+}
+
+Variable::~Variable()
+{
+    Destroy();
+}
+
+Variable& Variable::operator = (const Variable& rhs)
+{
+    if (this != &rhs)
+    {
+        /* Copy first, since 'rhs' may be a component of this vector */
+        Variable tmp(rhs);
+        Destroy();
+        MoveFrom(tmp);
+    }
+    return *this;
+}
+
+Variable& Variable::operator = (Variable&& rhs)
+{
+    if (this != &rhs)
+    {
+        Variable tmp(std::move(rhs));
+        Destroy();
+        MoveFrom(tmp);
+    }
+    return *this;
+}
+
+// Returns the number of digits from which on rationals are materialized as floats (to bound the costs of exact arithmetic).
+static std::size_t MaxRationalLength()
+{
+    return std::max(256u, 2u * float_precision_ctrl.precision());
+}
+
+// Returns the number of characters of the integer (including its sign).
+static std::size_t Length(const int_precision& x)
+{
+    return static_cast<std::size_t>(x.size());
+}
+
+static bool IsSmallInt(const int_precision& x)
 {
+    /* Fits into 64 bits with sign character and up to 18 digits */
+    return x.size() <= 19;
+}
+
+static int_precision Gcd(int_precision a, int_precision b)
+{
+    a = abs(a);
+    b = abs(b);
+
+    /* Fast path for numbers that fit into machine words */
+    if (IsSmallInt(a) && IsSmallInt(b))
+    {
+        auto x = static_cast<unsigned long>(a);
+        auto y = static_cast<unsigned long>(b);
+        while (y != 0)
+        {
+            auto r = x % y;
+            x = y;
+            y = r;
+        }
+        return int_precision(x);
+    }
+
+    while (b != int_precision(0))
+    {
+        auto r = a % b;
+        a = std::move(b);
+        b = std::move(r);
+    }
+
+    return a;
 }
 
 /* --- Scalar functions --- */
@@ -41,48 +173,180 @@ static bool IsStrFloat(const std::string& s)
     return s.find('.') != std::string::npos || s.find('E') != std::string::npos;
 }
 
-Variable::Variable(const std::string& value) :
-    isFloat_( IsStrFloat(value) )
+static bool IsStrComplex(const std::string& s)
+{
+    return !s.empty() && s.back() == 'i';
+}
+
+// Parses a complex number of the form "a+bi", "bi", or "a+(b)i" (like the results of the formatter).
+static complex_float ParseComplex(const std::string& value)
+{
+    std::string s;
+    for (auto c : value)
+    {
+        if (c != '(' && c != ')' && c != ' ' && c != 'i')
+            s += c;
+    }
+
+    /* Split at the sign of the imaginary part, which is neither the leading sign nor the sign of an exponent */
+    std::size_t pos = 0;
+    for (std::size_t i = 1; i < s.size(); ++i)
+    {
+        if ((s[i] == '+' || s[i] == '-') && s[i - 1] != 'E')
+            pos = i;
+    }
+
+    auto re = s.substr(0, pos);
+    auto im = s.substr(pos);
+
+    if (im.empty() || im == "+" || im == "-")
+        im += "1";
+
+    return complex_float(
+        float_precision(re.empty() ? "0" : re.c_str()),
+        float_precision(im.c_str())
+    );
+}
+
+Variable::Variable(const std::string& value)
 {
-    
-    if (isFloat_)
-        fprec_ = float_precision(value.c_str());
+    if (IsStrComplex(value))
+    {
+        new (&complex_) std::shared_ptr<complex_float>(std::make_shared<complex_float>(ParseComplex(value)));
+        type_ = Type::Complex;
+        NormalizeComplex();
+    }
+    else if (IsStrFloat(value))
+    {
+        new (&float_) std::shared_ptr<float_precision>(std::make_shared<float_precision>(value.c_str()));
+        type_ = Type::Float;
+    }
     else
-        iprec_ = int_precision(value.c_str());
+        new (&int_) std::shared_ptr<int_precision>(std::make_shared<int_precision>(value.c_str()));
 }
 
 void Variable::Add(Variable& rhs)
 {
+    if (Broadcast(rhs, &Variable::Add))
+        return;
+
     Unify(rhs);
-    if (isFloat_)
-        fprec_ += rhs.fprec_;
+    if (IsComplex())
+    {
+        Complex() += *rhs.complex_;
+        NormalizeComplex();
+    }
+    else if (IsFloat())
+        Float() += *rhs.float_;
+    else if (IsRational())
+        AddRational(rhs.rational_->num, rhs.rational_->denom);
     else
-        iprec_ += rhs.iprec_;
+        Int() += rhs.GetInt();
 }
 
 void Variable::Sub(Variable& rhs)
 {
+    if (Broadcast(rhs, &Variable::Sub))
+        return;
+
     Unify(rhs);
-    if (isFloat_)
-        fprec_ -= rhs.fprec_;
+    if (IsComplex())
+    {
+        Complex() -= *rhs.complex_;
+        NormalizeComplex();
+    }
+    else if (IsFloat())
+        Float() -= *rhs.float_;
+    else if (IsRational())
+        AddRational(-rhs.rational_->num, rhs.rational_->denom);
     else
-        iprec_ -= rhs.iprec_;
+        Int() -= rhs.GetInt();
 }
 
 void Variable::Mul(Variable& rhs)
 {
+    if (Broadcast(rhs, &Variable::Mul))
+        return;
+
     Unify(rhs);
-    if (isFloat_)
-        fprec_ *= rhs.fprec_;
+    if (IsComplex())
+    {
+        SetComplex(ComplexMul(*complex_, *rhs.complex_));
+        NormalizeComplex();
+    }
+    else if (IsFloat())
+        Float() *= *rhs.float_;
+    else if (IsRational())
+    {
+        auto& r = Rat();
+        r.num *= rhs.rational_->num;
+        r.denom *= rhs.rational_->denom;
+        NormalizeRational();
+    }
     else
-        iprec_ *= rhs.iprec_;
+        Int() *= rhs.GetInt();
 }
 
 void Variable::Div(Variable& rhs)
 {
-    ToFloat();
-    rhs.ToFloat();
-    fprec_ /= rhs.fprec_;
+    if (Broadcast(rhs, &Variable::Div))
+        return;
+
+    if (IsComplex() || rhs.IsComplex())
+    {
+        Unify(rhs);
+        SetComplex(ComplexDiv(*complex_, *rhs.complex_));
+        NormalizeComplex();
+        return;
+    }
+
+    const auto maxLen = MaxRationalLength();
+
+    if ( IsFloat() || rhs.IsFloat() ||
+         Length(GetInt()) > maxLen || Length(rhs.GetInt()) > maxLen ||
+         Length(GetDenom()) > maxLen || Length(rhs.GetDenom()) > maxLen )
+    {
+        ToFloat();
+        rhs.ToFloat();
+        Float() /= *rhs.float_;
+        return;
+    }
+
+    if (rhs.GetInt() == int_precision(0))
+        throw int_precision::divide_by_zero();
+
+    if (!IsRational() && !rhs.IsRational())
+    {
+        /* Keep integral quotients of integers as integers */
+        if (GetInt() % rhs.GetInt() == int_precision(0))
+        {
+            Int() /= rhs.GetInt();
+            return;
+        }
+    }
+
+    /* (a/b) / (c/d) = (a*d) / (b*c) */
+    ToRational();
+    rhs.ToRational();
+
+    auto& r = Rat();
+    r.num *= rhs.rational_->denom;
+    r.denom *= rhs.rational_->num;
+    NormalizeRational();
+}
+
+void Variable::IntDiv(Variable& rhs)
+{
+    ToInt();
+    rhs.ToInt();
+
+    /* Round the quotient down whenever 'Mod' corrects the remainder, so that a = (a div b)*b + (a mod b) */
+    auto& a = Int();
+    auto r = a % rhs.GetInt();
+    a /= rhs.GetInt();
+
+    if (r < 0)
+        a -= 1;
 }
 
 void Variable::Mod(Variable& rhs)
@@ -90,26 +354,96 @@ void Variable::Mod(Variable& rhs)
     ToInt();
     rhs.ToInt();
 
-    iprec_ %= rhs.iprec_;
+    auto& a = Int();
+    a %= rhs.GetInt();
 
-    if (iprec_ < "0")
-        iprec_ += rhs.iprec_;
+    if (a < "0")
+        a += rhs.GetInt();
 }
 
 void Variable::Pow(Variable& rhs)
 {
+    RequireScalar();
+    rhs.RequireScalar();
+
+    if ( (type_ == Type::Int || IsRational()) && rhs.type_ == Type::Int &&
+         (IsRational() || rhs.GetInt() < int_precision(0)) && GetInt() != int_precision(0) )
+    {
+        /* Exact powers of rationals with integral exponents, if the result stays small enough */
+        const auto maxLen = MaxRationalLength();
+        auto k = abs(rhs.GetInt());
+
+        if (IsSmallInt(k) && static_cast<unsigned long>(k) <= maxLen && static_cast<unsigned long>(k) * std::max(Length(GetInt()), Length(GetDenom())) <= maxLen)
+        {
+            ToRational();
+            auto& r = Rat();
+            if (rhs.GetInt() < int_precision(0))
+            {
+                std::swap(r.num, r.denom);
+                r.reducedLen = 0;
+            }
+            r.num = ipow(r.num, k);
+            r.denom = ipow(r.denom, k);
+            NormalizeRational();
+            return;
+        }
+    }
+
+    /* Principal values of negative real bases with fractional exponents, whose angles are reduced with the exact exponents */
+    if ( !IsComplex() && IsNegative() &&
+         (rhs.IsRational() || (rhs.IsFloat() && floor(*rhs.float_) != *rhs.float_)) )
+    {
+        ToFloat();
+        if (rhs.IsRational())
+            SetComplex(ComplexPowNegativeReal(*float_, rhs.GetInt(), rhs.GetDenom()));
+        else
+            SetComplex(ComplexPowNegativeReal(*float_, *rhs.float_));
+        NormalizeComplex();
+        return;
+    }
+
+    /* Rational exponents, and rational bases that would grow too large, are raised as floats */
+    if (IsRational() || rhs.IsRational())
+    {
+        if (!IsComplex())
+            ToFloat();
+        if (!rhs.IsComplex())
+            rhs.ToFloat();
+    }
+
+    /* Complex powers, which are also the principal values of negative bases with fractional exponents */
+    if (IsComplex() || rhs.IsComplex() || (IsNegative() && rhs.IsFloat() && floor(*rhs.float_) != *rhs.float_))
+    {
+        ToComplex();
+        if (!rhs.IsComplex() && (!rhs.IsFloat() || floor(*rhs.float_) == *rhs.float_))
+        {
+            rhs.ToInt();
+            SetComplex(ComplexPow(*complex_, rhs.GetInt()));
+        }
+        else
+        {
+            rhs.ToComplex();
+            SetComplex(ComplexPow(*complex_, *rhs.complex_));
+        }
+        NormalizeComplex();
+        return;
+    }
+
     Unify(rhs);
-    if (isFloat_)
-        fprec_ = pow(fprec_, rhs.fprec_);
+    if (IsFloat())
+    {
+        auto& x = Float();
+        x = pow(x, *rhs.float_);
+    }
     else
     {
-        if (rhs.iprec_ < 0)
+        if (rhs.GetInt() < int_precision(0))
         {
             ToFloat();
             Pow(rhs);
         }
         else
-            iprec_ = ipow(iprec_, rhs.iprec_);
+            SetInt(ipow(GetInt(), rhs.GetInt()));
     }
 }
 
@@ -117,52 +451,112 @@ void Variable::LShift(Variable& rhs)
 {
     ToInt();
     rhs.ToInt();
-    iprec_ <<= rhs.iprec_;
+    Int() <<= rhs.GetInt();
 }
 
 void Variable::RShift(Variable& rhs)
 {
     ToInt();
     rhs.ToInt();
-    iprec_ >>= rhs.iprec_;
+    Int() >>= rhs.GetInt();
 }
 
 void Variable::Min(Variable& rhs)
 {
     Unify(rhs);
-    if (isFloat_)
+    if (IsComplex())
+        Error("complex numbers can not be compared");
+    else if (IsFloat())
+    {
+        if (*float_ > *rhs.float_)
+            Float() = *rhs.float_;
+    }
+    else if (IsRational())
     {
-        if (fprec_ > rhs.fprec_)
-            fprec_ = rhs.fprec_;
+        if (rational_->num * rhs.rational_->denom > rhs.rational_->num * rational_->denom)
+            *this = rhs;
     }
     else
     {
-        if (iprec_ > rhs.iprec_)
-            iprec_ = rhs.iprec_;
+        if (GetInt() > rhs.GetInt())
+            *this = rhs;
     }
 }
 
 void Variable::Max(Variable& rhs)
 {
     Unify(rhs);
-    if (isFloat_)
+    if (IsComplex())
+        Error("complex numbers can not be compared");
+    else if (IsFloat())
+    {
+        if (*float_ < *rhs.float_)
+            Float() = *rhs.float_;
+    }
+    else if (IsRational())
+    {
+        if (rational_->num * rhs.rational_->denom < rhs.rational_->num * rational_->denom)
+            *this = rhs;
+    }
+    else
+    {
+        if (GetInt() < rhs.GetInt())
+            *this = rhs;
+    }
+}
+
+void Variable::MulAdd(Variable& mul, Variable& add)
+{
+    if ( IsScalar() && mul.IsScalar() && add.IsScalar() && (IsFloat() || mul.IsFloat() || add.IsFloat()) &&
+         !IsComplex() && !mul.IsComplex() && !add.IsComplex() )
+    {
+        ToFloat();
+        mul.ToFloat();
+        add.ToFloat();
+        auto& x = Float();
+        x = fma(x, *mul.float_, *add.float_);
+    }
+    else
+    {
+        Mul(mul);
+        Add(add);
+    }
+}
+
+void Variable::MulSub(Variable& mul, Variable& sub)
+{
+    if ( IsScalar() && mul.IsScalar() && sub.IsScalar() && (IsFloat() || mul.IsFloat() || sub.IsFloat()) &&
+         !IsComplex() && !mul.IsComplex() && !sub.IsComplex() )
     {
-        if (fprec_ < rhs.fprec_)
-            fprec_ = rhs.fprec_;
+        ToFloat();
+        mul.ToFloat();
+        sub.ToFloat();
+        auto& x = Float();
+        x = fms(x, *mul.float_, *sub.float_);
     }
     else
     {
-        if (iprec_ < rhs.iprec_)
-            iprec_ = rhs.iprec_;
+        Mul(mul);
+        Sub(sub);
     }
 }
 
 void Variable::Negate()
 {
-    if (isFloat_)
-        fprec_ = -fprec_;
+    if (auto vec = Components())
+        VecForEach(vec->size(), [vec](std::size_t i) { (*vec)[i].Negate(); });
+    else if (IsComplex())
+        SetComplex(-*complex_);
+    else if (IsFloat())
+    {
+        auto& x = Float();
+        x = -x;
+    }
     else
-        iprec_ = -iprec_;
+    {
+        auto& x = Num();
+        x = -x;
+    }
 }
 
 // simple factorial function for big-integers in imperative style
@@ -194,7 +588,7 @@ static void IntPrecFactorial(int_precision& n)
 void Variable::Factorial()
 {
     ToInt();
-    IntPrecFactorial(iprec_);
+    IntPrecFactorial(Int());
 }
 
 /* --- Vector functions --- */
@@ -202,87 +596,189 @@ void Variable::Factorial()
 void Variable::Norm()
 {
     if (IsVector())
+        *this = VecNorm(*vector_);
+    else if (IsMatrix())
+        Error("norm of matrices is not supported");
+    else if (IsComplex())
+        SetFloat(ComplexAbs(*complex_));
+    else if (IsFloat())
     {
-        auto vec = std::move(vector_);
-        ToFloat();
-        
-        for (auto& v : vec)
-        {
-            if (!v.IsScalar())
-                Error("can not compute norm of vector with non-scalar components");
-
-            v.ToFloat();
-            v.Mul(v);
-
-            Add(v);
-        }
-
-        fprec_ = sqrt(fprec_);
+        auto& x = Float();
+        x = abs(x);
     }
-    else if (IsFloat())
-        fprec_ = abs(fprec_);
     else
-        iprec_ = abs(iprec_);
+    {
+        auto& x = Num();
+        x = abs(x);
+    }
 }
 
 void Variable::Sign()
 {
-    int sgn = 0;
+    RequireScalar();
+    if (IsComplex())
+        Error("sign of complex numbers is undefined");
 
     /* Determine signum */
-    if (isFloat_)
+    int sgn = 0;
+
+    if (IsFloat())
     {
         const float_precision zero("0.0");
-        if (fprec_ > zero)
+        if (*float_ > zero)
             sgn = 1;
-        else if (fprec_ < zero)
+        else if (*float_ < zero)
             sgn = -1;
     }
     else
     {
-        if (iprec_ > 0)
+        if (GetInt() > int_precision(0))
             sgn = 1;
-        else if (iprec_ < 0)
+        else if (GetInt() < int_precision(0))
             sgn = -1;
     }
 
     /* Store integer value */
-    ToInt();
-    iprec_ = sgn;
+    SetInt(sgn);
 }
 
 /* --- Misc --- */
 
 void Variable::ToFloat()
 {
-    if (!isFloat_)
+    RequireScalar();
+    if (IsComplex())
+        Error("complex number can not be converted to a real number");
+    else if (IsRational())
     {
-        auto ival = iprec_.toString();
-        fprec_ = float_precision(ival.c_str());
-        isFloat_ = true;
+        /* Divide with guard digits, so the quotient is rounded to the working precision only once more */
+        const auto guard = float_precision_ctrl.precision() + 8;
+        float_precision q(rational_->num, guard);
+        q /= float_precision(rational_->denom, guard);
+
+        SetFloat(std::move(q));
     }
+    else if (!IsFloat())
+        SetFloat(float_precision(GetInt()));
 }
 
 void Variable::ToInt()
 {
-    if (isFloat_)
+    RequireScalar();
+    if (IsComplex())
+        Error("complex number can not be converted to an integer");
+    else if (IsFloat())
+        SetInt(float_->to_int_precision());
+    else if (IsRational())
+    {
+        /* Truncate like float to integer conversions */
+        SetInt(rational_->num / rational_->denom);
+    }
+}
+
+void Variable::ToComplex()
+{
+    if (!IsComplex())
     {
-        iprec_ = fprec_.to_int_precision();
-        isFloat_ = false;
+        ToFloat();
+        SetComplex(complex_float(*float_));
     }
 }
 
 void Variable::Unify(Variable& rhs)
 {
-    if (isFloat_ && !rhs.isFloat_)
+    RequireScalar();
+    rhs.RequireScalar();
+
+    if (IsComplex() || rhs.IsComplex())
+    {
+        ToComplex();
+        rhs.ToComplex();
+    }
+    else if (IsFloat() && !rhs.IsFloat())
         rhs.ToFloat();
-    else if (!isFloat_ && rhs.isFloat_)
+    else if (!IsFloat() && rhs.IsFloat())
         ToFloat();
+    else if (!IsFloat() && (IsRational() || rhs.IsRational()))
+    {
+        ToRational();
+        rhs.ToRational();
+    }
+}
+
+void Variable::ResolveRational()
+{
+    if (auto vec = Components())
+    {
+        for (auto& v : *vec)
+            v.ResolveRational();
+    }
+    else if (IsRational())
+    {
+        ReduceRational();
+        if (IsRational())
+            ToFloat();
+    }
+}
+
+bool Variable::IsNegative() const
+{
+    switch (type_)
+    {
+        case Type::Int:
+            return GetInt().sign() < 0;
+        case Type::Float:
+            return float_->sign() < 0;
+        case Type::Rational:
+            return rational_->num.sign() < 0;
+        default:
+            return false;
+    }
+}
+
+bool Variable::IsZero() const
+{
+    switch (type_)
+    {
+        case Type::Int:
+            return GetInt() == int_precision(0);
+        case Type::Float:
+        {
+            const auto& m = *float_->ref_mantissa();
+            return m.size() == 2 && m[1] == '0';
+        }
+        case Type::Rational:
+            return rational_->num == int_precision(0);
+        default:
+            /* Complex numbers have a non-zero imaginary part (see NormalizeComplex) */
+            return false;
+    }
 }
 
 std::string Variable::ToString() const
 {
-    return IsFloat() ? fprec_.toString() : iprec_.toString();
+    switch (type_)
+    {
+        case Type::Int:
+            return GetInt().toString();
+        case Type::Float:
+            return float_->toString();
+        case Type::Rational:
+        {
+            auto v = *this;
+            v.ToFloat();
+            return v.ToString();
+        }
+        case Type::Complex:
+        {
+            auto im = complex_->imag().toString();
+            if (im.front() != '-' && im.front() != '+')
+                im = "+" + im;
+            return complex_->real().toString() + im + "i";
+        }
+        default:
+            return "";
+    }
 }
 
 Variable::operator std::string () const
@@ -290,9 +786,372 @@ Variable::operator std::string () const
     return ToString();
 }
 
+const int_precision& Variable::GetInt() const
+{
+    static const int_precision zero(0);
+    switch (type_)
+    {
+        case Type::Int:
+            return (int_ ? *int_ : zero);
+        case Type::Rational:
+            return rational_->num;
+        default:
+            return zero;
+    }
+}
+
+const int_precision& Variable::GetDenom() const
+{
+    static const int_precision one(1);
+    return (IsRational() ? rational_->denom : one);
+}
+
+const float_precision& Variable::GetFloat() const
+{
+    static const float_precision zero(0);
+    return (IsFloat() ? *float_ : zero);
+}
+
+const complex_float& Variable::GetComplex() const
+{
+    static const complex_float zero;
+    return (IsComplex() ? *complex_ : zero);
+}
+
+const std::vector<Variable>& Variable::GetVector() const
+{
+    static const std::vector<Variable> empty;
+    return (IsVector() ? *vector_ : empty);
+}
+
+std::vector<Variable>& Variable::GetVector()
+{
+    return Unshared(vector_);
+}
+
+const Matrix& Variable::GetMatrix() const
+{
+    static const Matrix empty;
+    return (IsMatrix() ? *matrix_ : empty);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void Variable::Destroy()
+{
+    switch (type_)
+    {
+        case Type::Int:
+            int_.~shared_ptr();
+            break;
+        case Type::Float:
+            float_.~shared_ptr();
+            break;
+        case Type::Rational:
+            rational_.~shared_ptr();
+            break;
+        case Type::Complex:
+            complex_.~shared_ptr();
+            break;
+        case Type::Vector:
+            vector_.~shared_ptr();
+            break;
+        case Type::Matrix:
+            matrix_.~shared_ptr();
+            break;
+    }
+}
+
+// Constructs a copy of 'rhs' in this uninitialized storage, which shares the payload of 'rhs'.
+void Variable::CopyFrom(const Variable& rhs)
+{
+    switch (rhs.type_)
+    {
+        case Type::Int:
+            new (&int_) std::shared_ptr<int_precision>(rhs.int_);
+            break;
+        case Type::Float:
+            new (&float_) std::shared_ptr<float_precision>(rhs.float_);
+            break;
+        case Type::Rational:
+            new (&rational_) std::shared_ptr<Rational>(rhs.rational_);
+            break;
+        case Type::Complex:
+            new (&complex_) std::shared_ptr<complex_float>(rhs.complex_);
+            break;
+        case Type::Vector:
+            new (&vector_) std::shared_ptr<std::vector<Variable>>(rhs.vector_);
+            break;
+        case Type::Matrix:
+            new (&matrix_) std::shared_ptr<Matrix>(rhs.matrix_);
+            break;
+    }
+    type_ = rhs.type_;
+}
+
+// Moves 'rhs' into this uninitialized storage, and leaves 'rhs' as integer zero.
+void Variable::MoveFrom(Variable& rhs)
+{
+    switch (rhs.type_)
+    {
+        case Type::Int:
+            new (&int_) std::shared_ptr<int_precision>(std::move(rhs.int_));
+            break;
+        case Type::Float:
+            new (&float_) std::shared_ptr<float_precision>(std::move(rhs.float_));
+            break;
+        case Type::Rational:
+            new (&rational_) std::shared_ptr<Rational>(std::move(rhs.rational_));
+            break;
+        case Type::Complex:
+            new (&complex_) std::shared_ptr<complex_float>(std::move(rhs.complex_));
+            break;
+        case Type::Vector:
+            new (&vector_) std::shared_ptr<std::vector<Variable>>(std::move(rhs.vector_));
+            break;
+        case Type::Matrix:
+            new (&matrix_) std::shared_ptr<Matrix>(std::move(rhs.matrix_));
+            break;
+    }
+
+    type_ = rhs.type_;
+
+    if (type_ != Type::Int)
+    {
+        rhs.Destroy();
+        new (&rhs.int_) std::shared_ptr<int_precision>();
+        rhs.type_ = Type::Int;
+    }
+}
+
+void Variable::SetInt(int_precision value)
+{
+    if (type_ != Type::Int)
+    {
+        Destroy();
+        new (&int_) std::shared_ptr<int_precision>();
+        type_ = Type::Int;
+    }
+
+    /* Reuse the payload if it is not shared */
+    if (int_.use_count() == 1)
+        *int_ = std::move(value);
+    else
+        int_ = std::make_shared<int_precision>(std::move(value));
+}
+
+// Stores the value rounded to the working precision (like an assignment to a float of the current context).
+void Variable::SetFloat(float_precision value)
+{
+    if (type_ != Type::Float)
+    {
+        Destroy();
+        new (&float_) std::shared_ptr<float_precision>(std::make_shared<float_precision>());
+        type_ = Type::Float;
+    }
+    else if (float_.use_count() > 1)
+    {
+        /* Replace a shared payload by a new float with the same precision and rounding mode */
+        float_ = std::make_shared<float_precision>(0, float_->precision(), float_->mode());
+    }
+    *float_ = std::move(value);
+}
+
+void Variable::SetComplex(const complex_float& value)
+{
+    if (type_ != Type::Complex)
+    {
+        Destroy();
+        new (&complex_) std::shared_ptr<complex_float>(std::make_shared<complex_float>());
+        type_ = Type::Complex;
+    }
+    Complex() = value;
+}
+
+int_precision& Variable::Int()
+{
+    if (!int_)
+        int_ = std::make_shared<int_precision>(0);
+    return Unshared(int_);
+}
+
+float_precision& Variable::Float()
+{
+    return Unshared(float_);
+}
+
+Variable::Rational& Variable::Rat()
+{
+    return Unshared(rational_);
+}
+
+complex_float& Variable::Complex()
+{
+    return Unshared(complex_);
+}
+
+int_precision& Variable::Num()
+{
+    return (IsRational() ? Rat().num : Int());
+}
+
+void Variable::RequireScalar() const
+{
+    if (IsVector())
+        Error("vector can not be used as scalar operand");
+    if (IsMatrix())
+        Error("matrix can not be used as scalar operand");
+}
+
+std::vector<Variable>* Variable::Components()
+{
+    switch (type_)
+    {
+        case Type::Vector:
+            return &Unshared(vector_);
+        case Type::Matrix:
+            return &(Unshared(matrix_).elements);
+        default:
+            return nullptr;
+    }
+}
+
+bool Variable::Broadcast(Variable& rhs, void (Variable::*op)(Variable&))
+{
+    auto a = Components();
+    auto b = rhs.Components();
+
+    if (a && b)
+    {
+        if (IsVector() && rhs.IsVector())
+        {
+            if (a->size() != b->size())
+                Error("vector dimensions do not match");
+        }
+        else if (!IsMatrix() || !rhs.IsMatrix() || matrix_->rows != rhs.matrix_->rows || matrix_->cols != rhs.matrix_->cols)
+            Error("matrix dimensions do not match");
+
+        VecForEach(a->size(), [&](std::size_t i) { ((*a)[i].*op)((*b)[i]); });
+    }
+    else if (a)
+    {
+        /* Operate on copies of the scalar, since operations convert their operands */
+        VecForEach(
+            a->size(),
+            [&](std::size_t i)
+            {
+                auto x = rhs;
+                ((*a)[i].*op)(x);
+            }
+        );
+    }
+    else if (b)
+    {
+        VecForEach(
+            b->size(),
+            [&](std::size_t i)
+            {
+                auto x = *this;
+                (x.*op)((*b)[i]);
+                (*b)[i] = std::move(x);
+            }
+        );
+        *this = std::move(rhs);
+    }
+    else
+        return false;
+
+    return true;
+}
+
+void Variable::ToRational()
+{
+    if (!IsRational())
+    {
+        auto r = std::make_shared<Rational>();
+        r->num = std::move(Int());
+        r->denom = 1;
+        r->reducedLen = Length(r->denom);
+
+        Destroy();
+        new (&rational_) std::shared_ptr<Rational>(std::move(r));
+        type_ = Type::Rational;
+    }
+}
+
+void Variable::AddRational(const int_precision& num, const int_precision& den)
+{
+    auto& r = Rat();
+    if (r.denom == den)
+        r.num += num;
+    else
+    {
+        /* a/b + c/d = (a*d + c*b) / (b*d) */
+        r.num = r.num * den + num * r.denom;
+        r.denom *= den;
+    }
+    NormalizeRational();
+}
+
+void Variable::NormalizeRational()
+{
+    auto& r = Rat();
+
+    /* Keep the sign in the numerator */
+    if (r.denom < 0)
+    {
+        r.num = -r.num;
+        r.denom = -r.denom;
+    }
+
+    /* Reduce lazily, when the denominator has grown twice as long as after the last reduction */
+    if (Length(r.denom) > 2 * r.reducedLen)
+        ReduceRational();
+
+    /* Materialize rationals which grow too large for exact arithmetic */
+    if (IsRational())
+    {
+        const auto maxLen = MaxRationalLength();
+        if (Length(rational_->num) > maxLen || Length(rational_->denom) > maxLen)
+            ToFloat();
+    }
+}
+
+void Variable::NormalizeComplex()
+{
+    /* Complex numbers without imaginary part become real numbers again */
+    const auto& m = *complex_->ref_imag()->ref_mantissa();
+    if (m.size() == 2 && m[1] == '0')
+        SetFloat(complex_->real());
+}
+
+void Variable::ReduceRational()
+{
+    auto& r = Rat();
+
+    if (r.denom != int_precision(1))
+    {
+        auto g = Gcd(r.num, r.denom);
+        if (g != int_precision(1))
+        {
+            r.num /= g;
+            r.denom /= g;
+        }
+    }
+
+    r.reducedLen = Length(r.denom);
+
+    /* Integral rationals become integers again */
+    if (r.denom == int_precision(1))
+        SetInt(std::move(r.num));
+}
+
 
 } // /namespace HTLib
 
 
 
-// ================================================================================
\ No newline at end of file
+// ================================================================================
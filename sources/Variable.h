@@ -11,7 +11,9 @@
 
 #include "precpkg/iprecision.h"
 #include "precpkg/fprecision.h"
+#include "ComplexMath.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,23 +22,44 @@ namespace Ac
 {
 
 
+struct Matrix;
+
+/*
+Discriminated union of an integer, a float, an exact rational, a complex number, or a flat vector or matrix of these scalars.
+The payload of each type is a reference-counted buffer which is shared by all copies (copy-on-write),
+so copying a value only copies a pointer, and the payload is cloned when a shared value is modified.
+*/
 class Variable
 {
             
     public:
         
-        Variable() = default;
+        Variable();
+        Variable(const Variable& rhs);
+        Variable(Variable&& rhs);
         Variable(std::vector<Variable>&& vector);
+        Variable(Matrix&& matrix);
         Variable(const int_precision& iprec);
+        Variable(int_precision&& iprec);
         Variable(const float_precision& fprec);
+        Variable(float_precision&& fprec);
+        Variable(const complex_float& cprec);
         Variable(const std::string& value);
 
+        ~Variable();
+
+        Variable& operator = (const Variable& rhs);
+        Variable& operator = (Variable&& rhs);
+
         /* --- Scalar functions --- */
 
+        // Arithmetic operations, which are applied component-wise if one or both operands are vectors or matrices.
         void Add(Variable& rhs);
         void Sub(Variable& rhs);
         void Mul(Variable& rhs);
         void Div(Variable& rhs);
+
+        void IntDiv(Variable& rhs);
         void Mod(Variable& rhs);
         void Pow(Variable& rhs);
         void LShift(Variable& rhs);
@@ -44,68 +67,174 @@ class Variable
         void Min(Variable& rhs);
         void Max(Variable& rhs);
 
+        // Computes this = this*mul + add with a single rounding for floats.
+        void MulAdd(Variable& mul, Variable& add);
+        // Computes this = this*mul - sub with a single rounding for floats.
+        void MulSub(Variable& mul, Variable& sub);
+
         void Negate();
         void Factorial();
         void Norm();
         void Sign();
 
-        /* --- Vector functions --- */
-
-        void VecNorm();
-
         /* --- Misc --- */
 
         void ToFloat();
         void ToInt();
+        void ToComplex();
 
         void Unify(Variable& rhs);
 
+        // Converts exact rationals into integers if they are integral, or into floats otherwise (also for vector components).
+        void ResolveRational();
+
         std::string ToString() const;
 
         operator std::string () const;
 
-        const int_precision& GetInt() const
-        {
-            return iprec_;
-        }
+        // Returns the integer value, or the numerator of a rational (zero for other types).
+        const int_precision& GetInt() const;
 
-        const float_precision& GetFloat() const
+        // Returns the denominator of a rational (see IsRational).
+        const int_precision& GetDenom() const;
+
+        const float_precision& GetFloat() const;
+
+        const complex_float& GetComplex() const;
+
+        const std::vector<Variable>& GetVector() const;
+
+        // Returns the components of a vector (see IsVector), which are no longer shared with other copies.
+        std::vector<Variable>& GetVector();
+
+        const Matrix& GetMatrix() const;
+
+        bool IsVector() const
         {
-            return fprec_;
+            return type_ == Type::Vector;
         }
 
-        const std::vector<Variable>& GetVector() const
+        bool IsMatrix() const
         {
-            return vector_;
+            return type_ == Type::Matrix;
         }
 
-        std::vector<Variable>& GetVector()
+        bool IsScalar() const
         {
-            return vector_;
+            return !IsVector() && !IsMatrix();
         }
 
-        bool IsVector() const
+        bool IsFloat() const
         {
-            return !vector_.empty();
+            return type_ == Type::Float;
         }
 
-        bool IsScalar() const
+        bool IsRational() const
         {
-            return !IsVector();
+            return type_ == Type::Rational;
         }
 
-        bool IsFloat() const
+        bool IsComplex() const
         {
-            return isFloat_;
+            return type_ == Type::Complex;
         }
 
+        // Returns true if this is a negative real number.
+        bool IsNegative() const;
+
+        // Returns true if this is a scalar with value zero.
+        bool IsZero() const;
+
     private:
 
-        int_precision           iprec_;
-        float_precision         fprec_;
-        bool                    isFloat_ = false;
-        std::vector<Variable>   vector_;
+        enum class Type : unsigned char
+        {
+            Int,
+            Float,
+            Rational,
+            Complex,
+            Vector,
+            Matrix,
+        };
+
+        struct Rational
+        {
+            int_precision   num;
+            int_precision   denom;          // positive denominator.
+            std::size_t     reducedLen;     // length of the denominator after the last reduction.
+        };
+
+        void Destroy();
+        void CopyFrom(const Variable& rhs);
+        void MoveFrom(Variable& rhs);
+
+        void SetInt(int_precision value);
+        void SetFloat(float_precision value);
+        void SetComplex(const complex_float& value);
+
+        // Returns the payload of the respective type for modification, which is cloned first if it is shared.
+        int_precision& Int();
+        float_precision& Float();
+        Rational& Rat();
+        complex_float& Complex();
+
+        // Returns the integer value or the numerator of a rational for modification.
+        int_precision& Num();
+
+        void RequireScalar() const;
 
+        // Returns the components of a vector or the elements of a matrix, or null for scalars.
+        std::vector<Variable>* Components();
+
+        // Applies the operation to all components if one of the operands is a vector or matrix, and returns false for two scalars.
+        bool Broadcast(Variable& rhs, void (Variable::*op)(Variable&));
+
+        void ToRational();
+        void AddRational(const int_precision& num, const int_precision& den);
+        void NormalizeRational();
+        void ReduceRational();
+
+        void NormalizeComplex();
+
+        union
+        {
+            std::shared_ptr<int_precision>          int_;       // null for the integer zero.
+            std::shared_ptr<float_precision>        float_;
+            std::shared_ptr<Rational>               rational_;
+            std::shared_ptr<complex_float>          complex_;
+            std::shared_ptr<std::vector<Variable>>  vector_;
+            std::shared_ptr<Matrix>                 matrix_;
+        };
+
+        Type type_ = Type::Int;
+
+};
+
+//! Dense matrix of scalars in row-major order.
+struct Matrix
+{
+    Matrix() = default;
+
+    Matrix(std::size_t numRows, std::size_t numCols) :
+        rows    ( numRows           ),
+        cols    ( numCols           ),
+        elements( numRows * numCols )
+    {
+    }
+
+    Variable& operator () (std::size_t row, std::size_t col)
+    {
+        return elements[row*cols + col];
+    }
+
+    const Variable& operator () (std::size_t row, std::size_t col) const
+    {
+        return elements[row*cols + col];
+    }
+
+    std::size_t             rows = 0;
+    std::size_t             cols = 0;
+    std::vector<Variable>   elements;
 };
 
 
@@ -0,0 +1,352 @@
+/*
+ * VectorMath.cpp
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "VectorMath.h"
+#include "PrecisionUtils.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace Ac
+{
+
+
+// Number of products per partial sum, which is independent of the number of threads to keep the results deterministic.
+static const std::size_t sumBlockSize = 64;
+
+static void Error(const std::string& msg)
+{
+    throw std::runtime_error("math error: " + msg);
+}
+
+static void CheckDimensions(const std::vector<Variable>& a, const std::vector<Variable>& b)
+{
+    if (a.size() != b.size())
+        Error("vector dimensions do not match");
+}
+
+/*
+Returns the number of digits for sums of 'n' products, which are exact with twice the working precision,
+and whose accumulated rounding errors stay below the last digit of the working precision.
+*/
+static unsigned int GuardDigits(std::size_t n)
+{
+    return 2 * float_precision_ctrl.precision() + static_cast<unsigned int>(std::to_string(n).size()) + 2;
+}
+
+// Stores the real and imaginary part of a scalar with the given precision, and returns true if the imaginary part is present.
+static bool GetParts(const Variable& x, unsigned int prec, float_precision& re, float_precision& im)
+{
+    const auto mode = float_precision_ctrl.mode();
+
+    if (x.IsVector())
+        Error("vector components must be scalars");
+
+    if (x.IsComplex())
+    {
+        re = Extended(x.GetComplex().real(), prec);
+        im = Extended(x.GetComplex().imag(), prec);
+        return true;
+    }
+
+    if (x.IsFloat())
+        re = Extended(x.GetFloat(), prec);
+    else
+    {
+        re = float_precision(x.GetInt(), prec, mode);
+        if (x.IsRational())
+            re /= float_precision(x.GetDenom(), prec, mode);
+    }
+
+    return false;
+}
+
+// Adds the products a[i]*b[i] (or a[i]*conj(b[i])) for i in [first, first+n) to 're' and 'im', which determine the precision of the products.
+static void AccumulateProducts(const PackedVector& a, const PackedVector& b, std::size_t first, std::size_t n, bool conjugate, float_precision& re, float_precision& im)
+{
+    const auto prec         = re.precision();
+    const bool isComplexA   = !a.im.empty();
+    const bool isComplexB   = !b.im.empty();
+
+    float_precision t(0, prec);
+
+    for (auto i = first, last = first + n; i < last; ++i)
+    {
+        /* (ar + ai*i)*(br + bi*i) = (ar*br - ai*bi) + (ar*bi + ai*br)*i, where conj(b) negates bi */
+        t = a.re[i];
+        t *= b.re[i];
+        re += t;
+
+        if (isComplexA && isComplexB)
+        {
+            t = a.im[i];
+            t *= b.im[i];
+            if (conjugate)
+                re += t;
+            else
+                re -= t;
+        }
+        if (isComplexB)
+        {
+            t = a.re[i];
+            t *= b.im[i];
+            if (conjugate)
+                im -= t;
+            else
+                im += t;
+        }
+        if (isComplexA)
+        {
+            t = a.im[i];
+            t *= b.re[i];
+            im += t;
+        }
+    }
+}
+
+/*
+Computes the sums of products in blocks of fixed size (in parallel for large vectors),
+and adds the partial sums in order, so the result does not depend on the number of threads.
+*/
+static void SumProducts(const PackedVector& a, const PackedVector& b, bool conjugate, float_precision& re, float_precision& im)
+{
+    const auto n            = a.size;
+    const auto numBlocks    = (n + sumBlockSize - 1) / sumBlockSize;
+    const auto prec         = re.precision();
+
+    std::vector<float_precision> partialRe(numBlocks, float_precision(0, prec)), partialIm(numBlocks, float_precision(0, prec));
+
+    ParallelFor(
+        numBlocks, vecParallelThreshold / sumBlockSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto first = i * sumBlockSize;
+                AccumulateProducts(a, b, first, std::min(sumBlockSize, n - first), conjugate, partialRe[i], partialIm[i]);
+            }
+        }
+    );
+
+    for (std::size_t i = 0; i < numBlocks; ++i)
+    {
+        re += partialRe[i];
+        im += partialIm[i];
+    }
+}
+
+static bool IsExact(const Variable* a, std::size_t n)
+{
+    return std::none_of(a, a + n, [](const Variable& x) { return x.IsFloat() || x.IsComplex() || !x.IsScalar(); });
+}
+
+static bool HasComplex(const Variable* a, std::size_t n)
+{
+    return std::any_of(a, a + n, [](const Variable& x) { return x.IsComplex(); });
+}
+
+// Converts the components at 'a' into contiguous parts with the given precision (in parallel for large vectors if 'parallel' is true).
+static PackedVector Pack(const Variable* a, std::size_t n, unsigned int prec, bool parallel)
+{
+    PackedVector p;
+
+    p.components    = a;
+    p.size          = n;
+    p.isExact       = IsExact(a, n);
+    p.re.assign(n, float_precision(0, prec));
+
+    if (HasComplex(a, n))
+        p.im.assign(n, float_precision(0, prec));
+
+    auto PackRange = [&](std::size_t begin, std::size_t end)
+    {
+        float_precision im(0, prec);
+        for (auto i = begin; i < end; ++i)
+            GetParts(a[i], prec, p.re[i], (p.im.empty() ? im : p.im[i]));
+    };
+
+    if (parallel)
+        ParallelFor(n, vecParallelThreshold, PackRange);
+    else
+        PackRange(0, n);
+
+    return p;
+}
+
+// Returns the exact dot product of integers and rationals.
+static Variable ExactDot(const std::vector<Variable>& a, const std::vector<Variable>& b)
+{
+    const auto n            = a.size();
+    const auto numBlocks    = (n + sumBlockSize - 1) / sumBlockSize;
+
+    std::vector<Variable> partial(numBlocks);
+
+    ParallelFor(
+        numBlocks, vecParallelThreshold / sumBlockSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                for (auto j = i * sumBlockSize, last = std::min(j + sumBlockSize, n); j < last; ++j)
+                {
+                    auto x = a[j];
+                    auto y = b[j];
+                    x.Mul(y);
+                    partial[i].Add(x);
+                }
+            }
+        }
+    );
+
+    Variable sum(int_precision(0));
+
+    for (auto& x : partial)
+        sum.Add(x);
+
+    return sum;
+}
+
+// Returns the value of the real and imaginary parts rounded to the working precision.
+static Variable RoundedScalar(const float_precision& re, const float_precision& im, bool isComplex)
+{
+    if (isComplex)
+        return Variable(complex_float(Rounded(re), Rounded(im)));
+    return Variable(Rounded(re));
+}
+
+// Returns the norm with guard digits.
+static float_precision ExtendedNorm(const std::vector<Variable>& a)
+{
+    const auto prec = GuardDigits(a.size());
+    const auto p    = Pack(a.data(), a.size(), prec, true);
+
+    float_precision re(0, prec), im(0, prec);
+    SumProducts(p, p, true, re, im);
+
+    return sqrt(re);
+}
+
+
+/*
+ * Global functions
+ */
+
+Variable VecDot(const std::vector<Variable>& a, const std::vector<Variable>& b)
+{
+    CheckDimensions(a, b);
+
+    const auto n = a.size();
+
+    if (IsExact(a.data(), n) && IsExact(b.data(), n))
+        return ExactDot(a, b);
+
+    const auto prec = GuardDigits(n);
+    const auto pa   = Pack(a.data(), n, prec, true);
+    const auto pb   = Pack(b.data(), n, prec, true);
+
+    float_precision re(0, prec), im(0, prec);
+    SumProducts(pa, pb, false, re, im);
+
+    return RoundedScalar(re, im, !pa.im.empty() || !pb.im.empty());
+}
+
+PackedVector PackVector(const Variable* a, std::size_t n)
+{
+    return Pack(a, n, GuardDigits(n), false);
+}
+
+Variable DotProduct(const PackedVector& a, const PackedVector& b)
+{
+    const auto n = a.size;
+
+    if (a.isExact && b.isExact)
+    {
+        Variable sum(int_precision(0));
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto x = a.components[i];
+            auto y = b.components[i];
+            x.Mul(y);
+            sum.Add(x);
+        }
+
+        return sum;
+    }
+
+    const auto prec = GuardDigits(n);
+
+    float_precision re(0, prec), im(0, prec);
+    AccumulateProducts(a, b, 0, n, false, re, im);
+
+    return RoundedScalar(re, im, !a.im.empty() || !b.im.empty());
+}
+
+Variable VecCross(const std::vector<Variable>& a, const std::vector<Variable>& b)
+{
+    if (a.size() != 3 || b.size() != 3)
+        Error("cross product requires 3D vectors");
+
+    /* Each component a[i]*b[j] - a[j]*b[i] is a dot product with a single rounding */
+    auto Component = [&](std::size_t i, std::size_t j) -> Variable
+    {
+        std::vector<Variable> x { a[i], a[j] }, y { b[j], b[i] };
+        x[1].Negate();
+        return VecDot(x, y);
+    };
+
+    std::vector<Variable> c { Component(1, 2), Component(2, 0), Component(0, 1) };
+
+    return Variable(std::move(c));
+}
+
+Variable VecNorm(const std::vector<Variable>& a)
+{
+    return Variable(Rounded(ExtendedNorm(a)));
+}
+
+Variable VecNormalize(const std::vector<Variable>& a)
+{
+    const auto norm = ExtendedNorm(a);
+
+    if (IsZero(norm))
+        throw float_precision::divide_by_zero();
+
+    /* Multiply with the reciprocal, whose guard digits cover the two roundings before the final one */
+    const auto prec = float_precision_ctrl.precision() + 4;
+
+    float_precision invNorm(1, prec);
+    invNorm /= norm;
+
+    std::vector<Variable> c(a.size());
+
+    VecForEach(
+        a.size(),
+        [&](std::size_t i)
+        {
+            float_precision re(0, prec), im(0, prec);
+            const bool isComplex = GetParts(a[i], prec, re, im);
+
+            re *= invNorm;
+            if (isComplex)
+                im *= invNorm;
+
+            c[i] = RoundedScalar(re, im, isComplex);
+        }
+    );
+
+    return Variable(std::move(c));
+}
+
+
+} // /namespace Ac
+
+
+
+// ================================================================================
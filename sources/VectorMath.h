@@ -0,0 +1,85 @@
+/*
+ * VectorMath.h
+ *
+ * This file is part of the "Abacus" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __AC_VECTOR_MATH_H__
+#define __AC_VECTOR_MATH_H__
+
+
+#include "Variable.h"
+#include "Parallel.h"
+
+#include <vector>
+
+
+namespace Ac
+{
+
+
+//! Number of components from which on vector kernels process the components on multiple threads.
+const std::size_t vecParallelThreshold = 256;
+
+//! Calls 'func(i)' for all component indices i in [0, n), in parallel for large vectors.
+template <typename Func>
+void VecForEach(std::size_t n, const Func& func)
+{
+    ParallelFor(
+        n, vecParallelThreshold,
+        [&func](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                func(i);
+        }
+    );
+}
+
+/*
+Products and norms of flat vectors of scalars with the precision and rounding mode of the current float context.
+Sums of products are exact for integers and rationals, and are accumulated with enough guard digits for floats,
+so that every result is rounded only once to the working precision.
+*/
+
+//! Returns the dot product a[0]*b[0] + ... + a[n-1]*b[n-1] (without complex conjugation).
+Variable VecDot(const std::vector<Variable>& a, const std::vector<Variable>& b);
+
+/**
+Components of a vector, which are converted once into contiguous floats with the guard digits of its dot products,
+so that the inner loops of the kernels only multiply and add floats.
+The imaginary parts are only stored if a component is complex.
+*/
+struct PackedVector
+{
+    const Variable*                 components  = nullptr;  // components, which must outlive the packed vector.
+    std::size_t                     size        = 0;
+    bool                            isExact     = false;    // true if all components are integers or rationals.
+    std::vector<float_precision>    re;
+    std::vector<float_precision>    im;
+};
+
+//! Packs the 'n' components at 'a' for dot products with other packed vectors of the same size (on the calling thread).
+PackedVector PackVector(const Variable* a, std::size_t n);
+
+//! Returns the dot product of two packed vectors of the same size like VecDot, but only on the calling thread.
+Variable DotProduct(const PackedVector& a, const PackedVector& b);
+
+//! Returns the cross product of two 3D vectors.
+Variable VecCross(const std::vector<Variable>& a, const std::vector<Variable>& b);
+
+//! Returns the euclidean norm sqrt(|a[0]|^2 + ... + |a[n-1]|^2).
+Variable VecNorm(const std::vector<Variable>& a);
+
+//! Returns a/|a| (throws float_precision::divide_by_zero for the zero vector).
+Variable VecNormalize(const std::vector<Variable>& a);
+
+
+} // /namespace Ac
+
+
+#endif
+
+
+
+// ================================================================================
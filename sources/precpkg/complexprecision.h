@@ -86,6 +86,7 @@ template<class _Ty> class complex_precision {
       _Ty *ref_imag()   { return &im; }
 
       // Essential operators
+      complex_precision( const complex_precision<_Ty>& ) = default;  // copies the precision of the parts, unlike the assignment
       complex_precision<_Ty>& operator= ( const complex_precision<_Ty>& x )   { re = x.real(); im = x.imag(); return *this; }
       complex_precision<_Ty>& operator+=( const complex_precision<_Ty>& x )   { re += x.real(); im += x.imag(); return *this; }
       complex_precision<_Ty>& operator-=( const complex_precision<_Ty>& x )   { re -= x.real(); im -= x.imag(); return *this; }
@@ -115,7 +115,8 @@ inline unsigned int PADJUST( unsigned int x )	{ return (int)( x * ( log( (double
 /// @todo
 ///
 ///// Float Precision control class
-///   This keep track of the global settings of default precision and round mode.
+///   This keep track of the per thread settings of default precision and round mode.
+///   There is one instance per thread so threads can compute at different precisions concurrently.
 ///   Everytime a new float_precision constructor is invoked it takes the default 
 ///   precision and round mode from this float_precision_ctrl class. Unless a precision and/or
 ///   rounding mode has explicit been specified.
@@ -137,7 +138,7 @@ class float_precision_ctrl {
       unsigned precision( unsigned int p )         { mPrec = p > 0 ? p : PRECISION; return mPrec; }
    };
 
-extern float_precision_ctrl float_precision_ctrl;
+extern thread_local float_precision_ctrl float_precision_ctrl;
 
 class float_precision;
    
@@ -152,6 +153,11 @@ inline float_precision operator-( const float_precision&, const float_precision&
 inline float_precision operator-( const float_precision& );                          // Unary
 inline static float_precision operator*( const float_precision&, const float_precision& );  // Binary
 inline float_precision operator/( const float_precision&, const float_precision& );  // Binary
+inline float_precision operator+( float_precision&&, const float_precision& );       // Binary. Reuse the left operand
+inline float_precision operator-( float_precision&&, const float_precision& );       // Binary. Reuse the left operand
+inline float_precision operator-( float_precision&& );                               // Unary. Reuse the operand
+inline float_precision operator*( float_precision&&, const float_precision& );       // Binary. Reuse the left operand
+inline float_precision operator/( float_precision&&, const float_precision& );       // Binary. Reuse the left operand
 
 // Boolean Comparision Operators
 inline bool operator> ( const float_precision&, const float_precision& );
@@ -164,6 +170,9 @@ inline bool operator<=( const float_precision&, const float_precision& );
 // Precision Floating point functions equivalent with the std C functions
 extern float_precision modf( const float_precision&, float_precision * );
 extern float_precision fmod( const float_precision&, const float_precision& );
+extern float_precision fma( const float_precision&, const float_precision&, const float_precision& );      // a*b+c with a single rounding
+extern float_precision fms( const float_precision&, const float_precision&, const float_precision& );      // a*b-c with a single rounding
+extern float_precision fmscale( const float_precision&, const float_precision&, const float_precision& );  // a*b*s with a single rounding
 extern float_precision floor( const float_precision& );
 extern float_precision ceil( const float_precision& );
 extern float_precision fabs( const float_precision& );  // Obsolete. replaced by overloaded abs(). But here for backward compatitbility
@@ -184,6 +193,7 @@ extern float_precision acos( const float_precision& );
 extern float_precision sin( const float_precision& );
 extern float_precision cos( const float_precision& );
 extern float_precision tan( const float_precision& );
+extern void sincos( const float_precision&, float_precision *, float_precision * );
 
 // Hyperbolic functions
 extern float_precision sinh( const float_precision& );
@@ -192,12 +202,14 @@ extern float_precision tanh( const float_precision& );
 extern float_precision asinh( const float_precision& );
 extern float_precision acosh( const float_precision& );
 extern float_precision atanh( const float_precision& ); 
+extern void sinhcosh( const float_precision&, float_precision *, float_precision * );
 
 // Support functions. Works on float_precision 
 float_precision _float_precision_inverse( const float_precision& );
 float_precision _float_table( enum table_type, unsigned int );
 std::string _float_precision_ftoa( const float_precision * );
 std::string _float_precision_ftoainteger( const float_precision * );
+int_precision _float_precision_ftoi( const float_precision * );
 float_precision _float_precision_atof( const char *, unsigned int, enum round_mode );
 float_precision _float_precision_dtof( double, unsigned int, enum round_mode );
 
@@ -244,12 +256,15 @@ class float_precision {
                               // the exponent. This will allow us exponent in the range from -RADIX^2^31 to  RADIX^2^31. Which should be enough
    std::string       mNumber; // The mantissa any length however the fraction point is always after the first digit and is implied
 
+   // True if the normalized mantissa m has at most p digits, i.e. rounding it to p digits does nothing
+   static bool _fits( const std::string& m, unsigned int p ) { return m.length() - 1 <= p && ( m.length() == 2 || FDIGIT( m[ m.length() - 1 ] ) != 0 ); }
+
    public:
       // Constructors
 	  float_precision()							{ mRmode = float_precision_ctrl.mode();
 												mPrec = float_precision_ctrl.precision();
 												mExpo = 0;
-												mNumber = "+" + FCHARACTER(0);            // Build number
+												mNumber = "+"; mNumber += FCHARACTER(0);  // Build number
 												}
       float_precision( char, unsigned int, enum round_mode );           // When initialized through a char
       float_precision( unsigned char, unsigned int, enum round_mode );  // When initialized through a unsigned char
@@ -262,11 +277,13 @@ class float_precision {
       float_precision( double, unsigned int, enum round_mode );         // When initialized through a double
       float_precision( const char *, unsigned int, enum round_mode );   // When initialized through a char string
       float_precision( const float_precision& s /*= float_precision(0, float_precision_ctrl.precision(), float_precision_ctrl.mode() )*/ ): mNumber(s.mNumber), mRmode(s.mRmode), mPrec(s.mPrec), mExpo(s.mExpo) {}  // When initialized through another float_precision
+      float_precision( float_precision&& s ): mRmode(s.mRmode), mPrec(s.mPrec), mExpo(s.mExpo), mNumber(std::move(s.mNumber)) { s.mNumber = "+"; s.mNumber += FCHARACTER(0); s.mExpo = 0; }  // When initialized through a temporary float_precision. s is left as +0
       float_precision( const int_precision&, unsigned int, enum round_mode ); 
 
       // Coordinate functions
       std::string get_mantissa() const             { return mNumber; };    // Copy of mantissa
       std::string *ref_mantissa()                  { return &mNumber; }    // Reference of Mantissa
+      const std::string *ref_mantissa() const      { return &mNumber; }    // Reference of Mantissa
       enum round_mode mode() const                 { return mRmode; }
       enum round_mode mode( enum round_mode m )    { return( mRmode = m ); }
       int exponent() const                         { return mExpo; };
@@ -276,6 +293,8 @@ class float_precision {
       unsigned precision( unsigned int p )         { int sign; std::string m;
                                                    sign = CHAR_SIGN( mNumber[0] );
                                                    mPrec = p > 0 ? p : float_precision_ctrl.precision();
+                                                   if( _fits( mNumber, mPrec ) )  // No rounding needed
+                                                      return mPrec;
                                                    m = (!mNumber.empty() ? mNumber.substr(1) : ""); // Bypass sign
                                                    mExpo += _float_precision_rounding( &m, sign, mPrec, mRmode );
                                                    mNumber = SIGN_STRING( sign ) + m;
@@ -295,7 +314,7 @@ class float_precision {
 
 	  // Conversion methods. Safer and less ambiguios than overloading implicit/explivit conversion operators
 	  std::string toString() const					{ return _float_precision_ftoa(this); }
-	  int_precision to_int_precision() const		{ std::string s = _float_precision_ftoainteger(this); return (int_precision)((char *)s.c_str()); }
+	  int_precision to_int_precision() const		{ return _float_precision_ftoi(this); }
 
 	  // Implict/explicit conversion operators
       operator char() const;
@@ -312,6 +331,7 @@ class float_precision {
 
       // Essential operators
       float_precision& operator= ( const float_precision& );
+      float_precision& operator= ( float_precision&& );
       float_precision& operator+=( const float_precision& );
       float_precision& operator-=( const float_precision& );
       float_precision& operator*=( const float_precision& );
@@ -708,18 +728,39 @@ inline float_precision::float_precision( double d, unsigned int p = float_precis
 ///
 /// Description:
 ///   Constructor for int_precision to float_precision
-///   Slow impl.
+///   If both use BASE_10 the integer digits are the mantissa digits, which are copied
+///   and rounded once to p digits. Otherwise the slow impl.
 ///    1) conver to Ascii decimal string and then 
 ///   2) convert it back to floating format
 //
 inline float_precision::float_precision( const int_precision& ip, unsigned int p = float_precision_ctrl.precision(), enum round_mode m = float_precision_ctrl.mode() )
    {
-   std::string s;
-
-   s = _int_precision_itoa( const_cast<int_precision*>(&ip) );
    mRmode = m;
    mPrec = p;
-   *this = float_precision( (char *)s.c_str(), p, m );
+   if( RADIX == BASE_10 && F_RADIX == BASE_10 )
+      {
+      const std::string *s = ip.pointer();
+      std::string::size_type last = s->find_last_not_of( ICHARACTER( 0 ) );
+
+      if( last == 0 )
+         { // Zero
+         mExpo = 0;
+         mNumber = "+"; mNumber += FCHARACTER( 0 );
+         }
+      else
+         { // Strip trailing zeros, the exponent is the number of digits - 1
+         mExpo = (int)s->length() - 2;
+         mNumber.assign( *s, 0, last + 1 );
+         }
+      precision( p );
+      }
+   else
+      {
+      std::string s;
+
+      s = _int_precision_itoa( const_cast<int_precision*>(&ip) );
+      *this = float_precision( (char *)s.c_str(), p, m );
+      }
    }
 
 //////////////////////////////////////////////////////////////////////////////////////
@@ -904,8 +945,7 @@ inline float_precision::operator unsigned char() const
 ///
 inline float_precision::operator int_precision() const
     {// Conversion to int_precision
-    std::string s = _float_precision_ftoainteger( this );
-    return (int_precision)( (char *)s.c_str() );
+    return _float_precision_ftoi( this );
     } 
 
 //////////////////////////////////////////////////////////////////////////////////////
@@ -934,6 +974,11 @@ inline float_precision& float_precision::operator=( const float_precision& a )
    int sign;
 
    mExpo = a.mExpo;   
+   if( _fits( a.mNumber, mPrec ) )  // No rounding needed. Copy into the existing buffer
+      {
+      mNumber = a.mNumber;
+      return *this;
+      }
    sign = a.sign();
    mNumber = (!a.mNumber.empty() ? a.mNumber.substr(1) : "");
    if( _float_precision_rounding( &mNumber, sign, mPrec, mRmode ) != 0 )  // Round back to left hand side precision
@@ -944,6 +989,29 @@ inline float_precision& float_precision::operator=( const float_precision& a )
    return *this;
    }
 
+///	@date  10/19/2026
+///	@brief 	Assign a temporary float precision number
+///	@return 	float_precision&	-	
+///	@param   "a"	-	float precsion number to assign
+///
+///	@todo
+///
+/// Description:
+///   Move assign operator
+///   Same semantic as the assign operator. Round it to precision and mode of the left hand side.
+///   If no rounding is needed the mantissa buffer of a is taken instead of copied
+//
+inline float_precision& float_precision::operator=( float_precision&& a )
+   {
+   if( this == &a || !_fits( a.mNumber, mPrec ) )
+      return *this = static_cast<const float_precision&>( a );
+
+   mExpo = a.mExpo;
+   mNumber.swap( a.mNumber );
+
+   return *this;
+   }
+
 
 ///	@author Henrik Vestermark (hve@hvks.com)
 ///	@date  1/21/2005
@@ -983,7 +1051,10 @@ inline float_precision& float_precision::operator+=( const float_precision& a )
    sign1 = a.sign();
    s1 = a.mNumber.substr( 1 ); // Extract Mantissa
    sign2 = CHAR_SIGN( mNumber[0] );
-   s2 = mNumber.substr( 1 );   // Extract Mantissa
+   if( this != &a )  // Take our own mantissa instead of copying it. It is replaced with the result
+      { s2.swap( mNumber ); s2.erase( 0, 1 ); }
+   else
+      s2 = mNumber.substr( 1 );   // Extract Mantissa
    expo_max = MAX( mExpo, a.mExpo );
    precision_max = MAX( mPrec, a.precision() );
 
@@ -1098,7 +1169,10 @@ inline float_precision& float_precision::operator*=( const float_precision& a )
    sign1 = a.sign();
    s1 = a.mNumber.substr( 1 );
    sign2 = CHAR_SIGN( mNumber[0] );
-   s2 = mNumber.substr( 1 );
+   if( this != &a )  // Take our own mantissa instead of copying it. It is replaced with the result
+      { s2.swap( mNumber ); s2.erase( 0, 1 ); }
+   else
+      s2 = mNumber.substr( 1 );
 
    sign = sign1 * sign2;
    // Check for multiplication of 1 digit and use umul_short().
@@ -1367,6 +1441,112 @@ inline float_precision operator/( const float_precision& a, const float_precisio
    }
 
 
+///	@date  10/19/2026
+///	@brief 	+ float precision numbers
+///	@return 	the resulting float_precision number
+///	@param   "a"	-	first float precsion number. A temporary
+///	@param   "b"	-	second float precsion number
+///
+///	@todo    
+///
+/// Description:
+///   Binary add where the first operand is a temporary. 
+///   The result is computed in a and moved out instead of building a new number.
+///   The precision of the result is the max precision of the operands
+//
+inline float_precision operator+( float_precision&& a, const float_precision& b )
+   {
+   if( a.precision() < b.precision() )
+      a.precision( b.precision() );
+   a += b;
+
+   return std::move( a );
+   }
+
+///	@date  10/19/2026
+///	@brief 	- float precision numbers
+///	@return 	the resulting float_precision number
+///	@param   "a"	-	first float precsion number. A temporary
+///	@param   "b"	-	second float precsion number
+///
+///	@todo    
+///
+/// Description:
+///   Binary subtract where the first operand is a temporary. 
+///   The result is computed in a and moved out instead of building a new number.
+///   The precision of the result is the max precision of the operands
+//
+inline float_precision operator-( float_precision&& a, const float_precision& b )
+   {
+   if( a.precision() < b.precision() )
+      a.precision( b.precision() );
+   a -= b;
+
+   return std::move( a );
+   }
+
+///	@date  10/19/2026
+///	@brief 	* float precision numbers
+///	@return 	the resulting float_precision number
+///	@param   "a"	-	first float precsion number. A temporary
+///	@param   "b"	-	second float precsion number
+///
+///	@todo    
+///
+/// Description:
+///   Binary multiplying where the first operand is a temporary. 
+///   The result is computed in a and moved out instead of building a new number.
+///   The precision of the result is the max precision of the operands
+//
+inline float_precision operator*( float_precision&& a, const float_precision& b )
+   {
+   if( a.precision() < b.precision() )
+      a.precision( b.precision() );
+   a *= b;
+
+   return std::move( a );
+   }
+
+///	@date  10/19/2026
+///	@brief 	/ float precision numbers
+///	@return 	the resulting float_precision number
+///	@param   "a"	-	first float precsion number. A temporary
+///	@param   "b"	-	second float precsion number
+///
+///	@todo    
+///
+/// Description:
+///   Binary divide where the first operand is a temporary. 
+///   The result is computed in a and moved out instead of building a new number.
+///   The precision of the result is the max precision of the operands plus one as for the / operator
+//
+inline float_precision operator/( float_precision&& a, const float_precision& b )
+   {
+   a.precision( ( a.precision() < b.precision() ? b.precision() : a.precision() ) + 1 );
+   a /= b;
+
+   return std::move( a );
+   }
+
+
+///	@date  10/19/2026
+///	@brief 	Unary - float precision number
+///	@return 	the resulting float_precision number
+///	@param   "a"	-	float precsion number. A temporary
+///
+///	@todo    
+///
+/// Description:
+///   Unary hypen Just change sign of the temporary and move it out
+//
+inline float_precision operator-( float_precision&& a )
+   {
+   a.change_sign();
+
+   return std::move( a );
+   }
+
+
 
 ///	@author Henrik Vestermark (hve@hvks.com)
 ///	@date  1/21/2005
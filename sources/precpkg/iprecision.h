@@ -87,6 +87,7 @@ static char _VI_[] = "@(#)iprecision.h 01.25 -- Copyright (C) Future Team Aps";
 
 #include <limits.h>
 #include <string>
+#include <utility>
 #include <complex>   // Need <complex> to support FFT functions for fast multiplications
 
 // For ANSI please remove comments from the next 3 line
@@ -120,6 +121,7 @@ static const int BASE_256 = 256;
 ///   This keep track of the internal Base for storing int_precision and Float_precision numbers.
 ///   Default int_precision radix is BASE_10
 ///   Default float_precision radix is BASE_10
+///   There is one instance per thread so threads can use different settings without interfering
 //
 class precision_ctrl {
    int mIRadix;			// Internal base of int_precision
@@ -136,7 +138,7 @@ class precision_ctrl {
 	  inline int F_RADIX( unsigned int fr )		{ return( mFRadix = fr ); }
       };
 
-extern precision_ctrl precision_ctrl;
+extern thread_local precision_ctrl precision_ctrl;
 
 static const int RADIX = BASE_10;			// Set internal base for the arbitrary precision
 
@@ -171,6 +173,11 @@ template <class _Ty> inline int_precision operator/( int_precision&, const _Ty&
 template <class _Ty> inline int_precision operator/( const _Ty&, const int_precision& );
 template <class _Ty> inline int_precision operator%( int_precision&, const _Ty& );
 template <class _Ty> inline int_precision operator%( const _Ty&, const int_precision& );
+inline int_precision operator+( int_precision&&, const int_precision& );  // Binary. Reuse the left operand
+inline int_precision operator-( int_precision&&, const int_precision& );  // Binary. Reuse the left operand
+inline int_precision operator*( int_precision&&, const int_precision& );  // Binary. Reuse the left operand
+inline int_precision operator/( int_precision&&, const int_precision& );  // Binary. Reuse the left operand
+inline int_precision operator%( int_precision&&, const int_precision& );  // Binary. Reuse the left operand
 template <class _Ty> inline int_precision operator<<( int_precision&, const _Ty& );
 template <class _Ty> inline int_precision operator<<( const _Ty&, const int_precision& );
 template <class _Ty> inline int_precision operator>>( int_precision&, const _Ty& );
@@ -253,6 +260,7 @@ class int_precision
       int_precision( unsigned long );   // When initialized through an unsigned long
       int_precision( const char * );    // When initialized through a char string
 	  int_precision( const int_precision& s) : mNumber(s.mNumber) {}  // When initialized through another int_precision
+	  int_precision( int_precision&& s) : mNumber(std::move(s.mNumber)) { s.mNumber = "+"; s.mNumber += ICHARACTER(0); }  // When initialized through a temporary int_precision. s is left as +0
 
          
       // Coordinate functions
@@ -284,6 +292,7 @@ class int_precision
 	  
       // Essential operators
       int_precision& operator=( const int_precision& );
+      int_precision& operator=( int_precision&& );
       int_precision& operator+=( const int_precision& );
       int_precision& operator-=( const int_precision& );
       int_precision& operator*=( const int_precision& );
@@ -728,6 +737,24 @@ inline int_precision& int_precision::operator=( const int_precision& a )
    return *this;
    }
 
+///	@date  10/19/2026
+///	@brief 	operator=
+///	@return 	static int_precision	-	return a=b
+///	@param   "a"	-	Temporary assignment operand
+///
+///	@todo 
+///
+/// Description:
+///   Move assign operator
+///   Take the buffer of a instead of copying it. a is left with the previous value of *this
+//
+inline int_precision& int_precision::operator=( int_precision&& a )
+   {
+   mNumber.swap( a.mNumber );
+
+   return *this;
+   }
+
 ///	@author Henrik Vestermark (hve@hvks.com)
 ///	@date  1/19/2005
 ///	@brief 	operator+=
@@ -749,7 +776,10 @@ inline int_precision& int_precision::operator+=( const int_precision& a )
    sign1 = a.sign(); 
    s1 = a.mNumber.substr( 1 );
    sign2 = CHAR_SIGN( mNumber[0] );
-   s2 = mNumber.substr( 1 );
+   if( this != &a )  // Take our own mantissa instead of copying it. It is replaced with the result
+      { s2.swap( mNumber ); s2.erase( 0, 1 ); }
+   else
+      s2 = mNumber.substr( 1 );
 
    if( sign1 == sign2 )
       mNumber = SIGN_STRING( sign1 ) + _int_precision_uadd( &s1, &s2 );
@@ -815,7 +845,10 @@ inline int_precision& int_precision::operator*=( const int_precision& a )
    sign1 = a.sign();
    s1 = a.mNumber.substr( 1 );
    sign2 = CHAR_SIGN( mNumber[0] );
-   s2 = mNumber.substr( 1 );
+   if( this != &a )  // Take our own mantissa instead of copying it. It is replaced with the result
+      { s2.swap( mNumber ); s2.erase( 0, 1 ); }
+   else
+      s2 = mNumber.substr( 1 );
 
    sign1 *= sign2;  // Check for multiplication of 1 digit and use umul_short().
    if(s1.length()==1 )
@@ -1126,7 +1159,10 @@ inline int_precision& int_precision::operator&=( const int_precision& a )
 ///
 template <class _Ty> inline int_precision operator+( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) += rhs; 
+   int_precision c(lhs);
+
+   c += rhs;
+   return c;
    }
 
 
@@ -1143,7 +1179,10 @@ template <class _Ty> inline int_precision operator+( int_precision& lhs, const _
 ///
 template <class _Ty> inline int_precision operator+( const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) += rhs; 
+   int_precision c(lhs);
+
+   c += rhs;
+   return c;
    }
 
 
@@ -1216,7 +1255,10 @@ inline int_precision operator++( int_precision& a, int )
 ///
 template <class _Ty> inline int_precision operator-( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) -= rhs; 
+   int_precision c(lhs);
+
+   c -= rhs;
+   return c;
    }
 
 
@@ -1233,7 +1275,10 @@ template <class _Ty> inline int_precision operator-( int_precision& lhs, const _
 ///
 template <class _Ty> inline int_precision operator-( const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) -= rhs; 
+   int_precision c(lhs);
+
+   c -= rhs;
+   return c;
    }
 
 
@@ -1309,7 +1354,10 @@ int_precision operator--( int_precision& a, int )
 ///
 template <class _Ty> inline int_precision operator*( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) *= rhs; 
+   int_precision c(lhs);
+
+   c *= rhs;
+   return c;
    }
 
 
@@ -1327,7 +1375,10 @@ template <class _Ty> inline int_precision operator*( int_precision& lhs, const _
 ///
 template <class _Ty> inline int_precision operator*( const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) *= rhs; 
+   int_precision c(lhs);
+
+   c *= rhs;
+   return c;
    }
 
 
@@ -1346,7 +1397,10 @@ template <class _Ty> inline int_precision operator*( const _Ty& lhs, const int_p
 ///
 template <class _Ty> inline int_precision operator/( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) /= rhs; 
+   int_precision c(lhs);
+
+   c /= rhs;
+   return c;
    }
 
 
@@ -1363,7 +1417,10 @@ template <class _Ty> inline int_precision operator/( int_precision& lhs, const _
 ///
 template <class _Ty> inline int_precision operator/( const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) /= rhs; 
+   int_precision c(lhs);
+
+   c /= rhs;
+   return c;
    }
 
 ///	@author Henrik Vestermark (hve@hvks.com)
@@ -1380,7 +1437,10 @@ template <class _Ty> inline int_precision operator/( const _Ty& lhs, const int_p
 ///
 template <class _Ty> inline int_precision operator%( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) %= rhs; 
+   int_precision c(lhs);
+
+   c %= rhs;
+   return c;
    }
 
 
@@ -1397,7 +1457,90 @@ template <class _Ty> inline int_precision operator%( int_precision& lhs, const _
 ///
 template <class _Ty> inline int_precision operator%( const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) %= rhs; 
+   int_precision c(lhs);
+
+   c %= rhs;
+   return c;
+   }
+
+///	@date  10/19/2026
+///	@brief 			operator+
+///	@return 	int_precision	-	return addition of lhs + rhs
+///	@param   "lhs"	-	First operand. A temporary
+///	@param   "rhs"	-	Second operand
+///
+/// Description:
+///   Addition where the left operand is a temporary. The result is computed in the 
+///   left operand and moved out instead of copying it first
+///
+inline int_precision operator+( int_precision&& lhs, const int_precision& rhs )
+   {
+   lhs += rhs;
+   return std::move( lhs );
+   }
+
+///	@date  10/19/2026
+///	@brief 			operator-
+///	@return 	int_precision	-	return subtraction of lhs - rhs
+///	@param   "lhs"	-	First operand. A temporary
+///	@param   "rhs"	-	Second operand
+///
+/// Description:
+///   Subtraction where the left operand is a temporary. The result is computed in the 
+///   left operand and moved out instead of copying it first
+///
+inline int_precision operator-( int_precision&& lhs, const int_precision& rhs )
+   {
+   lhs -= rhs;
+   return std::move( lhs );
+   }
+
+///	@date  10/19/2026
+///	@brief 			operator*
+///	@return 	int_precision	-	return multiplication of lhs * rhs
+///	@param   "lhs"	-	First operand. A temporary
+///	@param   "rhs"	-	Second operand
+///
+/// Description:
+///   Multiplication where the left operand is a temporary. The result is computed in the 
+///   left operand and moved out instead of copying it first
+///
+inline int_precision operator*( int_precision&& lhs, const int_precision& rhs )
+   {
+   lhs *= rhs;
+   return std::move( lhs );
+   }
+
+///	@date  10/19/2026
+///	@brief 			operator/
+///	@return 	int_precision	-	return division of lhs / rhs
+///	@param   "lhs"	-	First operand. A temporary
+///	@param   "rhs"	-	Second operand
+///
+/// Description:
+///   Division where the left operand is a temporary. The result is computed in the 
+///   left operand and moved out instead of copying it first
+///
+inline int_precision operator/( int_precision&& lhs, const int_precision& rhs )
+   {
+   lhs /= rhs;
+   return std::move( lhs );
+   }
+
+///	@date  10/19/2026
+///	@brief 			operator%
+///	@return 	int_precision	-	return remainder of lhs % rhs
+///	@param   "lhs"	-	First operand. A temporary
+///	@param   "rhs"	-	Second operand
+///
+/// Description:
+///   Remainder where the left operand is a temporary. The result is computed in the 
+///   left operand and moved out instead of copying it first
+///
+inline int_precision operator%( int_precision&& lhs, const int_precision& rhs )
+   {
+   lhs %= rhs;
+   return std::move( lhs );
    }
 
 ///	@author Henrik Vestermark (hve@hvks.com)
@@ -1414,7 +1557,10 @@ template <class _Ty> inline int_precision operator%( const _Ty& lhs, const int_p
 ///
 template <class _Ty> inline int_precision operator<<( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) <<= rhs; 
+   int_precision c(lhs);
+
+   c <<= rhs;
+   return c;
    }
 
 
@@ -1431,7 +1577,10 @@ template <class _Ty> inline int_precision operator<<( int_precision& lhs, const
 ///
 template <class _Ty> inline int_precision operator<<(  const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) <<= rhs; 
+   int_precision c(lhs);
+
+   c <<= rhs;
+   return c;
    }
 
 
@@ -1449,7 +1598,10 @@ template <class _Ty> inline int_precision operator<<(  const _Ty& lhs, const int
 ///
 template <class _Ty> inline int_precision operator>>( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) >>= rhs; 
+   int_precision c(lhs);
+
+   c >>= rhs;
+   return c;
    }
 
 
@@ -1466,7 +1618,10 @@ template <class _Ty> inline int_precision operator>>( int_precision& lhs, const
 ///
 template <class _Ty> inline int_precision operator>>( const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) >>= rhs; 
+   int_precision c(lhs);
+
+   c >>= rhs;
+   return c;
    }
 
 ///	@author Henrik Vestermark (hve@hvks.com)
@@ -1484,7 +1639,10 @@ template <class _Ty> inline int_precision operator>>( const _Ty& lhs, const int_
 ///
 template <class _Ty> inline int_precision operator&( int_precision& lhs, const _Ty& rhs )
    {
-   return int_precision(lhs) &= rhs; 
+   int_precision c(lhs);
+
+   c &= rhs;
+   return c;
    }
 
 
@@ -1501,7 +1659,10 @@ template <class _Ty> inline int_precision operator&( int_precision& lhs, const _
 ///
 template <class _Ty> inline int_precision operator&( const _Ty& lhs, const int_precision& rhs )
    {
-   return int_precision(lhs) &= rhs; 
+   int_precision c(lhs);
+
+   c &= rhs;
+   return c;
    }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -97,7 +97,7 @@ using namespace std;
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-class precision_ctrl precision_ctrl( BASE_10, BASE_10);
+thread_local class precision_ctrl precision_ctrl( BASE_10, BASE_10);
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -1250,7 +1250,16 @@ std::string _int_precision_itoa( const std::string *a )
 //    
 static std::string build_i_number( std::string &number, int digit, int base )
     {
-    if(RADIX >= BASE_10)
+    if( RADIX == BASE_10 && base == BASE_10 )
+       { // number*10+digit just appends the digit, but without leading zeros
+       if( number.length() == 1 && IDIGIT( number[0] ) == 0 )
+          number.erase();
+       if( number.length() > 0 || digit != 0 )
+          number += ICHARACTER( digit );
+       else
+          number = ICHARACTER( 0 );
+       }
+    else if(RADIX >= BASE_10)
        {
       number = _int_precision_umul_short( &number, base );
       number = _int_precision_uadd_short( &number, digit );
@@ -1497,7 +1506,7 @@ bool iprime( const int_precision& prime)
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-class float_precision_ctrl float_precision_ctrl(PRECISION,ROUND_NEAR);
+thread_local class float_precision_ctrl float_precision_ctrl(PRECISION,ROUND_NEAR);
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -1810,6 +1819,44 @@ std::string _float_precision_ftoainteger( const float_precision *a )
    }
 
 
+///	@brief 	Convert float_precision numbers into int_precision numbers
+///	@return 	int_precision - The integer part (truncated toward zero)
+///	@param   "a"	-	float_precision number to convert
+///
+///	@todo 	
+///
+/// Description:
+///   If both use BASE_10 the leading exponent+1 mantissa digits are the integer digits,
+///   so they are copied directly instead of a modf() and a round trip through an ascii string
+//
+int_precision _float_precision_ftoi( const float_precision *a )
+   {
+   int_precision i( 0 );
+
+   if( F_RADIX == BASE_10 && RADIX == BASE_10 )
+      {
+      std::string s = a->get_mantissa();
+      int expo = a->exponent();
+
+      if( expo >= 0 && FDIGIT( s[1] ) != 0 )
+         {
+         if( (int)s.length() - 1 > expo + 1 )
+            s.erase( expo + 2 );  // Truncate fraction
+         else
+            s.append( expo + 2 - s.length(), ICHARACTER( 0 ) );
+         *i.pointer() = s;
+         }
+      }
+   else
+      {
+      std::string s = _float_precision_ftoainteger( a );
+      i = int_precision( (char *)s.c_str() );
+      }
+
+   return i;
+   }
+
+
 ///	@author Henrik Vestermark (hve@hvks.com)
 ///	@date  1/21/2005
 ///	@brief 	Convert double (IEE754) into a float_precision numbers 
@@ -1982,7 +2029,16 @@ float_precision _float_precision_dtof( double d, unsigned int p, enum round_mode
 //
 static std::string buildnumber( std::string &number, int digit, int base )
     {
-    if(F_RADIX >= BASE_10)
+    if( F_RADIX == BASE_10 && base == BASE_10 )
+         { // number*10+digit just appends the digit, but without leading zeros
+         if( number.length() == 1 && FDIGIT( number[0] ) == 0 )
+            number.erase();
+         if( number.length() > 0 || digit != 0 )
+            number += FCHARACTER( digit );
+         else
+            number = FCHARACTER( 0 );
+         }
+    else if(F_RADIX >= BASE_10)
          {
          number = _float_precision_umul_short( &number, base );
          number = _float_precision_uadd_short( &number, digit );
@@ -3110,11 +3166,10 @@ float_precision float_precision::epsilon()
 float_precision _float_precision_inverse( const float_precision& a )
    {
    unsigned int precision;
-   int i, expo;
+   int expo;
    double fv, fu;
-   float_precision r, u, v, c2;
+   float_precision r, u, v, c1;
    std::string::reverse_iterator rpos;
-   std::string::iterator pos;
    std::string *p;
 
    precision = a.precision();  
@@ -3129,7 +3184,7 @@ float_precision _float_precision_inverse( const float_precision& a )
    v.exponent( 0 );
    r.precision( precision + 3 ); // Do iteration using 3 digits higher precision
    u.precision( precision + 3 );
-   c2 = float_precision( 2, precision + 3 );
+   c1 = float_precision( 1, precision + 3 );
 
    // Get a initial guess using ordinary floating point
    rpos = v.ref_mantissa()->rbegin();
@@ -3145,17 +3200,21 @@ float_precision _float_precision_inverse( const float_precision& a )
 
    u = float_precision( fu );
    
-   // Now iterate using Netwon Un=U(2-UV)
+   // Now iterate using Netwon Un=U(2-UV)=U-U(UV-1)
+   // The residual E=UV-1 is formed with fms() so it keeps its relative accuracy and only 
+   // the digits of E that affects U are kept for the correction.
+   // The error of Un is E^2 so we stop when E is below the square root of the precision
    for(;;)
       {
-      r = u * v;                 // UV
-      r = c2-r;                  // 2-UV
-      u *= r;                    // Un=U(2-UV)
-      for( pos = r.ref_mantissa()->begin(), pos+=2, i = 0; pos != r.ref_mantissa()->end(); i++, pos++ )
-         if( FDIGIT( *pos ) )
-            break;
-
-      if( pos == r.ref_mantissa()->end() || (unsigned)i >= precision )
+      r.precision( precision + 3 );
+      r = fms( u, v, c1 );       // E=UV-1
+      p = r.ref_mantissa();
+      if( ( p->length() == 2 && FDIGIT( (*p)[1] ) == 0 ) || r.exponent() < -(int)( precision + 3 ) )
+         break;
+      if( r.exponent() < 0 )
+         r.precision( precision + 3 + r.exponent() );
+      u -= u * r;                // Un=U-UE
+      if( r.exponent() < -(int)( precision + 3 ) / 2 )
          break;
       }
 
@@ -3185,13 +3244,12 @@ float_precision _float_precision_inverse( const float_precision& a )
 float_precision sqrt( const float_precision& x )
    {
    unsigned int precision;
-   int i, expo, expo_sq;
+   int expo, expo_sq;
    double fv, fu;
    float_precision r, u, v;
-   const float_precision c3(3);
+   const float_precision c1(1);
    const float_precision c05(0.5);
    std::string::reverse_iterator rpos;
-   std::string::iterator pos;
    std::string *p;
 
    precision = x.precision(); 
@@ -3227,19 +3285,21 @@ float_precision sqrt( const float_precision& x )
 
    u = float_precision( fu );
    
-   // Now iterate using Netwon Un=0.5U(3-VU^2)
+   // Now iterate using Netwon Un=0.5U(3-VU^2)=U-0.5U(VU^2-1)
+   // The residual E=VU^2-1 is formed with fms() so it keeps its relative accuracy and only 
+   // the digits of E that affects U are kept for the correction.
+   // The error of Un is about E^2 so we stop when E is below the square root of the precision
    for(;;)
       {
-      r = v * u * u;             // VU^2
-      r = c3-r;                  // 3-VU^2
-      r *= c05;                  // (3-VU^2)/2
-      u *= r;                    // U=U(3-VU^2)/2
-      
-      for( pos = r.ref_mantissa()->begin(), pos+=2, i = 0; pos != r.ref_mantissa()->end(); i++, pos++ )
-         if( FDIGIT( *pos ) )
-            break;
-
-      if( pos == r.ref_mantissa()->end() || (unsigned)i >= precision )
+      r.precision( precision + 2 );
+      r = fms( v * u, u, c1 );   // E=VU^2-1
+      p = r.ref_mantissa();
+      if( ( p->length() == 2 && FDIGIT( (*p)[1] ) == 0 ) || r.exponent() < -(int)( precision + 2 ) )
+         break;
+      if( r.exponent() < 0 )
+         r.precision( precision + 2 + r.exponent() );
+      u -= fmscale( u, r, c05 ); // Un=U-0.5UE
+      if( r.exponent() < -(int)( precision + 2 ) / 2 - 1 )
          break;
       }
 
@@ -3276,12 +3336,13 @@ float_precision sqrt( const float_precision& x )
 ///   If a higher precision is requested we create it and return otherwise 
 ///   we just the "constant" at a higher precision which eventually will be
 ///   rounded to the destination variables precision 
+///   The tables are per thread so no locking is needed when threads compute concurrently
 //
 float_precision _float_table( enum table_type tt, unsigned int precision )
    {
-   static float_precision ln2( 0, 0, ROUND_NEAR );
-   static float_precision ln10( 0, 0, ROUND_NEAR );
-   static float_precision pi( 0, 0, ROUND_NEAR );
+   thread_local static float_precision ln2( 0, 0, ROUND_NEAR );
+   thread_local static float_precision ln10( 0, 0, ROUND_NEAR );
+   thread_local static float_precision pi( 0, 0, ROUND_NEAR );
    const float_precision c1(1);
    float_precision res(0, precision );
 
@@ -3412,7 +3473,7 @@ float_precision _float_table( enum table_type tt, unsigned int precision )
                pi *= r;
                xsq = sqrt( x );
                xsq_inv = _float_precision_inverse( xsq );
-               y = ( y * xsq + xsq_inv ) / ( y + c1 );
+               y = fma( y, xsq, xsq_inv ) / ( y + c1 );
                if( r == c1 )
                     break;
                 if( rold == r )
@@ -3431,6 +3492,114 @@ float_precision _float_table( enum table_type tt, unsigned int precision )
    return res;
    }
 
+//////////////////////////////////////////////////////////////////////////////////////
+///
+/// FLOAT PRECISION FUNCTIONS
+///    Correct rounding of the elementary functions. Ziv's strategy
+///
+//////////////////////////////////////////////////////////////////////////////////////
+
+// Number of guard digits used for the first evaluation and the number of times the 
+// guard digits are doubled before the result is accepted as is.
+static const unsigned int ZIV_GUARD_DIGITS = 6;
+static const int ZIV_MAX_RETRY = 4;
+
+
+///	@date  10/19/2026
+///	@brief 		Check if a result computed with guard digits rounds unambiguously
+///	@return 	bool	-	true if the rounding to precision is safe otherwise false
+///	@param      "res"	-	The result computed with guard digits
+///	@param      "precision"	-	The precision to round to
+///	@param      "guard"	-	Number of guard digits in res
+///	@param      "mode"	-	Rounding mode
+///
+///	@todo 
+///
+/// Description:
+///   The result is assumed to be within one unit of the last but one guard digit.
+///   For ROUND_NEAR the rounding is ambiguous if the guard digits are close to 5000.. or 4999..
+///   For the directed modes it is ambiguous if the guard digits are close to 000.. or 999..
+///   Missing digits in the mantissa is zero.
+//
+static bool _float_precision_ziv_rounding( const float_precision& res, unsigned int precision, unsigned int guard, enum round_mode mode )
+   {
+   const std::string s = res.get_mantissa();
+   std::string::size_type i, first = 1 + precision, last = first + guard - 1;
+   char lead, rest;
+
+   if( FDIGIT( s[1] ) == 0 ) // Exact zero
+      return true;
+   lead = first < s.length() ? s[first] : FCHARACTER( 0 );
+   if( mode == ROUND_NEAR )
+      {
+      if( lead == FCHARACTER( 4 ) ) rest = FCHARACTER( 9 );
+      else 
+         if( lead == FCHARACTER( 5 ) ) rest = FCHARACTER( 0 );
+         else return true;
+      }
+   else
+      {
+      if( lead == FCHARACTER( 0 ) ) rest = FCHARACTER( 0 );
+      else 
+         if( lead == FCHARACTER( 9 ) ) rest = FCHARACTER( 9 );
+         else return true;
+      }
+
+   for( i = first + 1; i < last; i++ )
+      if( ( i < s.length() ? s[i] : FCHARACTER( 0 ) ) != rest )
+         return true;
+
+   return false;
+   }
+
+
+///	@date  10/19/2026
+///	@brief 		Evaluate a function kernel and return the correctly rounded result
+///	@return 	float_precision	-	return f(x) rounded to the precision and mode of x
+///	@param      "x"	-	float_precision argument
+///	@param      "kernel"	-	Functor evaluating f(x) at the precision of its argument
+///	@param      "lost"	-	Functor returning the number of digits lost to cancellation in the result
+///	@param      "extra"	-	Number of digits expected to be lost, avoids a second evaluation when known in advance
+///
+///	@todo 
+///
+/// Description:
+///   Ziv's strategy. Evaluate the kernel with a few guard digits beyond the wanted precision 
+///   and check if the result rounds unambiguously. In almost all cases it does and the result is returned.
+///   Otherwise the guard digits are doubled and the kernel evaluated again. 
+///   Before the rounding test the digits lost to cancellation, e.g. sin(x) near PI, is added to the working 
+///   precision since the kernel error is relative to the magnitude of the intermediate results and not the final result.
+///   After ZIV_MAX_RETRY attempts the result is accepted. This only happens for exact results like exp(0) or 
+///   results that are very close to a rounding boundary
+//
+template<class _Kernel, class _Lost> static float_precision _float_precision_ziv( const float_precision& x, _Kernel kernel, _Lost lost, unsigned int extra = 0 )
+   {
+   unsigned int guard = ZIV_GUARD_DIGITS;
+   int digits;
+   float_precision v, res;
+
+   for( int retry = 0;; )
+      {
+      v.precision( x.precision() + guard + extra );
+      v = x;
+      res.precision( v.precision() );  // Keep the guard digits, independent of the precision of the current thread
+      res = kernel( v );
+      digits = FDIGIT( res.get_mantissa()[1] ) == 0 ? 0 : lost( res );
+      if( digits > (int)extra && ++retry < ZIV_MAX_RETRY ) 
+         { extra = digits; continue; }  // Redo with the cancellation accounted for 
+      if( ++retry >= ZIV_MAX_RETRY || _float_precision_ziv_rounding( res, x.precision(), guard, x.mode() ) == true )
+         break;
+      guard *= 2;
+      }
+
+   // Round to same precision as argument and rounding mode
+   res.mode( x.mode() );
+   res.precision( x.precision() );  
+
+   return res;
+   }
+
+
 //////////////////////////////////////////////////////////////////////////////////////
 ///
 /// FLOAT PRECISION FUNCTIONS
@@ -3451,36 +3620,52 @@ float_precision _float_table( enum table_type tt, unsigned int precision )
 ///	@todo  
 ///
 /// Description:
-///   Use a the identity that exp(x)=sinh(x)+sqrt(1+sinh(x)^2)
+///   Use a the identity that exp(x)=sinh(x)+sqrt(1+sinh(x)^2)=sinh(x)+cosh(x)
 ///	  This has proven to be faster than the standard taylor series for exp()
 ///   exp(x) == 1 + x + x^2/2!+x^3/3!+....
+///   Both terms are taken from sinhcosh() which share the sinh() taylor series.
+///   The sum is always of two positive terms so no additional precision is needed for 1+sinh(x)^2
 //
-float_precision exp( const float_precision& x )
+static float_precision _float_precision_exp( const float_precision& x )
    {
    unsigned int precision;
-   float_precision v;
-   const float_precision c1(1);
+   float_precision v, sh, ch;
 
    precision = x.precision()+2;  
    v.precision( precision );
+   sh.precision( precision );
+   ch.precision( precision );
    v = x;
    if( v.sign() < 0 )
       v.change_sign();
   
-   v=sinh(v);
-   v.precision( 2 * precision );  // Double the precision to avoid loss of significant when performaing 1+v*v
-   v=v+sqrt(c1+v*v);
+   sinhcosh( v, &sh, &ch );
+   v = sh + ch;
 
-   v.precision( precision );
    if( x.sign() < 0 )
       v = _float_precision_inverse( v );
    // Round to same precision as argument and rounding mode
-   v.mode( x.mode() );v.mode( x.mode() );
+   v.mode( x.mode() );
    v.precision( x.precision() );  
 
    return v;
    }
 
+///	@date  10/19/2026
+///	@brief 		Calculate exp(x)
+///	@return 	   float_precision -	Return exp(x) correctly rounded
+///	@param      "x"	-	   The argument
+///
+///	@todo  
+///
+/// Description:
+///   Evaluate the exp() kernel using Ziv's strategy. exp() does not suffer from cancellation
+//
+float_precision exp( const float_precision& x )
+   {
+   return _float_precision_ziv( x, _float_precision_exp, []( const float_precision& ) { return 0; } );
+   }
+
 
 ///	@author Henrik Vestermark (hve@hvks.com)
 ///	@date  1/21/2005
@@ -3496,7 +3681,7 @@ float_precision exp( const float_precision& x )
 ///   ln(x) == 2( z + z^3/3 + z^5/5 ...
 ///   z = (x-1)/(x+1)
 //
-float_precision log( const float_precision& x )
+static float_precision _float_precision_log( const float_precision& x )
    {
    unsigned int precision;
    int j, k;
@@ -3587,6 +3772,27 @@ float_precision log( const float_precision& x )
    return res;
    }
 
+///	@date  10/19/2026
+///	@brief 		Calculate log(x)
+///	@return 	   float_precision -	Return log(x) correctly rounded
+///	@param      "x"	-	   The argument
+///
+///	@todo  
+///
+/// Description:
+///   Evaluate the log() kernel using Ziv's strategy. 
+///   The kernel adds expo*ln(10) to the log of the fraction which cancels when x is close to 1
+///   e.g. log(0.99999)=log(9.9999)-ln(10)
+//
+float_precision log( const float_precision& x )
+   {
+   if( x <= float_precision(0) ) 
+      { throw float_precision::domain_error(); return x; }
+
+   return _float_precision_ziv( x, _float_precision_log, 
+      [&x]( const float_precision& r ) { return x.exponent() == 0 ? 0 : (int)::log10( ::fabs( (double)x.exponent() ) * 2.302585093 ) - r.exponent(); } );
+   }
+
 
 
 ///	@author Henrik Vestermark (hve@hvks.com)
@@ -3664,8 +3870,16 @@ float_precision pow( const float_precision& x, const float_precision& y )
    
    if( yinteger == false ) // y is not an integer so do x^y= exp^(y*log(x)) the regular way
       {
-      res = log( x ) * y;
-      res= exp( res );
+      if( x <= float_precision(0) ) 
+         { throw float_precision::domain_error(); return x; }
+      // The absolute error of y*log(x) becomes the relative error of the result. 
+      // Since |y*log(x)| is about |exponent of result|*ln(10) the lost digits is found from the result
+      // and estimated in advance from |y|*(|exponent of x|+1)*ln(10)
+      double ylogx = ::fabs( (double)y ) * ( ::abs( x.exponent() ) + 1 ) * 2.302585093;
+      res = _float_precision_ziv( x, 
+               [&y]( const float_precision& v ) { float_precision r( v ); r = _float_precision_log( v ) * y; return _float_precision_exp( r ); },
+               []( const float_precision& r ) { return r.exponent() == 0 ? 0 : (int)::log10( ::fabs( (double)r.exponent() ) * 2.302585093 ) + 1; },
+               ylogx > 1.0 ? (unsigned int)::log10( ylogx ) + 1 : 0 );
       }
    else
       { // raise to the power of y when y is an integer. Use optimized method.
@@ -3728,13 +3942,117 @@ float_precision fmod( const float_precision& x, const float_precision& y )
       i.mode( ROUND_ZERO);
       i.precision( 1 + expo );
       i.mode( ROUND_NEAR );
-      f = x - i * y;
+      f = fms( i, y, x );  // x-i*y with a single rounding
+      f.change_sign();
       }
 
    return f;
    }
 
 
+///	@date  10/19/2026
+///	@brief 		Calculate fma(a,b,c)=a*b+c with a single rounding
+///	@return 	float_precision -	Return a*b+c
+///	@param      "a"	-	First factor
+///	@param      "b"	-	Second factor
+///	@param      "c"	-	The addend
+///
+///	@todo  
+///
+/// Description:
+///   Fused multiply add. Equivalent with the same standard C function call
+///   The product a*b is formed exact, at the sum of the digits in the mantissa of a and b. 
+///   The sum is formed with enough digits to hold both a*b and c unrounded, unless the exponents 
+///   are so far apart that the smaller term only acts as a sticky digit, and is then rounded once 
+///   to the max precision of a, b and c.
+///   Since the intermediate is not rounded there is no loss of precision when a*b and c cancel.
+//
+float_precision fma( const float_precision& a, const float_precision& b, const float_precision& c )
+   {
+   unsigned int precision, da, db, dc, dp, span, cap;
+   int lo_p, lo_c, hi;
+   float_precision p, s, res;
+
+   precision = MAX( MAX( a.precision(), b.precision() ), c.precision() );
+   res.precision( precision );
+
+   // Exact product
+   da = const_cast<float_precision&>( a ).ref_mantissa()->length() - 1;
+   db = const_cast<float_precision&>( b ).ref_mantissa()->length() - 1;
+   p.precision( da + db );
+   p = a;
+   p *= b;
+
+   // Number of digits needed to hold the exact sum incl. a carry
+   dp = p.ref_mantissa()->length() - 1;
+   dc = const_cast<float_precision&>( c ).ref_mantissa()->length() - 1;
+   lo_p = p.exponent() - (int)dp + 1;
+   lo_c = c.exponent() - (int)dc + 1;
+   hi = MAX( p.exponent(), c.exponent() ) + 1;
+   span = hi - MIN( lo_p, lo_c ) + 1;
+   cap = dp + dc + precision + 2;
+   s.precision( span < cap ? span : cap );
+   s = p;
+   s += c;
+
+   res = s;
+   return res;
+   }
+
+
+///	@date  10/19/2026
+///	@brief 		Calculate fms(a,b,c)=a*b-c with a single rounding
+///	@return 	float_precision -	Return a*b-c
+///	@param      "a"	-	First factor
+///	@param      "b"	-	Second factor
+///	@param      "c"	-	The subtrahend
+///
+///	@todo  
+///
+/// Description:
+///   Fused multiply subtract. Same as fma(a,b,-c)
+//
+float_precision fms( const float_precision& a, const float_precision& b, const float_precision& c )
+   {
+   return fma( a, b, -c );
+   }
+
+
+///	@date  10/19/2026
+///	@brief 		Calculate a*b*s with a single rounding
+///	@return 	float_precision -	Return a*b*s
+///	@param      "a"	-	First factor
+///	@param      "b"	-	Second factor
+///	@param      "s"	-	The scale factor
+///
+///	@todo  
+///
+/// Description:
+///   Fused multiply then scale. Both products are formed exact and the result is rounded once
+///   to the max precision of a, b and s. 
+///   Intended for short scale factors like 0.5 or 2^k where the second product is cheap
+//
+float_precision fmscale( const float_precision& a, const float_precision& b, const float_precision& s )
+   {
+   unsigned int precision, da, db, ds;
+   float_precision p, res;
+
+   precision = MAX( MAX( a.precision(), b.precision() ), s.precision() );
+   res.precision( precision );
+
+   da = const_cast<float_precision&>( a ).ref_mantissa()->length() - 1;
+   db = const_cast<float_precision&>( b ).ref_mantissa()->length() - 1;
+   ds = const_cast<float_precision&>( s ).ref_mantissa()->length() - 1;
+   p.precision( da + db + ds );
+   p = a;
+   p *= b;
+   p *= s;
+
+   res = p;
+   return res;
+   }
+
+
 ///	@author Henrik Vestermark (hve@hvks.com)
 ///	@date  1/21/2005
 ///	@brief 		Calculate floor(x)
@@ -4237,7 +4555,7 @@ float_precision acos( const float_precision& x )
 ///   The argument reduction is used to reduced the number of taylor iteration 
 ///   and to minimize round off erros and calculation time
 //
-float_precision sin( const float_precision& x )
+static float_precision _float_precision_sin( const float_precision& x )
    {
    unsigned int precision;
    int k, sign, j;
@@ -4274,7 +4592,7 @@ float_precision sin( const float_precision& x )
          {
          r = v / u; 
          (void)modf( r, &r ); 
-         v -= r * u;
+         v = -fms( r, u, v );  // v-r*u with a single rounding
          }
       if( v < float_precision( 0 ) )
          v += u;
@@ -4314,7 +4632,7 @@ float_precision sin( const float_precision& x )
       }
 
    for( ; k > 0 ; k-- )
-      u *= ( c3 - c4 * u * u );
+      u *= -fms( c4 * u, u, c3 );  // 3-4u^2 with a single rounding
 
    // Round to same precision as argument and rounding mode
    u.mode( x.mode() );
@@ -4326,29 +4644,54 @@ float_precision sin( const float_precision& x )
    return u;
    }
 
-///	@author Henrik Vestermark (hve@hvks.com)
-///	@date  1/21/2005
-///	@brief 		cos
-///	@return 	float_precision	-	return cos(x)
+///	@date  10/19/2026
+///	@brief 		sin
+///	@return 	float_precision	-	return sin(x) correctly rounded
 ///	@param      "x"	-	float_precision argument
 ///
 ///	@todo 
 ///
 /// Description:
-///   Use the taylor series. Cos(x) = 1 - x^2/2! + x^4/4! - x^6/6! ...
-///   1) However first reduce x to between 0..2*PI
-///   2) Then reduced it further to between 0..PI using cos(x)=Cos(2PI-x) for x >= PI
-///   3) Now use the trisection identity cos(3x)=-3*cos(x)+4*cos(x)^3
-///      until argument is less than 0.5/3^argument reduction
-///   4) Finally use Taylor 
+///   Evaluate the sin() kernel using Ziv's strategy. 
+///   Digits are lost in the reduction to 0..2*PI for large x and when x is close to a multiple of PI.
+///   In both cases the lost digits is the difference between the exponent of x and the result.
+///   A difference of one digit is not counted, since it only comes from the decimal exponents e.g. sin(2)=0.909..
+///   and an error of less than a factor 10 is covered by the kernel guard digits and the rounding test
 //
-float_precision cos( const float_precision& x )
+float_precision sin( const float_precision& x )
+   {
+   return _float_precision_ziv( x, _float_precision_sin, 
+      [&x]( const float_precision& r ) { return x.exponent() - r.exponent() - 1; }, x.exponent() > 0 ? x.exponent() : 0 );
+   }
+
+///	@date  10/19/2026
+///	@brief 		_float_precision_sincos
+///	@return 	nothing
+///	@param      "x"	-	float_precision argument
+///	@param      "s"	-	pointer receiving sin(x)
+///	@param      "c"	-	pointer receiving cos(x)
+///
+///	@todo 
+///
+/// Description:
+///   Calculate sin(x) and cos(x) with a single argument reduction and a single taylor series
+///   1) Reduce x to between 0..2*PI and further to between 0..PI exactly as sin() does.
+///      sin(x+PI)=-sin(x) and cos(x+PI)=-cos(x)
+///   2) Reduce it to below 0.5/3^reduction factor and run the sin() taylor series
+///   3) Since the reduced argument is small, h=1-cos(v) is obtained without cancellation as
+///         h=sin(v)^2/(1+sqrt(1-sin(v)^2))
+///   4) Apply the trisection identities to both results
+///         sin(3x)=sin(x)(3-4*sin(x)^2)
+///         1-cos(3x)=h(3-2h)^2
+///      The versine h keeps its relative accuracy through the trisection steps, which cos(3x)=4cos(x)^3-3cos(x) does not
+//
+static void _float_precision_sincos( const float_precision& x, float_precision *s, float_precision *c )
    {
    unsigned int precision;
-   int k, j;
+   int k, sign, csign, j;
    double zd;
-   float_precision r, u, v, v2, de(0);
-   const float_precision c05(0.5), c1(1), c2(2), c3(3), c4(4);
+   float_precision r, u, v, v2, h, de(0);
+   const float_precision c1(1), c2(2), c3(3), c4(4);
 
    precision = x.precision() + 2;  
    // Check for augument reduction and increase precision if necessary
@@ -4362,50 +4705,53 @@ float_precision cos( const float_precision& x )
    u.precision( precision );
    v.precision( precision );
    v2.precision( precision );
+   h.precision( precision );
 
    v = x;
- 
+   sign = v.sign();   // sin(-x)=-sin(x) and cos(-x)=cos(x)
+   csign = 1;
+   if( sign < 0 )
+      v.change_sign();
+   
    // Check that argument is larger than 2*PI and reduce it if needed. 
-   // No need for high perecision. we just need to figure out if we need to Calculate PI with a higher precision
-   if( abs( v ) > float_precision( 2*3.14159265 ) )
-      {  // Reduce argument to between 0..2P
-	  u = _float_table( _PI, precision );
+   if( v > float_precision( 2*3.14159265 ) )
+      {
+      // Reduce argument to between 0..2PI
+      u = _float_table( _PI, precision );
       u *= c2;
       if( abs( v ) > u )
          {
          r = v / u; 
          (void)modf( r, &r ); 
-         v -= r * u;
+         v = -fms( r, u, v );  // v-r*u with a single rounding
          }
       if( v < float_precision( 0 ) )
          v += u;
-      }
-
-   // Reduced it further to between 0..PI. 
-   // However avoid calculating PI is not needed.
-   // No need for high perecision. we just need to figure out if we need to Calculate PI with a higher precision
-   if( abs( v ) > float_precision( 3.14159265 ) )
+	  }   
+   
+   // Reduced it further to between 0..PI
+   if( v > float_precision( 3.14159265 ) )
       {
-      r = _float_table( _PI, precision );
-      if( v > r )
-         v = r * c2 - v;
+	  u = _float_table( _PI, precision );
+	  if( v > u )
+		  { v -= u; sign *= -1; csign = -1; }
       }
 
-   // Now use the trisection identity cos(3x)=-3*cos(x)+4*cos(x)^3
-   // until argument is less than 0.5/3^j  Where J is the number of reduction factor based on the needed precision of the argument.
-   v2= abs( v * float_precision( 2 * pow( 3.0, j ) ) );
+   // Reduce the argument to less than 0.5/3^j for the trisection identities
+   v2= v * float_precision( 2 * pow( 3.0, j ) );
    for( k = 0, r = c1; v2 > r; k++ )
       r *= c3;
    v /= r;
 
    v2 = v * v;
-   r = c1;
-   u = r;
-   // Now iterate using taylor expansion
-   for( unsigned int j=2;; j+=2 )
+   r = v;
+   u = v;
+
+   // Now iterate using taylor expansion of sin()
+   for( unsigned int j=3;; j+=2 )
       {
       de += float_precision( 4 * j - 6 ); // Avoid the multiplication in float_precision. 
-      v = v2 / de;  // de is only 20 digits standard preecision but since v2 is precision is will be extended to v2 precision //( j<USHRT_MAX? float_precision( j * (j-1) ) : float_precision(j) * float_precision( j-1) );
+      v = v2 / de;
       r *= v;
       r.change_sign();
       if( u + r == u )
@@ -4413,14 +4759,78 @@ float_precision cos( const float_precision& x )
       u += r;
       }
 
+   // Versine of the reduced argument
+   v2 = u * u;
+   h = v2 / ( c1 + sqrt( c1 - v2 ) );
+
    for( ; k > 0 ; k-- )
-      u *= ( c4 * u * u - c3 );
- 
+      {
+      v = c3 - c2 * h;
+      h *= v * v;
+      u *= -fms( c4 * u, u, c3 );  // 3-4u^2 with a single rounding
+      }
+
+   h = c1 - h;
+
    // Round to same precision as argument and rounding mode
    u.mode( x.mode() );
    u.precision( x.precision() );  
+   h.mode( x.mode() );
+   h.precision( x.precision() );  
 
-   return u;
+   if( sign < 0 )
+      u.change_sign();
+   if( csign < 0 )
+      h.change_sign();
+
+   s->precision( x.precision() );
+   s->mode( x.mode() );
+   *s = u;
+   c->precision( x.precision() );
+   c->mode( x.mode() );
+   *c = h;
+   }
+
+///	@author Henrik Vestermark (hve@hvks.com)
+///	@date  1/21/2005
+///	@brief 		cos
+///	@return 	float_precision	-	return cos(x) correctly rounded
+///	@param      "x"	-	float_precision argument
+///
+///	@todo 
+///
+/// Description:
+///   Take cos(x) from the sincos() kernel and evaluate it using Ziv's strategy.
+///   The trisection identity cos(3x)=-3*cos(x)+4*cos(x)^3 amplifies the error about 9 times per step 
+///   while sincos() keeps the relative accuracy of the versine 1-cos(x) through the same reduction.
+///   Digits are lost in the reduction to 0..2*PI for large x and when x is close to PI/2+n*PI
+//
+static float_precision _float_precision_cos( const float_precision& x )
+   {
+   float_precision s( 0, x.precision(), x.mode() ), c( 0, x.precision(), x.mode() );
+
+   _float_precision_sincos( x, &s, &c );
+   return c;
+   }
+
+///	@date  10/19/2026
+///	@brief 		cos
+///	@return 	float_precision	-	return cos(x) correctly rounded
+///	@param      "x"	-	float_precision argument
+///
+///	@todo 
+///
+/// Description:
+///   Evaluate the cos() kernel using Ziv's strategy. 
+///   Digits are lost in the reduction to 0..2*PI for large x and when x is close to PI/2+n*PI.
+///   In both cases the lost digits is the difference between the exponent of x (at least 0) and the result.
+///   A difference of one digit is not counted, since it only comes from the decimal exponents e.g. cos(0.5)=0.877..
+///   and an error of less than a factor 10 is covered by the kernel guard digits and the rounding test
+//
+float_precision cos( const float_precision& x )
+   {
+   return _float_precision_ziv( x, _float_precision_cos, 
+      [&x]( const float_precision& r ) { return ( x.exponent() > 0 ? x.exponent() : 0 ) - r.exponent() - 1; }, x.exponent() > 0 ? x.exponent() : 0 );
    }
 
 
@@ -4456,7 +4866,7 @@ float_precision tan( const float_precision& x )
       {
       r = v / u; 
       (void)modf( r, &r ); 
-      v -= r * u;
+      v = -fms( r, u, v );  // v-r*u with a single rounding
       }
    if( v < float_precision( 0 ) )
       v += u;
@@ -4465,7 +4875,7 @@ float_precision tan( const float_precision& x )
    if( v == p || v ==  p * c3 )
       { throw float_precision::domain_error(); return x; }
 
-   u = sin( v ); 
+   u = _float_precision_sin( v ); 
    if( v < p || v > p * c3 ) 
       u /= sqrt( c1 - u * u );
    else
@@ -4478,6 +4888,55 @@ float_precision tan( const float_precision& x )
    return u;
    }
 
+///	@date  10/19/2026
+///	@brief 		sincos
+///	@return 	nothing
+///	@param      "x"	-	float_precision argument
+///	@param      "s"	-	pointer receiving sin(x) correctly rounded
+///	@param      "c"	-	pointer receiving cos(x) correctly rounded
+///
+///	@todo 
+///
+/// Description:
+///   Evaluate the sincos() kernel using Ziv's strategy, like sin() and cos() do for each result.
+///   The lost digits are counted for both results and both results must round unambiguously
+//
+void sincos( const float_precision& x, float_precision *s, float_precision *c )
+   {
+   unsigned int guard = ZIV_GUARD_DIGITS, extra = x.exponent() > 0 ? x.exponent() : 0;
+   int digits, cdigits;
+   float_precision v, rs, rc;
+
+   auto lost = []( const float_precision& r, int e ) { return FDIGIT( r.get_mantissa()[1] ) == 0 ? 0 : e - r.exponent() - 1; };
+
+   for( int retry = 0;; )
+      {
+      v.precision( x.precision() + guard + extra );
+      v = x;
+      rs.precision( v.precision() );
+      rc.precision( v.precision() );
+      _float_precision_sincos( v, &rs, &rc );
+      digits = lost( rs, x.exponent() );
+      cdigits = lost( rc, x.exponent() > 0 ? x.exponent() : 0 );
+      if( cdigits > digits ) 
+         digits = cdigits;
+      if( digits > (int)extra && ++retry < ZIV_MAX_RETRY ) 
+         { extra = digits; continue; }  // Redo with the cancellation accounted for 
+      if( ++retry >= ZIV_MAX_RETRY || ( _float_precision_ziv_rounding( rs, x.precision(), guard, x.mode() ) == true &&
+                                        _float_precision_ziv_rounding( rc, x.precision(), guard, x.mode() ) == true ) )
+         break;
+      guard *= 2;
+      }
+
+   // Round to same precision as argument and rounding mode
+   s->precision( x.precision() );
+   s->mode( x.mode() );
+   *s = rs;
+   c->precision( x.precision() );
+   c->mode( x.mode() );
+   *c = rc;
+   }
+
 
 //////////////////////////////////////////////////////////////////////////////////////
 ///
@@ -4663,20 +5122,20 @@ float_precision cosh( const float_precision& x )
 ///	@todo  
 ///
 /// Description:
-//	tanh = ( exp(x) - exp(-x) ) / ( exp( x) + exp(-x) )=(e^(2x)-1/(e^(2x)+1)
-// 
+//	tanh = ( exp(x) - exp(-x) ) / ( exp( x) + exp(-x) )=sinh(x)/cosh(x)
+//	Both are taken from sinhcosh(). Unlike (e^(2x)-1)/(e^(2x)+1) this does not
+//	lose significant digits to cancellation when x is small
 //
 float_precision tanh( const float_precision& x )
    {
-   float_precision v, v2;
-   const float_precision c1(1);
+   float_precision v, sh, ch;
 
    v.precision( x.precision() + 1 );
-   v2.precision( x.precision() + 1 );
+   sh.precision( x.precision() + 1 );
+   ch.precision( x.precision() + 1 );
    v = x;
-   v = exp( v );
-   v2= v * v;
-   v = (v2-c1)/(v2+c1);
+   sinhcosh( v, &sh, &ch );
+   v = sh / ch;
 
    // Round to same precision as argument and rounding mode
    v.mode( x.mode() );
@@ -4685,6 +5144,40 @@ float_precision tanh( const float_precision& x )
    return v;
    }
 
+///	@date  10/19/2026
+///	@brief 		Calculate Sinh(x) and Cosh(x)
+///	@return 	nothing
+///	@param      "x"	-	   The argument
+///	@param      "sh"	-	   pointer receiving Sinh(x)
+///	@param      "ch"	-	   pointer receiving Cosh(x)
+///
+///	@todo  
+///
+/// Description:
+//	Evaluate the sinh() taylor series once and derive cosh(x)=sqrt(1+sinh(x)^2)
+//	1+sinh(x)^2 is a sum of two positive terms so there is no cancellation for any x
+//	This is the shared kernel of exp() and tanh()
+//
+void sinhcosh( const float_precision& x, float_precision *sh, float_precision *ch )
+   {
+   float_precision s, c;
+   const float_precision c1(1);
+
+   s.precision( x.precision() + 2 );
+   c.precision( x.precision() + 2 );
+   s = x;
+   s = sinh( s );
+   c = sqrt( c1 + s * s );
+
+   // Round to same precision as argument and rounding mode
+   sh->precision( x.precision() );
+   sh->mode( x.mode() );
+   *sh = s;
+   ch->precision( x.precision() );
+   ch->mode( x.mode() );
+   *ch = c;
+   }
+
 ///	@author Henrik Vestermark (hve@hvks.com)
 ///	@date  6/25/2013
 ///	@brief 		Calculate ArcSinh(x)
@@ -151,7 +151,7 @@ bool WinFrame::ExecExpr(const std::string& expr)
         ShowConstants();
     else if (expr == "clear")
     {
-        constantsSet_.constants.clear();
+        constantsSet_.Clear();
         constantsSet_.ResetStd();
         ShowConstants();
     }
@@ -449,11 +449,13 @@ void WinFrame::ShowConstants()
 {
     wxArrayString s;
 
+    const auto constants = constantsSet_.List();
+
     std::size_t maxLen = 0;
-    for (const auto& c : constantsSet_.constants)
+    for (const auto& c : constants)
         maxLen = std::max(maxLen, c.first.size());
 
-    for (const auto& c : constantsSet_.constants)
+    for (const auto& c : constants)
         s.Add(c.first + std::string(maxLen - c.first.size(), ' ') + " = " + c.second);
 
     SetOutput(s);
@@ -574,7 +576,7 @@ bool WinFrame::SaveConfig(const std::string& filename)
         W("$history_" + std::to_string(historyIdx++), v);
 
     /* Store constants */
-    for (const auto& c : constantsSet_.constants)
+    for (const auto& c : constantsSet_.List())
         W(c.first, c.second);
 
     return true;
@@ -648,7 +650,7 @@ bool WinFrame::LoadConfig(const std::string& filename)
                 inCtrl_->GetHistory().Add(value);
         }
         else
-            constantsSet_.constants[ident] = value;
+            constantsSet_.Set(ident, value);
     }
 
     return true;
@@ -6,7 +6,12 @@
  */
 
 #include <Abacus/Abacus.h>
+#include "../sources/Variable.h"
+#include <functional>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 
 using namespace Ac;
@@ -38,7 +43,7 @@ class Printer : public Visitor
         {
         }
 
-        void VisitUnaryExpr(UnaryExpr* ast, void* args) override
+        void VisitUnaryExpr(UnaryExpr* ast, void*) override
         {
             log_.Info("Unary Expr");
             auto dummy = log_.Indent();
@@ -46,7 +51,7 @@ class Printer : public Visitor
             Visit(ast->expr);
         }
 
-        void VisitBinaryExpr(BinaryExpr* ast, void* args) override
+        void VisitBinaryExpr(BinaryExpr* ast, void*) override
         {
             log_.Info("Binary Expr");
             auto dummy = log_.Indent();
@@ -55,17 +60,17 @@ class Printer : public Visitor
             Visit(ast->exprR);
         }
 
-        void VisitLiteralExpr(LiteralExpr* ast, void* args) override
+        void VisitLiteralExpr(LiteralExpr* ast, void*) override
         {
             log_.Info("Literal Expr: " + ast->value);
         }
 
-        void VisitIdentExpr(IdentExpr* ast, void* args) override
+        void VisitIdentExpr(IdentExpr* ast, void*) override
         {
             log_.Info("Ident Expr: " + ast->value);
         }
 
-        void VisitFuncExpr(FuncExpr* ast, void* args) override
+        void VisitFuncExpr(FuncExpr* ast, void*) override
         {
             log_.Info("Func Expr: " + ast->name);
             auto dummy = log_.Indent();
@@ -73,7 +78,7 @@ class Printer : public Visitor
                 Visit(arg);
         }
 
-        void VisitFoldExpr(FoldExpr* ast, void* args) override
+        void VisitFoldExpr(FoldExpr* ast, void*) override
         {
             log_.Info("Fold Expr: " + ast->func);
             auto dummy = log_.Indent();
@@ -83,7 +88,7 @@ class Printer : public Visitor
             Visit(ast->loopExpr);
         }
 
-        void VisitVectorExpr(VectorExpr* ast, void* args) override
+        void VisitVectorExpr(VectorExpr* ast, void*) override
         {
             log_.Info("Vector Expr");
             auto dummy = log_.Indent();
@@ -91,7 +96,7 @@ class Printer : public Visitor
                 Visit(comp);
         }
 
-        void VisitDefExpr(DefExpr* ast, void* args) override
+        void VisitDefExpr(DefExpr* ast, void*) override
         {
             log_.Info("Def Expr: " + ast->ident);
             auto dummy = log_.Indent();
@@ -104,6 +109,70 @@ class Printer : public Visitor
 
 };
 
+// Log which keeps the last error instead of printing it.
+class ErrorLog : public Log
+{
+
+    public:
+
+        void Error(const std::string& msg) override
+        {
+            error = msg;
+        }
+
+        std::string error;
+
+};
+
+// Regression case: the expression must give the expected result, or an error which contains the expected text behind "ERR:".
+struct TestCase
+{
+    const char*     expr;
+    unsigned int    precision;
+    const char*     expected;
+};
+
+/*
+Computes all test cases, prints the failed ones, and returns the number of failures.
+Each case has its own constants, unless the cases share the specified constants (e.g. for definitions).
+*/
+static int RunTests(const std::string& title, const std::vector<TestCase>& cases, ComputeMode mode = ComputeMode(), ConstantsSet* sharedConstants = nullptr)
+{
+    std::cout << std::endl << title << ":" << std::endl << std::string(title.size() + 1, '-') << std::endl;
+
+    int failures = 0;
+
+    for (const auto& c : cases)
+    {
+        ErrorLog log;
+        ConstantsSet ownConstants;
+
+        mode.precision = c.precision;
+        auto result = Compute(c.expr, mode, (sharedConstants ? *sharedConstants : ownConstants), &log);
+
+        const std::string expected = c.expected;
+        const bool isError = (expected.compare(0, 4, "ERR:") == 0);
+
+        bool passed = false;
+        if (isError)
+            passed = (result.empty() && log.error.find(expected.substr(4)) != std::string::npos);
+        else
+            passed = (result == expected);
+
+        if (!passed)
+        {
+            std::cout << "FAILED: " << c.expr << " (precision " << c.precision << ")" << std::endl;
+            std::cout << "  expected: " << expected << std::endl;
+            std::cout << "  result:   " << (result.empty() ? "error: " + log.error : result) << std::endl;
+            ++failures;
+        }
+    }
+
+    std::cout << (cases.size() - failures) << " of " << cases.size() << " passed" << std::endl;
+
+    return failures;
+}
+
 int main()
 {
     LogOutput log;
@@ -146,7 +215,7 @@ int main()
     Compute("y = -123.456", mode, constants, &log);
     Compute("z = 5.1", mode, constants, &log);
 
-    for (const auto& c : constants.constants)
+    for (const auto& c : constants.List())
         std::cout << c.first << " = " << c.second << std::endl;
 
     // compute test
@@ -163,11 +232,582 @@ int main()
         std::cout << "x = " << Compute("x", mode, constants, &log) << std::endl;
     }
 
+    // regression tests
+    int failures = 0;
+
+    failures += RunTests(
+        "rounding",
+        {
+            /* Results are correctly rounded by each tier (long double, double-double, fixed-point, and precpkg) */
+            { "2/3",                            10,     "0.6666666667"                      },
+            { "sqrt(2)",                        16,     "1.414213562373095"                 },
+            { "sin(1)",                         16,     "0.8414709848078965"                },
+            { "sin(10^20)",                     16,     "-0.6452512852657808"               },
+            { "exp(1)",                         20,     "2.7182818284590452354"             },
+            { "log(10)",                        20,     "2.302585092994045684"              },
+            { "sin(10^20)",                     20,     "-0.64525128526578084421"           },
+            { "sin(2^52)",                      20,     "0.87421730262363507348"            },
+            { "sqrt(2)",                        50,     "1.4142135623730950488016887242096980785696718753769" },
+            { "exp(1)",                         50,     "2.7182818284590452353602874713526624977572470937" },
+            { "sin(1)",                         50,     "0.84147098480789650665250232163029899962256306079837" },
+            { "sin(10^20)",                     50,     "-0.6452512852657808442058117113125230074069041966869" },
+            { "sin(2^52)",                      50,     "0.87421730262363507347993974516648278706143220839324" },
+            { "sqrt(2)",                        100,    "1.414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641573" },
+            { "atan(1)",                        100,    "0.785398163397448309615660845819875721049292349843776455243736148076954101571552249657008706335529267" },
+            { "sin(10^20)",                     100,    "-0.6452512852657808442058117113125230074069041966868971183031170068878986162188568608555379550092177132" },
+            { "sin(2)",                         160,    "0.9092974268256816953960198659117448427022549714478902683789730115309673015407835446201266889249593803099678967423994862612809531086753281202700203397467737828484" },
+            { "cos(0.5)",                       160,    "0.8775825618903727161162815826038296519916451971097440529976108683159507632742139474057941840846822583554784005931090539934138279768332802667997561209502240155876" },
+        }
+    );
+
+    ComputeMode quickMode;
+    quickMode.quick = true;
+
+    failures += RunTests(
+        "quick answers",
+        {
+            /* Quick answers have the digits of the hardware type, but integer results and definitions are always exact */
+            { "sqrt(2)",                        50,     "1.41421356237309505"               },
+            { "1/3",                            50,     "0.333333333333333333"              },
+            { "sqrt(2)",                        10,     "1.414213562"                       },
+            { "3^50",                           50,     "717897987691852588770249"          },
+            { "25!",                            50,     "15511210043330985984000000"        },
+            { "sum[k=1,10] k^2",                50,     "385"                               },
+            { "x = 2^70",                       50,     "1180591620717411303424"            },
+        },
+        quickMode
+    );
+
+    /* Elementary functions round to the precision of their argument, independent of the precision of the current thread */
+    {
+        std::cout << std::endl << "argument precision:" << std::endl << "-------------------" << std::endl;
+
+        const float_precision x("0.7", 40, ROUND_NEAR), y("2.5", 40, ROUND_NEAR);
+
+        auto Results = [&]()
+        {
+            return std::vector<float_precision> { sin(x), cos(x), exp(x), ::log(y), pow(y, x) };
+        };
+
+        const auto prevPrecision = float_precision_ctrl.precision();
+        float_precision_ctrl.precision(40);
+        const auto expected = Results();
+        float_precision_ctrl.precision(5);
+        const auto results = Results();
+        float_precision_ctrl.precision(prevPrecision);
+
+        int numPassed = 0;
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            if (results[i].precision() == 40 && results[i] == expected[i])
+                ++numPassed;
+            else
+            {
+                std::cout << "FAILED: function " << i << " with a precision of 5 digits for the current thread" << std::endl;
+                ++failures;
+            }
+        }
+
+        std::cout << numPassed << " of " << results.size() << " passed" << std::endl;
+    }
+
+    failures += RunTests(
+        "folds",
+        {
+            /* Nested folds on the fast path (low precision) and on the slow path */
+            { "sum[i=1,10] sum[j=1,3] i*j",     30,     "330"                               },
+            { "sum[i=1,10] sum[j=1,3] i*j",     200,    "330"                               },
+            { "sum[i=1,10] sum[i=1,3] i",       16,     "ERR:index variable 'i' already defined" },
+            { "sum[i=1,10] sum[i=1,3] i",       30,     "ERR:index variable 'i' already defined" },
+            { "sum[i=1,10] sum[i=1,3] i",       100,    "ERR:index variable 'i' already defined" },
+            { "sum[i=1,10] sum[i=1,3] i",       200,    "ERR:index variable 'i' already defined" },
+            { "sum[pi=1,3] pi",                 30,     "ERR:index variable 'pi' already defined" },
+            { "sum[k=1,3] sum[j=k,3] j",        30,     "14"                                },
+            { "sum[k=1.5,3] k",                 30,     "ERR:can only have discrete iterations" },
+        }
+    );
+
+    failures += RunTests(
+        "parallel folds",
+        {
+            /* Folds beyond the parallel threshold give the same result in every run, independent of the chunk order */
+            { "sum[k=1,2000] sqrt(k)",          16,     "59650.6331252394"                  },
+            { "sum[k=1,2000] sqrt(k)",          50,     "59650.633125239400160008385040141899840841162893437" },
+            { "sum[k=1,2000] sqrt(k)",          50,     "59650.633125239400160008385040141899840841162893437" },
+            { "sum[k=1,3000] 1/k",              50,     "8.583749889959187114343792091258973719948621235283" },
+            { "sum[k=1,3000] 1/k",              50,     "8.583749889959187114343792091258973719948621235283" },
+            { "sum[k=1,4096] k^3",              30,     "70403108110336"                    },
+            { "product[k=1,1500] (1+1/k)",      200,    "1501"                              },
+            { "(product[k=1,2000] k) / (product[k=1,1999] k)", 200, "2000" },
+            { "sum[k=1,2000] 1/(k-1500)",       30,     "ERR:division by zero"              },
+            { "sum[k=1,2000] 1/(k-1500)",       200,    "ERR:division by zero"              },
+        }
+    );
+
+    failures += RunTests(
+        "rationals",
+        {
+            /* Quotients of integers stay exact until they are printed */
+            { "1/3+1/6",                        30,     "0.5"                               },
+            { "1/3*3",                          30,     "1"                                 },
+            { "(1/3)^-2",                       30,     "9"                                 },
+            { "(2/3)^100*(3/2)^100",            30,     "1"                                 },
+            { "1/3",                            10,     "0.3333333333"                      },
+            { "7 div 2",                        30,     "3"                                 },
+            { "7 mod 3",                        30,     "1"                                 },
+            { "-7 mod 3",                       30,     "2"                                 },
+            { "2^100 div 3",                    30,     "422550200076076467165567735125"    },
+        }
+    );
+
+    failures += RunTests(
+        "complex",
+        {
+            /* Principal roots of negative reals must not leave residues in the real part */
+            { "(-1)^0.5",                       30,     "i"                                 },
+            { "(-1)^0.5",                       70,     "i"                                 },
+            { "(-2)^0.5",                       20,     "1.4142135623730950488i"            },
+            { "(-1)^(1/3)",                     60,     "0.5 + 0.866025403784438646763723170752936183471402626905190314027903i" },
+            { "(1+2*i)/(3-i)",                  30,     "0.1 + 0.7i"                        },
+            { "(3+4*i)/(1-2*i)",                30,     "-1 + 2i"                           },
+            { "sqrt(i)",                        30,     "0.707106781186547524400844362105 + 0.707106781186547524400844362105i" },
+        }
+    );
+
+    failures += RunTests(
+        "vectors and matrices",
+        {
+            /* Sums of products are exact for integers and rationals, and rounded once for floats */
+            { "dot([1,2,3],[4,5,6])",           30,     "32"                                },
+            { "dot([1/3,2,3],[3,1/2,1])",       30,     "5"                                 },
+            { "dot([0.1,0.2,0.3],[0.3,0.2,0.1])", 30,   "0.1"                               },
+            { "dot([1+2*i,3*i],[2-i,0.5*i])",   30,     "2.5 + 3i"                          },
+            { "cross([1,2,3],[4,5,6])",         30,     "[ -3, 6, -3 ]"                     },
+            { "norm([1+i,1-i,2])",              30,     "2.82842712474619009760337744842"   },
+            { "normalize([3,4])",               30,     "[ 0.6, 0.8 ]"                      },
+            { "matmul([[1,2],[3,4]],[[5,6],[7,8]])", 30, "[ [ 19, 22 ], [ 43, 50 ] ]"       },
+            { "matmul([[0.1,0.2],[0.3,0.4]],[[1/3,1],[2,3*i]])", 30, "[ [ 0.433333333333333333333333333333, 0.1 + 0.6i ], [ 0.9, 0.3 + 1.2i ] ]" },
+            { "matmul([1,2],[3,4])",            30,     "11"                                },
+            { "det([[0.5,2],[3,4.25]])",        30,     "-3.875"                            },
+            { "inv([[1,2],[3,4]])",             30,     "[ [ -2, 1 ], [ 1.5, -0.5 ] ]"      },
+            { "solve([[2,1],[1,3]],[1,2])",     30,     "[ 0.2, 0.6 ]"                      },
+            { "transpose([[1,2],[3,4]])",       30,     "[ [ 1, 3 ], [ 2, 4 ] ]"            },
+        }
+    );
+
+    /* Native functions get their arguments as values, and return a value */
+    RegisterFunction(
+        "twice", 1,
+        [](const Variable* args, std::size_t) -> Variable
+        {
+            auto x = args[0];
+            Variable two(int_precision(2));
+            x.Mul(two);
+            return x;
+        }
+    );
+
+    failures += RunTests(
+        "native functions",
+        {
+            { "twice 21",                       30,     "42"                                },
+            { "twice(0.25)",                    30,     "0.5"                               },
+            { "twice(1/3)",                     30,     "0.666666666666666666666666666667"  },
+            { "twice(1+2*i)",                   30,     "2 + 4i"                            },
+            { "sum[k=1,4] twice k",             30,     "20"                                },
+            { "twice([1,2])",                   30,     "ERR:requires arguments of a scalar type" },
+        }
+    );
+
+    failures += RunTests(
+        "sincos",
+        {
+            /* Both results are correctly rounded, also after the cancellation in the argument reduction */
+            { "sincos(0)",                      30,     "[ 0, 1 ]"                          },
+            { "sincos(1)",                      16,     "[ 0.8414709848078965, 0.5403023058681397 ]" },
+            { "sincos(1)",                      30,     "[ 0.84147098480789650665250232163, 0.540302305868139717400936607443 ]" },
+            { "sincos(10^20)",                  50,     "[ -0.6452512852657808442058117113125230074069041966869, 0.763970404441728300400146802737881122834473441747 ]" },
+            { "sincos(355)",                    30,     "[ -0.0000301443533594884492143302800087, -0.999999999545658980165935841693 ]" },
+            { "sincos(1, 2)",                   30,     "ERR:requires exactly 1 argument"   },
+            { "sincos([1, 2])",                 30,     "ERR:requires arguments of a scalar type" },
+        }
+    );
+
+    ConstantsSet definitions;
+
+    failures += RunTests(
+        "definitions",
+        {
+            /* Definitions keep rationals exact, and the fast path reads the stored digits */
+            { "x = 1/3",                        30,     "0.333333333333333333333333333333"  },
+            { "x*3",                            30,     "1"                                 },
+            { "x*3",                            16,     "1"                                 },
+            { "x + 1/6",                        30,     "0.5"                               },
+            { "y = 0.1",                        30,     "0.1"                               },
+            { "sum[k=1,100] k*y",               16,     "505"                               },
+            { "sum[k=1,100] k*y",               30,     "505"                               },
+            { "sum[k=1,3] k*x",                 16,     "2"                                 },
+            { "z = 2^70",                       30,     "1180591620717411303424"            },
+            { "z + 1",                          16,     "1180591620717411303425"            },
+        },
+        ComputeMode(),
+        &definitions
+    );
+
+    /* Lookups of unknown identifiers must not intern them */
+    {
+        Symbol symbol = 0;
+        if (definitions.Contains("undefined_ident") || definitions.Remove("undefined_ident") || FindSymbol("undefined_ident", symbol))
+        {
+            std::cout << "FAILED: lookups of 'undefined_ident' interned the identifier" << std::endl;
+            ++failures;
+        }
+    }
+
+    ComputeMode intervalMode;
+    intervalMode.interval = true;
+
+    failures += RunTests(
+        "interval definitions",
+        {
+            /* Rational constants are enclosed by the quotient of their numerator and denominator */
+            { "x*3",                            30,     "[ 0.999999999999999999999999999999, 1.00000000000000000000000000001 ]" },
+            { "x",                              30,     "[ 0.333333333333333333333333333333, 0.333333333333333333333333333334 ]" },
+            { "y*10",                           30,     "[ 1, 1 ]"                          },
+        },
+        intervalMode,
+        &definitions
+    );
+
+    failures += RunTests(
+        "intervals",
+        {
+            /* Exact results are points, and inexact results are enclosed by bounds rounded outwards */
+            { "2+3",                            30,     "[ 5, 5 ]"                          },
+            { "1/3",                            30,     "[ 0.333333333333333333333333333333, 0.333333333333333333333333333334 ]" },
+            { "sqrt(2)",                        30,     "[ 1.4142135623730950488016887242, 1.41421356237309504880168872421 ]" },
+            { "exp(1)-e",                       30,     "[ -2.01 * 10^-31, 2.01 * 10^-31 ]" },
+            { "1/0",                            30,     "ERR:division by zero"              },
+        },
+        intervalMode
+    );
+
+    failures += RunTests(
+        "interval kernels",
+        {
+            /* Hardware divisors which contain zero are left for the interval computer, which reports only real divisions by zero */
+            { "sum[k=1,4] 1/((k + 0.0000000000000001) - k)",    15, "[ 3.99999999999999 * 10^16, 4.00000000000001 * 10^16 ]" },
+            { "sum[k=1,100] 1/(k - 50)",                        15, "ERR:division by zero"  },
+        },
+        intervalMode
+    );
+
+    /* Hardware enclosures of folds contain the enclosures of the interval computer */
+    {
+        std::cout << std::endl << "interval kernel enclosures:" << std::endl << "---------------------------" << std::endl;
+
+        const std::vector<std::string> exprs
+        {
+            "sum[k=1,5000] 1/k",
+            "sum[k=1,2000] k/(k+0.5)",
+            "sum[k=1,1000] (0.5 - k)/(k*k)",
+            "sum[k=1,3000] abs(k - 1500.5)/k^2",
+            "sum[k=1,3000] sqrt(k)/(k+1)",
+            "product[k=1,20] (k+0.1)/k",
+        };
+
+        // Returns the bounds of an interval result "[ lower, upper ]".
+        auto Bounds = [](const std::string& s, float_precision& lower, float_precision& upper) -> bool
+        {
+            const auto comma = s.find(", ");
+            if (s.size() < 6 || s.compare(0, 2, "[ ") != 0 || s.compare(s.size() - 2, 2, " ]") != 0 || comma == std::string::npos)
+                return false;
+
+            lower = float_precision(s.substr(2, comma - 2).c_str(), 50);
+            upper = float_precision(s.substr(comma + 2, s.size() - comma - 4).c_str(), 50);
+
+            return true;
+        };
+
+        int enclosureFailures = 0;
+
+        for (const auto& expr : exprs)
+        {
+            auto fastMode = intervalMode;
+            fastMode.precision = 15;
+
+            auto preciseMode = intervalMode;
+            preciseMode.precision = 40;
+
+            const auto fast = Compute(expr, fastMode);
+            const auto precise = Compute(expr, preciseMode);
+
+            float_precision fastLower, fastUpper, preciseLower, preciseUpper;
+
+            if ( !Bounds(fast, fastLower, fastUpper) || !Bounds(precise, preciseLower, preciseUpper) ||
+                 fastLower > preciseLower || preciseUpper > fastUpper )
+            {
+                std::cout << "FAILED: " << expr << std::endl;
+                std::cout << "  hardware: " << fast << std::endl;
+                std::cout << "  precise:  " << precise << std::endl;
+                ++enclosureFailures;
+            }
+        }
+
+        std::cout << (exprs.size() - enclosureFailures) << " of " << exprs.size() << " passed" << std::endl;
+        failures += enclosureFailures;
+    }
+
+    /* Fused c - a*b and a*b - c are rounded once in the direction of the rounding mode (2 - 2*10^-120 - 10^-240 is between these results) */
+    {
+        const auto above = "1." + std::string(119, '9') + "8";
+        const auto below = "1." + std::string(119, '9') + "7" + std::string(79, '9');
+        const auto negAbove = "-" + above;
+        const auto negBelow = "-" + below;
+
+        ComputeMode roundingUp;
+        roundingUp.rounding = RoundingMode::Up;
+
+        failures += RunTests(
+            "fused rounding up",
+            {
+                { "3 - (1.0+10^-120)*(1.0+10^-120)",    200,    above.c_str()               },
+                { "(1.0+10^-120)*(1.0+10^-120) - 3",    200,    negBelow.c_str()            },
+            },
+            roundingUp
+        );
+
+        ComputeMode roundingDown;
+        roundingDown.rounding = RoundingMode::Down;
+
+        failures += RunTests(
+            "fused rounding down",
+            {
+                { "3 - (1.0+10^-120)*(1.0+10^-120)",    200,    below.c_str()               },
+                { "(1.0+10^-120)*(1.0+10^-120) - 3",    200,    negAbove.c_str()            },
+            },
+            roundingDown
+        );
+    }
+
+    ComputeMode degreeMode;
+    degreeMode.degree = true;
+
+    failures += RunTests(
+        "degrees",
+        {
+            /* Conversions use the precision of the compute mode, not the default precision (50 digits) */
+            { "sin(30)",                        16,     "0.5"                               },
+            { "asin(0.5)",                      16,     "30"                                },
+            { "sin(1)",                         50,     "0.01745240643728351281941897851631619247225272030714" },
+            { "sin(30)",                        300,    "0.5"                               },
+            { "cos(60)",                        300,    "0.5"                               },
+            { "tan(45)",                        300,    "1"                                 },
+            { "asin(0.5)",                      300,    "30"                                },
+            { "acos(0.5)",                      300,    "60"                                },
+            { "atan2(1,1)",                     300,    "45"                                },
+            { "sincos(30)",                     20,     "[ 0.5, 0.86602540378443864676 ]"   },
+        },
+        degreeMode
+    );
+
+    /* Threads compute at different precisions without affecting each other */
+    {
+        auto ComputeRepeated = [](unsigned int precision, int& mismatches)
+        {
+            /* 2/3 with all digits of the precision (i.e. "0.66...67") */
+            const auto expected = "0." + std::string(precision - 1, '6') + "7";
+
+            ComputeMode mode;
+            mode.precision = precision;
+
+            for (int i = 0; i < 20; ++i)
+            {
+                ErrorLog log;
+                if (Compute("2/sqrt(9)", mode, &log) != expected)
+                    ++mismatches;
+            }
+        };
+
+        int mismatches[2] = { 0, 0 };
+
+        std::thread worker(ComputeRepeated, 180u, std::ref(mismatches[0]));
+        ComputeRepeated(240, mismatches[1]);
+        worker.join();
+
+        std::cout << std::endl << "concurrent precisions:" << std::endl << "----------------------" << std::endl;
+
+        if (mismatches[0] > 0 || mismatches[1] > 0)
+        {
+            std::cout << "FAILED: " << mismatches[0] << " results at 180 and " << mismatches[1] << " results at 240 digits" << std::endl;
+            ++failures;
+        }
+        else
+            std::cout << "2 of 2 passed" << std::endl;
+    }
+
+    /* Streamed results are passed in chunks of at most 65536 characters, and are equal to the result strings */
+    {
+        std::cout << std::endl << "streaming:" << std::endl << "----------" << std::endl;
+
+        struct StreamCase
+        {
+            const char*                 expr;
+            std::vector<std::size_t>    chunkSizes;
+        };
+
+        const std::vector<StreamCase> streamCases
+        {
+            { "1/3",        { 32            } },
+            { "[1, 2/3]",   { 39            } },
+            { "10^65535",   { 65536         } },
+            { "10^65536",   { 65536, 1      } },
+            { "2^300000",   { 65536, 24773  } },
+        };
+
+        ComputeMode mode;
+        mode.precision = 30;
+
+        int streamFailures = 0;
+
+        for (const auto& c : streamCases)
+        {
+            std::string text;
+            std::vector<std::size_t> chunkSizes;
+
+            ErrorLog log;
+            const bool succeeded = Compute(
+                c.expr, mode,
+                [&](const char* chunk, std::size_t length)
+                {
+                    text.append(chunk, length);
+                    chunkSizes.push_back(length);
+                },
+                &log
+            );
+
+            if (!succeeded || chunkSizes != c.chunkSizes || text != Compute(c.expr, mode, &log))
+            {
+                std::cout << "FAILED: " << c.expr << " (" << chunkSizes.size() << " chunks)" << std::endl;
+                ++streamFailures;
+            }
+        }
+
+        /* Errors are reported by the return value, without any output */
+        {
+            std::size_t numChunks = 0;
+
+            ErrorLog log;
+            const bool succeeded = Compute("1/0", mode, [&](const char*, std::size_t) { ++numChunks; }, &log);
+
+            if (succeeded || numChunks > 0 || log.error.find("division by zero") == std::string::npos)
+            {
+                std::cout << "FAILED: 1/0 (streamed)" << std::endl;
+                ++streamFailures;
+            }
+        }
+
+        /* Streams receive the same result */
+        {
+            std::ostringstream stream;
+            if (!Compute("sqrt(2)", mode, stream) || stream.str() != Compute("sqrt(2)", mode))
+            {
+                std::cout << "FAILED: sqrt(2) (output stream)" << std::endl;
+                ++streamFailures;
+            }
+        }
+
+        std::cout << (streamCases.size() + 2 - streamFailures) << " of " << (streamCases.size() + 2) << " passed" << std::endl;
+        failures += streamFailures;
+    }
+
+    /* Exact reals are refined on demand, and each refinement is the correctly rounded prefix of the value */
+    {
+        std::cout << std::endl << "exact reals:" << std::endl << "------------" << std::endl;
+
+        struct Refinement
+        {
+            unsigned int precision;
+            const char* expected;
+        };
+
+        struct ExactRealCase
+        {
+            const char*             expr;
+            std::vector<Refinement> refinements;
+        };
+
+        const std::vector<ExactRealCase> exactRealCases
+        {
+            { "sqrt(2)", {
+                { 10,   "1.414213562"                                                                                           },
+                { 40,   "1.41421356237309504880168872420969807857"                                                              },
+                { 20,   "1.4142135623730950488"                                                                                 },
+                { 100,  "1.414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641573" },
+            } },
+            { "exp(1)", {
+                { 3,    "2.72"                                                                                                  },
+                { 5,    "2.7183"                                                                                                },
+            } },
+            { "exp(1)*exp(1)", {
+                { 5,    "7.3891"                                                                                                },
+                { 20,   "7.3890560989306502272"                                                                                 },
+            } },
+            { "pi-355/113", {
+                { 10,   "-0.0000002667641891"                                                                                   },
+                { 30,   "-0.000000266764189062422312368932886496"                                                               },
+            } },
+            { "exp(1)^2-exp(2)", {
+                { 20,   "0"                                                                                                     },
+            } },
+        };
+
+        int numRefinements = 0;
+        int exactRealFailures = 0;
+
+        for (const auto& c : exactRealCases)
+        {
+            ComputeMode mode;
+            ErrorLog log;
+            const auto real = ComputeExactReal(c.expr, mode, &log);
+
+            for (const auto& r : c.refinements)
+            {
+                ++numRefinements;
+                mode.precision = r.precision;
+
+                const auto result = (real ? RefineExactReal(real, mode, &log) : std::string());
+                if (result != r.expected)
+                {
+                    std::cout << "FAILED: " << c.expr << " with " << r.precision << " digits" << std::endl;
+                    std::cout << "  expected: " << r.expected << std::endl;
+                    std::cout << "  actual:   " << result << std::endl;
+                    ++exactRealFailures;
+                }
+            }
+        }
+
+        /* Expressions without an exact real value are rejected */
+        for (const auto expr : { "[1, 2]", "1/0" })
+        {
+            ++numRefinements;
+            ErrorLog log;
+            if (ComputeExactReal(expr, ComputeMode(), &log) != nullptr || log.error.empty())
+            {
+                std::cout << "FAILED: " << expr << " (exact real)" << std::endl;
+                ++exactRealFailures;
+            }
+        }
+
+        std::cout << (numRefinements - exactRealFailures) << " of " << numRefinements << " passed" << std::endl;
+        failures += exactRealFailures;
+    }
+
     #ifdef _WIN32
     system("pause");
     #endif
 
-    return 0;
+    return (failures == 0 ? 0 : 1);
 }
 
 